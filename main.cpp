@@ -6,11 +6,59 @@
 #include <cctype>
 #include <sstream>
 #include <limits>
+#include <new>
+#include <utility>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cerrno>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define FRS_HAVE_COROUTINES 1
+#endif
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <csignal>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define FRS_HAVE_IO_URING 1
+#endif
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 using namespace std;
 
 class Customer;
 class Flight;
+struct FlightChange;
+struct Booking;
 class Queue;
 class BST;
 
@@ -19,6 +67,88 @@ struct Time {
     int hour;
 };
 
+// Calendar dates are day numbers counted from 1970-01-01 (UTC). Day 0
+// doubles as "no date" wherever a date is optional.
+int daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+void civilFromDays(int days, int& year, int& month, int& day) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int shifted = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * shifted + 2) / 5 + 1;
+    month = shifted + (shifted < 10 ? 3 : -9);
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+// Reads YYYY-MM-DD; rejects dates that do not exist, such as 2026-02-30.
+bool parseDate(const string& text, int& out) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (i != 4 && i != 7 && !isdigit(static_cast<unsigned char>(text[i]))) return false;
+    }
+    int year = stoi(text.substr(0, 4)), month = stoi(text.substr(5, 2)), day = stoi(text.substr(8, 2));
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+    int y, m, d;
+    out = daysFromCivil(year, month, day);
+    civilFromDays(out, y, m, d);
+    return m == month && d == day;
+}
+
+string formatDate(int days) {
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+    char text[16];
+    snprintf(text, sizeof(text), "%04d-%02d-%02d", year, month, day);
+    return text;
+}
+
+// Days since 1970-01-01 in UTC, the calendar dated departures use.
+int today() {
+    return static_cast<int>(time(nullptr) / 86400);
+}
+
+// 0 Monday ... 6 Sunday; 1970-01-01 was a Thursday.
+int weekdayOf(int days) {
+    return ((days + 3) % 7 + 7) % 7;
+}
+
+const char* const WEEKDAY_NAMES[7] = { "monday", "tuesday", "wednesday", "thursday", "friday", "saturday", "sunday" };
+const unsigned char EVERY_DAY = 0x7f;
+
+// Weekday bitmask (bit 0 Monday) from text such as "Wednesday",
+// "Mon,Wed,Fri", "Daily", "Weekdays" or "Weekends"; 0 when no day is named.
+unsigned char parseOperatingDays(const string& text) {
+    unsigned char mask = 0;
+    string word;
+    for (size_t i = 0; i <= text.size(); i++) {
+        char c = i < text.size() ? static_cast<char>(tolower(static_cast<unsigned char>(text[i]))) : ',';
+        if (isalpha(static_cast<unsigned char>(c))) {
+            word += c;
+            continue;
+        }
+        if (word == "daily") mask |= EVERY_DAY;
+        else if (word == "weekdays") mask |= 0x1f;
+        else if (word == "weekends") mask |= 0x60;
+        else if (word.size() >= 3) {
+            for (int d = 0; d < 7; d++) {
+                if (string(WEEKDAY_NAMES[d]).compare(0, word.size(), word) == 0) mask |= 1 << d;
+            }
+        }
+        word.clear();
+    }
+    return mask;
+}
+
 // Discount types
 enum class offers {
     NONE,
@@ -28,14 +158,455 @@ enum class offers {
     FREQUENT_FLYER
 };
 
+// Amount of money in whole cents, so fares, charges and refunds add up
+// exactly. Written and parsed as dollars with two decimals ("181.05").
+class Money {
+public:
+    Money() : cents(0) {}
+
+    static Money fromCents(long long c) { Money m; m.cents = c; return m; }
+    static Money fromDollars(long long d) { return fromCents(d * 100); }
+    // Accepts "12", "12.5" and "12.05"; returns false on anything else.
+    static bool parse(const string& text, Money& out);
+
+    long long getCents() const { return cents; }
+    string str() const;
+
+    Money operator+(Money other) const { return fromCents(cents + other.cents); }
+    Money operator-(Money other) const { return fromCents(cents - other.cents); }
+    Money& operator+=(Money other) { cents += other.cents; return *this; }
+    Money& operator-=(Money other) { cents -= other.cents; return *this; }
+    bool operator==(Money other) const { return cents == other.cents; }
+    bool operator!=(Money other) const { return cents != other.cents; }
+    bool operator<(Money other) const { return cents < other.cents; }
+
+private:
+    long long cents;
+};
+
+bool Money::parse(const string& text, Money& out) {
+    size_t i = 0;
+    bool negative = i < text.size() && text[i] == '-';
+    if (negative) i++;
+    if (i == text.size()) return false;
+
+    long long whole = 0;
+    size_t digits = 0;
+    for (; i < text.size() && isdigit(static_cast<unsigned char>(text[i])); i++, digits++) {
+        whole = whole * 10 + (text[i] - '0');
+    }
+    long long fraction = 0;
+    if (i < text.size() && text[i] == '.') {
+        i++;
+        int places = 0;
+        for (; i < text.size() && isdigit(static_cast<unsigned char>(text[i])) && places < 2; i++, places++) {
+            fraction = fraction * 10 + (text[i] - '0');
+        }
+        if (places == 0) return false;
+        if (places == 1) fraction *= 10;
+    }
+    if (digits == 0 || i != text.size()) return false;
+
+    long long total = whole * 100 + fraction;
+    out = fromCents(negative ? -total : total);
+    return true;
+}
+
+string Money::str() const {
+    unsigned long long magnitude = cents < 0 ? 0ULL - static_cast<unsigned long long>(cents)
+        : static_cast<unsigned long long>(cents);
+    string text = cents < 0 ? "-" : "";
+    text += to_string(magnitude / 100);
+    text += '.';
+    text += static_cast<char>('0' + magnitude % 100 / 10);
+    text += static_cast<char>('0' + magnitude % 10);
+    return text;
+}
+
+ostream& operator<<(ostream& out, Money m) {
+    return out << m.str();
+}
+
+const int OFFER_COUNT = 5;
+
+// Tables below are indexed by offer, so a code read from a file must pass
+// this before it is cast to one.
+inline bool validOffer(int n) { return n >= 0 && n < OFFER_COUNT; }
+
+// Discount of each offer in basis points (1/100 of a percent).
+const int OFFER_DISCOUNT_BP[OFFER_COUNT] = { 0, 1500, 2000, 1000, 2500 };
+
+// Word-sized values that quote threads read while a booking thread updates
+// them; each quote reads a single value, so relaxed atomics are enough.
+inline long long relaxedLoad(const long long& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&value, __ATOMIC_RELAXED);
+#else
+    return *static_cast<const volatile long long*>(&value);
+#endif
+}
+
+inline void relaxedStore(long long& target, long long value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&target, value, __ATOMIC_RELAXED);
+#else
+    *static_cast<volatile long long*>(&target) = value;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Instrumentation
+//
+// Scoped timers feed per-operation latency histograms and the hot paths bump
+// a few counters. Everything is exported by the stats menu entry and dumped on
+// exit. Build with -DFRS_NO_STATS to compile the hooks out entirely; at run
+// time Stats::enabled can switch recording off (a single branch per hook).
+// ---------------------------------------------------------------------------
+
+// HDR-style histogram: values below 16 get an exact bucket, every larger power
+// of two range is split into 16 linear sub-buckets (~6% relative error).
+class LatencyHistogram {
+private:
+    static const int SUB_BUCKETS = 16;
+    static const int BUCKETS = 61 * SUB_BUCKETS;
+
+    unsigned long long counts[BUCKETS];
+    unsigned long long total, sum, minValue, maxValue;
+
+    static int bucketOf(unsigned long long v) {
+        if (v < SUB_BUCKETS) return static_cast<int>(v);
+        int exp = 63 - __builtin_clzll(v);
+        int sub = static_cast<int>((v >> (exp - 4)) & (SUB_BUCKETS - 1));
+        return (exp - 3) * SUB_BUCKETS + sub;
+    }
+
+    static unsigned long long bucketValue(int index) {
+        if (index < SUB_BUCKETS) return static_cast<unsigned long long>(index);
+        int exp = index / SUB_BUCKETS + 3;
+        unsigned long long sub = static_cast<unsigned long long>(index % SUB_BUCKETS);
+        return (SUB_BUCKETS + sub) << (exp - 4);
+    }
+
+public:
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        for (int i = 0; i < BUCKETS; i++) counts[i] = 0;
+        total = sum = maxValue = 0;
+        minValue = ~0ULL;
+    }
+
+    void record(unsigned long long value) {
+        int index = bucketOf(value);
+        if (index >= BUCKETS) index = BUCKETS - 1;
+        counts[index]++;
+        total++;
+        sum += value;
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; i++) counts[i] += other.counts[i];
+        total += other.total;
+        sum += other.sum;
+        if (other.minValue < minValue) minValue = other.minValue;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+    }
+
+    // Smallest recorded bucket value covering the given fraction (0..1).
+    unsigned long long percentile(double p) const {
+        if (total == 0) return 0;
+        unsigned long long rank = static_cast<unsigned long long>(p * total);
+        if (rank >= total) rank = total - 1;
+        unsigned long long seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts[i];
+            if (seen > rank) {
+                unsigned long long v = bucketValue(i);
+                return v > maxValue ? maxValue : v;
+            }
+        }
+        return maxValue;
+    }
+
+    unsigned long long count() const { return total; }
+    unsigned long long min() const { return total ? minValue : 0; }
+    unsigned long long max() const { return maxValue; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+};
+
+// Heap bytes and blocks held by each subsystem. The containers count their
+// own allocations: record types derive from MemoryTracked, and the growable
+// arrays and index blocks report what they allocate and free. Counters are
+// atomic so threads that allocate outside the engine lock stay exact.
+// String contents are not counted here; memstats measures them by walking
+// the records (see "Memory report").
+class Memory {
+public:
+    enum Pool {
+        MEM_FLIGHTS,
+        MEM_FLIGHT_INDEX,
+        MEM_CUSTOMERS,
+        MEM_CUSTOMER_INDEX,
+        MEM_BOOKINGS,
+        MEM_WAITLISTS,
+        MEM_NAME_INDEX,
+        MEM_DATED_FLIGHTS,
+        MEM_SEAT_HOLDS,
+        MEM_SNAPSHOTS,
+        MEM_OTHER,
+        POOL_COUNT
+    };
+
+#ifdef FRS_NO_STATS
+    static void allocated(Pool, size_t) {}
+    static void freed(Pool, size_t) {}
+#else
+    static void allocated(Pool pool, size_t size) {
+        bytes[pool].fetch_add(static_cast<long long>(size), memory_order_relaxed);
+        blocks[pool].fetch_add(1, memory_order_relaxed);
+    }
+    static void freed(Pool pool, size_t size) {
+        bytes[pool].fetch_sub(static_cast<long long>(size), memory_order_relaxed);
+        blocks[pool].fetch_sub(1, memory_order_relaxed);
+    }
+#endif
+    static void* allocate(Pool pool, size_t size) {
+        void* p = ::operator new(size);
+        allocated(pool, size);
+        return p;
+    }
+    static void release(Pool pool, void* p, size_t size) {
+        if (!p) return;
+        freed(pool, size);
+        ::operator delete(p);
+    }
+
+    static long long getBytes(Pool pool) { return bytes[pool].load(memory_order_relaxed); }
+    static long long getBlocks(Pool pool) { return blocks[pool].load(memory_order_relaxed); }
+    static long long totalBytes();
+    static const char* name(Pool pool) { return poolNames[pool]; }
+
+    static void display(ostream& out);
+    // "pool":{"bytes":..,"blocks":..},... without the enclosing braces.
+    static void displayJson(ostream& out);
+
+private:
+    static atomic<long long> bytes[POOL_COUNT], blocks[POOL_COUNT];
+    static const char* poolNames[POOL_COUNT];
+};
+
+atomic<long long> Memory::bytes[Memory::POOL_COUNT];
+atomic<long long> Memory::blocks[Memory::POOL_COUNT];
+const char* Memory::poolNames[Memory::POOL_COUNT] = {
+    "flights", "flight_index", "customers", "customer_index", "bookings", "waitlists",
+    "name_index", "dated_flights", "seat_holds", "snapshots", "other"
+};
+
+long long Memory::totalBytes() {
+    long long total = 0;
+    for (int i = 0; i < POOL_COUNT; i++) total += getBytes(static_cast<Pool>(i));
+    return total;
+}
+
+void Memory::display(ostream& out) {
+    out << left << setw(18) << "MEMORY" << right << setw(14) << "BYTES" << setw(12) << "BLOCKS" << left << endl;
+    for (int i = 0; i < POOL_COUNT; i++) {
+        Pool pool = static_cast<Pool>(i);
+        out << left << setw(18) << poolNames[i] << right << setw(14) << getBytes(pool)
+            << setw(12) << getBlocks(pool) << left << endl;
+    }
+    out << left << setw(18) << "total" << right << setw(14) << totalBytes() << left << endl;
+}
+
+void Memory::displayJson(ostream& out) {
+    for (int i = 0; i < POOL_COUNT; i++) {
+        Pool pool = static_cast<Pool>(i);
+        if (i) out << ",";
+        out << "\"" << poolNames[i] << "\":{\"bytes\":" << getBytes(pool) << ",\"blocks\":" << getBlocks(pool) << "}";
+    }
+}
+
+// Base of a record type whose heap copies are charged to Pool; placement
+// new is passed through uncounted.
+template <Memory::Pool P>
+struct MemoryTracked {
+    static void* operator new(size_t size) { return Memory::allocate(P, size); }
+    static void* operator new[](size_t size) { return Memory::allocate(P, size); }
+    static void* operator new(size_t, void* where) { return where; }
+    static void operator delete(void* p, size_t size) { Memory::release(P, p, size); }
+    static void operator delete[](void* p, size_t size) { Memory::release(P, p, size); }
+    static void operator delete(void*, void*) {}
+};
+
+// Pool that list nodes and spilled arrays of T are charged to.
+template <typename T>
+struct MemoryPoolOf {
+    static const Memory::Pool pool = Memory::MEM_OTHER;
+};
+template <> struct MemoryPoolOf<Flight> { static const Memory::Pool pool = Memory::MEM_FLIGHTS; };
+template <> struct MemoryPoolOf<Queue> { static const Memory::Pool pool = Memory::MEM_WAITLISTS; };
+template <> struct MemoryPoolOf<Booking> { static const Memory::Pool pool = Memory::MEM_BOOKINGS; };
+
+// Heap bytes behind a string; 0 while it fits in the string itself.
+size_t stringHeapBytes(const string& s) {
+    const char* data = s.data();
+    const char* self = reinterpret_cast<const char*>(&s);
+    return data >= self && data < self + sizeof(string) ? 0 : s.capacity() + 1;
+}
+
+class Stats {
+public:
+    enum Op {
+        OP_BOOK,
+        OP_CANCEL,
+        OP_DELETE_FLIGHT,
+        OP_MANAGE_QUEUE,
+        OP_LOAD_FLIGHTS,
+        OP_SAVE_FLIGHTS,
+        OP_LOAD_CUSTOMERS,
+        OP_SAVE_CUSTOMERS,
+        OP_LOAD_QUEUES,
+        OP_SAVE_QUEUES,
+        OP_SEARCH_NAMES,
+        OP_UPDATE_FLIGHTS,
+        OP_COUNT
+    };
+
+    enum Counter {
+        INDEX_LOOKUPS,
+        NODES_VISITED,
+        BYTES_WRITTEN,
+        SCHEDULE_ROWS_RENDERED,
+        SCHEDULE_ROWS_CACHED,
+        COUNTER_COUNT
+    };
+
+    static bool enabled;
+    // Set on threads that must not record, such as the server's snapshot
+    // readers; the histograms and counters are not thread safe.
+    static thread_local bool muted;
+
+    static void record(Op op, unsigned long long nanos) { histograms[op].record(nanos); }
+    static void count(Counter c, unsigned long long n) { counters[c] += n; }
+    static unsigned long long get(Counter c) { return counters[c]; }
+    static const LatencyHistogram& histogram(Op op) { return histograms[op]; }
+
+    static void reset();
+    static void display(ostream& out);
+    static void displayJson(ostream& out);
+
+private:
+    static LatencyHistogram histograms[OP_COUNT];
+    static unsigned long long counters[COUNTER_COUNT];
+    static const char* opNames[OP_COUNT];
+    static const char* counterNames[COUNTER_COUNT];
+};
+
+bool Stats::enabled = true;
+thread_local bool Stats::muted = false;
+LatencyHistogram Stats::histograms[Stats::OP_COUNT];
+unsigned long long Stats::counters[Stats::COUNTER_COUNT] = {};
+const char* Stats::opNames[Stats::OP_COUNT] = {
+    "book", "cancel", "delete_flight", "manage_queue",
+    "load_flights", "save_flights", "load_customers", "save_customers",
+    "load_queues", "save_queues", "search_names", "update_flights"
+};
+const char* Stats::counterNames[Stats::COUNTER_COUNT] = {
+    "index_lookups", "nodes_visited", "bytes_written", "schedule_rows_rendered", "schedule_rows_cached"
+};
+
+void Stats::reset() {
+    for (int i = 0; i < OP_COUNT; i++) histograms[i].reset();
+    for (int i = 0; i < COUNTER_COUNT; i++) counters[i] = 0;
+}
+
+void Stats::display(ostream& out) {
+    out << "\n\t\t\t\t STATISTICS\n\n";
+    out << left << setw(18) << "OPERATION" << right << setw(10) << "COUNT"
+        << setw(12) << "MEAN(us)" << setw(12) << "P50(us)" << setw(12) << "P99(us)"
+        << setw(12) << "MAX(us)" << left << endl;
+    for (int i = 0; i < OP_COUNT; i++) {
+        const LatencyHistogram& h = histograms[i];
+        out << left << setw(18) << opNames[i] << right << setw(10) << h.count()
+            << fixed << setprecision(1)
+            << setw(12) << h.mean() / 1000.0
+            << setw(12) << h.percentile(0.50) / 1000.0
+            << setw(12) << h.percentile(0.99) / 1000.0
+            << setw(12) << h.max() / 1000.0 << left << endl;
+    }
+    out.unsetf(ios::floatfield);
+    out << endl;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        out << left << setw(24) << counterNames[i] << counters[i] << endl;
+    }
+    out << endl;
+    Memory::display(out);
+    out << endl;
+}
+
+void Stats::displayJson(ostream& out) {
+    out << "{\"operations\":{";
+    for (int i = 0; i < OP_COUNT; i++) {
+        const LatencyHistogram& h = histograms[i];
+        if (i) out << ",";
+        out << "\"" << opNames[i] << "\":{\"count\":" << h.count()
+            << ",\"mean_ns\":" << static_cast<unsigned long long>(h.mean())
+            << ",\"p50_ns\":" << h.percentile(0.50)
+            << ",\"p99_ns\":" << h.percentile(0.99)
+            << ",\"p999_ns\":" << h.percentile(0.999)
+            << ",\"max_ns\":" << h.max() << "}";
+    }
+    out << "},\"counters\":{";
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        if (i) out << ",";
+        out << "\"" << counterNames[i] << "\":" << counters[i];
+    }
+    out << "},\"memory\":{";
+    Memory::displayJson(out);
+    out << "}}";
+}
+
+class ScopedTimer {
+private:
+    Stats::Op op;
+    chrono::steady_clock::time_point start;
+    bool active;
+
+public:
+    explicit ScopedTimer(Stats::Op o) : op(o), active(Stats::enabled && !Stats::muted) {
+        if (active) start = chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+        if (active) {
+            auto elapsed = chrono::steady_clock::now() - start;
+            Stats::record(op, static_cast<unsigned long long>(
+                chrono::duration_cast<chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+};
+
+#ifdef FRS_NO_STATS
+#define FRS_TIMED(op) ((void)0)
+#define FRS_COUNT(counter, n) ((void)0)
+#else
+#define FRS_CONCAT_INNER(a, b) a##b
+#define FRS_CONCAT(a, b) FRS_CONCAT_INNER(a, b)
+#define FRS_TIMED(op) ScopedTimer FRS_CONCAT(frsTimer, __LINE__)(Stats::op)
+#define FRS_COUNT(counter, n) do { if (Stats::enabled && !Stats::muted) Stats::count(Stats::counter, (n)); } while (0)
+#endif
+
 template <typename T>
-struct ListNode {
+struct ListNode : MemoryTracked<MemoryPoolOf<T>::pool> {
     T data;
     ListNode* prev;
     ListNode* next;
 
-    ListNode(const T& val, ListNode* p = nullptr, ListNode* n = nullptr)
-        : data(val), prev(p), next(n) {
+    // Constructs data in place from args.
+    template <typename... Args>
+    ListNode(ListNode* p, ListNode* n, Args&&... args)
+        : data(std::forward<Args>(args)...), prev(p), next(n) {
     }
 };
 
@@ -71,9 +642,32 @@ public:
         return *this;
     }
 
-    void push_back(const T& data) {
+    // Moving hands the nodes over and leaves other empty.
+    DoublyLinkedList(DoublyLinkedList&& other) : head(other.head), tail(other.tail), size(other.size) {
+        other.head = other.tail = nullptr;
+        other.size = 0;
+    }
+
+    DoublyLinkedList& operator=(DoublyLinkedList&& other) {
+        if (this != &other) {
+            clear();
+            head = other.head;
+            tail = other.tail;
+            size = other.size;
+            other.head = other.tail = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    void push_back(const T& data) { emplace_back(data); }
+    void push_back(T&& data) { emplace_back(std::move(data)); }
+
+    // Constructs the new last element in its node from args.
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
         try {
-            ListNode<T>* newNode = new ListNode<T>(data, tail, nullptr);
+            ListNode<T>* newNode = new ListNode<T>(tail, nullptr, std::forward<Args>(args)...);
             if (tail) {
                 tail->next = newNode;
             }
@@ -82,6 +676,7 @@ public:
             }
             tail = newNode;
             size++;
+            return newNode->data;
         }
         catch (const std::bad_alloc& e) {
             std::cerr << "Memory allocation failed: " << e.what() << std::endl;
@@ -89,6 +684,23 @@ public:
         }
     }
 
+    // Moves every node of other to the end of this list; nothing is copied
+    // or allocated.
+    void splice(DoublyLinkedList& other) {
+        if (this == &other || !other.head) return;
+        if (tail) {
+            tail->next = other.head;
+            other.head->prev = tail;
+        }
+        else {
+            head = other.head;
+        }
+        tail = other.tail;
+        size += other.size;
+        other.head = other.tail = nullptr;
+        other.size = 0;
+    }
+
     void erase(const ListNode<T>* node) {
         if (!node) return;
 
@@ -148,9 +760,161 @@ public:
     const T& back() const { return getTailData(); }
 };
 
+// Array that keeps its first N elements inside the object and only goes to
+// the heap past that. Elements are moved with memcpy, so T must be
+// trivially copyable.
+template <typename T, int N>
+class SmallVector {
+private:
+    T* items;
+    int size;
+    int capacity;
+    T inlineItems[N];
+
+    bool onHeap() const { return items != inlineItems; }
+
+    void freeItems() {
+        if (!onHeap()) return;
+        Memory::freed(MemoryPoolOf<T>::pool, sizeof(T) * capacity);
+        delete[] items;
+    }
+
+    void grow(int needed) {
+        int newCapacity = capacity * 2;
+        if (newCapacity < needed) newCapacity = needed;
+        T* grown = new T[newCapacity];
+        Memory::allocated(MemoryPoolOf<T>::pool, sizeof(T) * newCapacity);
+        memcpy(static_cast<void*>(grown), items, sizeof(T) * size);
+        freeItems();
+        items = grown;
+        capacity = newCapacity;
+    }
+
+public:
+    SmallVector() : items(inlineItems), size(0), capacity(N) {}
+
+    ~SmallVector() { freeItems(); }
+
+    SmallVector(const SmallVector& other) : items(inlineItems), size(0), capacity(N) {
+        *this = other;
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            if (other.size > capacity) grow(other.size);
+            memcpy(static_cast<void*>(items), other.items, sizeof(T) * other.size);
+            size = other.size;
+        }
+        return *this;
+    }
+
+    void push_back(const T& value) {
+        if (size == capacity) grow(size + 1);
+        items[size++] = value;
+    }
+
+    void reserve(int n) {
+        if (n > capacity) grow(n);
+    }
+
+    // Removes the element at index; the ones after it keep their order.
+    void erase(int index) {
+        if (index < 0 || index >= size) return;
+        memmove(static_cast<void*>(items + index), items + index + 1, sizeof(T) * (size - index - 1));
+        size--;
+    }
+
+    void clear() { size = 0; }
+
+    T& operator[](int index) { return items[index]; }
+    const T& operator[](int index) const { return items[index]; }
+    T* begin() { return items; }
+    T* end() { return items + size; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + size; }
+
+    bool empty() const { return size == 0; }
+    int getSize() const { return size; }
+};
+
+// Runs work(0..threads-1), one call per thread, the first on the caller's.
+template <typename Work>
+void runParallel(int threads, Work& work) {
+    if (threads <= 1) {
+        work(0);
+        return;
+    }
+    thread* workers = new thread[threads - 1];
+    for (int t = 1; t < threads; t++) workers[t - 1] = thread([&work, t] { work(t); });
+    work(0);
+    for (int t = 0; t < threads - 1; t++) workers[t].join();
+    delete[] workers;
+}
+
+// Index entry for bulk loading: the record's key in the high 32 bits and its
+// position in the input in the low 32.
+inline unsigned long long sortEntry(int key, int position) {
+    return static_cast<unsigned long long>(static_cast<unsigned>(key)) << 32 | static_cast<unsigned>(position);
+}
+
+inline int entryKey(unsigned long long entry) { return static_cast<int>(entry >> 32); }
+inline int entryPosition(unsigned long long entry) { return static_cast<int>(entry & 0xffffffffULL); }
+
+// Stable LSD radix sort of sortEntry values by key (non-negative keys), one
+// byte per pass. Each thread counts and then scatters its own slice of the
+// input; passes where every key has the same byte are skipped.
+void radixSortEntries(unsigned long long* entries, int n, int threads) {
+    if (n < 2) return;
+    if (threads < 1 || n < 65536) threads = 1;
+    unsigned long long* scratch = new unsigned long long[n];
+    int* offsets = new int[threads * 256];
+    unsigned long long* from = entries;
+    unsigned long long* to = scratch;
+
+    for (int shift = 32; shift < 64; shift += 8) {
+        auto sliceStart = [n, threads](int t) {
+            return static_cast<int>(static_cast<long long>(n) * t / threads);
+        };
+        auto countSlice = [&](int t) {
+            int* counts = offsets + t * 256;
+            for (int b = 0; b < 256; b++) counts[b] = 0;
+            for (int i = sliceStart(t), end = sliceStart(t + 1); i < end; i++) counts[from[i] >> shift & 0xff]++;
+        };
+        runParallel(threads, countSlice);
+
+        // Turn the counts into each thread's first slot per byte value
+        bool uniform = false;
+        int next = 0;
+        for (int b = 0; b < 256; b++) {
+            int bucket = 0;
+            for (int t = 0; t < threads; t++) {
+                int count = offsets[t * 256 + b];
+                offsets[t * 256 + b] = next;
+                next += count;
+                bucket += count;
+            }
+            if (bucket == n) uniform = true;
+        }
+        if (uniform) continue;
+
+        auto scatterSlice = [&](int t) {
+            int* slots = offsets + t * 256;
+            for (int i = sliceStart(t), end = sliceStart(t + 1); i < end; i++) to[slots[from[i] >> shift & 0xff]++] = from[i];
+        };
+        runParallel(threads, scatterSlice);
+        unsigned long long* swapped = from;
+        from = to;
+        to = swapped;
+    }
+
+    if (from != entries) memcpy(entries, from, sizeof(unsigned long long) * n);
+    delete[] scratch;
+    delete[] offsets;
+}
+
 class FlightBST {
 private:
-    struct Node {
+    struct Node : MemoryTracked<Memory::MEM_FLIGHT_INDEX> {
         int key;
         Flight* flight;
         Node* left;
@@ -160,6 +924,10 @@ private:
     };
 
     Node* root;
+    // Nodes made by build() are constructed in place in one block, in key
+    // order, and freed with it.
+    Node* block;
+    int blockSize;
 
     void insert(Node*& node, int key, Flight* flight) {
         if (!node) {
@@ -173,6 +941,7 @@ private:
 
     Node* find(Node* node, int key) const {
         if (!node) return nullptr;
+        FRS_COUNT(NODES_VISITED, 1);
         if (key == node->key) return node;
         if (key < node->key) return find(node->left, key);
         return find(node->right, key);
@@ -182,114 +951,299 @@ private:
         if (node) {
             clear(node->left);
             clear(node->right);
-            delete node;
+            if (node < block || node >= block + blockSize) delete node;
         }
     }
 
+    static Node* build(Node* block, const int* keys, Flight* const* flights, int lo, int hi) {
+        if (lo >= hi) return nullptr;
+        int mid = lo + (hi - lo) / 2;
+        Node* node = new (block + mid) Node(keys[mid], flights[mid]);
+        node->left = build(block, keys, flights, lo, mid);
+        node->right = build(block, keys, flights, mid + 1, hi);
+        return node;
+    }
+
 public:
-    FlightBST() : root(nullptr) {}
-    ~FlightBST() { clear(root); }
+    FlightBST() : root(nullptr), block(nullptr), blockSize(0) {}
+    ~FlightBST() { clear(); }
+
+    FlightBST(const FlightBST&) = delete;
+    FlightBST& operator=(const FlightBST&) = delete;
+
+    FlightBST(FlightBST&& other) : root(other.root), block(other.block), blockSize(other.blockSize) {
+        other.root = other.block = nullptr;
+        other.blockSize = 0;
+    }
+
+    FlightBST& operator=(FlightBST&& other) {
+        if (this != &other) {
+            clear();
+            root = other.root;
+            block = other.block;
+            blockSize = other.blockSize;
+            other.root = other.block = nullptr;
+            other.blockSize = 0;
+        }
+        return *this;
+    }
 
     void insert(int key, Flight* flight) { insert(root, key, flight); }
 
+    // Replaces the tree with a balanced one over n flights sorted by key,
+    // built bottom-up in linear time.
+    void build(const int* keys, Flight* const* flights, int n) {
+        clear();
+        block = static_cast<Node*>(Memory::allocate(Memory::MEM_FLIGHT_INDEX, sizeof(Node) * (n > 0 ? n : 1)));
+        blockSize = n;
+        root = build(block, keys, flights, 0, n);
+    }
+
+    void clear() {
+        clear(root);
+        Memory::release(Memory::MEM_FLIGHT_INDEX, block, sizeof(Node) * (blockSize > 0 ? blockSize : 1));
+        root = block = nullptr;
+        blockSize = 0;
+    }
+
     Flight* find(int key) const {
+        FRS_COUNT(INDEX_LOOKUPS, 1);
         Node* node = find(root, key);
         return node ? node->flight : nullptr;
     }
 
-    bool exists(int key) const { return find(root, key) != nullptr; }
+    bool exists(int key) const {
+        FRS_COUNT(INDEX_LOOKUPS, 1);
+        return find(root, key) != nullptr;
+    }
 };
 
 class CustomerBST {
 private:
-    struct Node {
+    struct Node : MemoryTracked<Memory::MEM_CUSTOMER_INDEX> {
         int key;
         Customer* customer;
         Node* left;
         Node* right;
+        Node* parent;
 
-        Node(int k, Customer* c) : key(k), customer(c), left(nullptr), right(nullptr) {}
+        Node(int k, Customer* c, Node* p) : key(k), customer(c), left(nullptr), right(nullptr), parent(p) {}
     };
 
     Node* root;
-
-    void insert(Node*& node, int key, Customer* customer) {
-        if (!node) {
-            node = new Node(key, customer);
-            return;
-        }
-
-        if (key < node->key) insert(node->left, key, customer);
-        else insert(node->right, key, customer);
+    int count;
+    // Nodes made by build() are constructed in place in one block, in key
+    // order, and freed with it.
+    Node* block;
+    int blockSize;
+
+    void release(Node* node) {
+        if (node < block || node >= block + blockSize) delete node;
     }
 
     Node* find(Node* node, int key) const {
         if (!node) return nullptr;
+        FRS_COUNT(NODES_VISITED, 1);
         if (key == node->key) return node;
         if (key < node->key) return find(node->left, key);
         return find(node->right, key);
     }
 
+    // Post-order delete that walks back up through the parent links, so a
+    // degenerate tree does not exhaust the call stack.
     void clear(Node* node) {
-        if (node) {
-            clear(node->left);
-            clear(node->right);
-            delete node;
+        while (node) {
+            if (node->left) {
+                node = node->left;
+            }
+            else if (node->right) {
+                node = node->right;
+            }
+            else {
+                Node* parent = node->parent;
+                if (parent) {
+                    if (parent->left == node) parent->left = nullptr;
+                    else parent->right = nullptr;
+                }
+                release(node);
+                node = parent;
+            }
         }
     }
 
-    void inOrderTraversal(Node* node, DoublyLinkedList<Customer*>& result) const {
-        if (node) {
-            inOrderTraversal(node->left, result);
-            result.push_back(node->customer);
-            inOrderTraversal(node->right, result);
-        }
+    static Node* leftmost(Node* node) {
+        while (node && node->left) node = node->left;
+        return node;
     }
 
-public:
-    CustomerBST() : root(nullptr) {}
-    ~CustomerBST() { clear(root); }
+    static Node* successor(Node* node) {
+        if (node->right) return leftmost(node->right);
+        Node* parent = node->parent;
+        while (parent && node == parent->right) {
+            node = parent;
+            parent = parent->parent;
+        }
+        return parent;
+    }
 
-    void insert(int key, Customer* customer) { insert(root, key, customer); }
+    static Node* build(Node* block, const int* keys, Customer* const* customers, int lo, int hi, Node* parent) {
+        if (lo >= hi) return nullptr;
+        int mid = lo + (hi - lo) / 2;
+        Node* node = new (block + mid) Node(keys[mid], customers[mid], parent);
+        node->left = build(block, keys, customers, lo, mid, node);
+        node->right = build(block, keys, customers, mid + 1, hi, node);
+        return node;
+    }
 
-    Customer* find(int key) const {
-        Node* node = find(root, key);
-        return node ? node->customer : nullptr;
+    // First node with key >= the given key (strictly greater when inclusive is false).
+    Node* lowerBound(int key, bool inclusive) const {
+        Node* node = root;
+        Node* result = nullptr;
+        while (node) {
+            if (node->key > key || (inclusive && node->key == key)) {
+                result = node;
+                node = node->left;
+            }
+            else {
+                node = node->right;
+            }
+        }
+        return result;
     }
 
-    bool exists(int key) const { return find(root, key) != nullptr; }
+public:
+    // In-order iterator over the stored customers; walks parent links, so it
+    // allocates nothing.
+    class Iterator {
+    private:
+        Node* node;
 
-    void erase(int key) {
-        Node* parent = nullptr;
-        Node* current = root;
+    public:
+        explicit Iterator(Node* n) : node(n) {}
 
-        while (current && current->key != key) {
-            parent = current;
-            if (key < current->key) current = current->left;
-            else current = current->right;
+        Customer* operator*() const { return node->customer; }
+        int key() const { return node->key; }
+
+        Iterator& operator++() {
+            node = successor(node);
+            return *this;
         }
 
-        if (!current) return;
+        bool operator==(const Iterator& other) const { return node == other.node; }
+        bool operator!=(const Iterator& other) const { return node != other.node; }
+    };
 
-        if (current->left && current->right) {
-            Node* successor = current->right;
-            Node* successorParent = current;
+    // Half-open [first, last) view usable in range-based for loops.
+    class Range {
+    private:
+        Iterator first, last;
 
-            while (successor->left) {
-                successorParent = successor;
-                successor = successor->left;
-            }
+    public:
+        Range(Iterator f, Iterator l) : first(f), last(l) {}
+        Iterator begin() const { return first; }
+        Iterator end() const { return last; }
+    };
 
-            current->key = successor->key;
-            current->customer = successor->customer;
+    CustomerBST() : root(nullptr), count(0), block(nullptr), blockSize(0) {}
+    ~CustomerBST() { clear(); }
 
-            if (successorParent->left == successor) {
-                successorParent->left = successor->right;
-            }
+    CustomerBST(const CustomerBST&) = delete;
+    CustomerBST& operator=(const CustomerBST&) = delete;
+
+    CustomerBST(CustomerBST&& other)
+        : root(other.root), count(other.count), block(other.block), blockSize(other.blockSize) {
+        other.root = other.block = nullptr;
+        other.count = other.blockSize = 0;
+    }
+
+    CustomerBST& operator=(CustomerBST&& other) {
+        if (this != &other) {
+            clear();
+            root = other.root;
+            count = other.count;
+            block = other.block;
+            blockSize = other.blockSize;
+            other.root = other.block = nullptr;
+            other.count = other.blockSize = 0;
+        }
+        return *this;
+    }
+
+    // Drops every node. The tree only indexes its customers, which whoever
+    // loaded them frees (Customer::loadFromFile frees the previous set).
+    void clear() {
+        clear(root);
+        Memory::release(Memory::MEM_CUSTOMER_INDEX, block, sizeof(Node) * (blockSize > 0 ? blockSize : 1));
+        root = block = nullptr;
+        count = blockSize = 0;
+    }
+
+    void insert(int key, Customer* customer) {
+        Node* parent = nullptr;
+        Node** link = &root;
+        while (*link) {
+            parent = *link;
+            link = (key < parent->key) ? &parent->left : &parent->right;
+        }
+        *link = new Node(key, customer, parent);
+        count++;
+    }
+
+    // Replaces the tree with a balanced one over n customers sorted by key,
+    // built bottom-up in linear time.
+    void build(const int* keys, Customer* const* customers, int n) {
+        clear();
+        block = static_cast<Node*>(Memory::allocate(Memory::MEM_CUSTOMER_INDEX, sizeof(Node) * (n > 0 ? n : 1)));
+        blockSize = n;
+        root = build(block, keys, customers, 0, n, nullptr);
+        count = n;
+    }
+
+    Customer* find(int key) const {
+        FRS_COUNT(INDEX_LOOKUPS, 1);
+        Node* node = find(root, key);
+        return node ? node->customer : nullptr;
+    }
+
+    bool exists(int key) const {
+        FRS_COUNT(INDEX_LOOKUPS, 1);
+        return find(root, key) != nullptr;
+    }
+
+    void erase(int key) {
+        Node* parent = nullptr;
+        Node* current = root;
+
+        while (current && current->key != key) {
+            parent = current;
+            if (key < current->key) current = current->left;
+            else current = current->right;
+        }
+
+        if (!current) return;
+
+        if (current->left && current->right) {
+            Node* successor = current->right;
+            Node* successorParent = current;
+
+            while (successor->left) {
+                successorParent = successor;
+                successor = successor->left;
+            }
+
+            current->key = successor->key;
+            current->customer = successor->customer;
+
+            if (successorParent->left == successor) {
+                successorParent->left = successor->right;
+            }
             else {
                 successorParent->right = successor->right;
             }
-            delete successor;
+            if (successor->right) {
+                successor->right->parent = successorParent;
+            }
+            release(successor);
         }
         else {
             Node* child = (current->left) ? current->left : current->right;
@@ -305,2441 +1259,9537 @@ public:
                     parent->right = child;
                 }
             }
-            delete current;
+            if (child) {
+                child->parent = parent;
+            }
+            release(current);
         }
+        count--;
     }
 
-    DoublyLinkedList<Customer*> getAllCustomers() const {
-        DoublyLinkedList<Customer*> result;
-        inOrderTraversal(root, result);
-        return result;
+    Iterator begin() const { return Iterator(leftmost(root)); }
+    Iterator end() const { return Iterator(nullptr); }
+
+    // Customers with passport numbers in [from, to], in ascending order;
+    // empty when from > to.
+    Range range(int from, int to) const {
+        if (from > to) return Range(end(), end());
+        return Range(Iterator(lowerBound(from, true)), Iterator(lowerBound(to, false)));
     }
-};
 
-class Flight {
-private:
-    int flightNo, cost, seats, booked_seats, availableSeats;
-    int businessSeats, economySeats, bookedBusinessSeats, bookedEconomySeats;
-    string from, to, plane_type, weather, dayOfWeek;
-    Time t_leave, t_arrive;
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+};
 
+// Secondary index over customer names for prefix and typo-tolerant search.
+// Surnames and first names are two dictionaries of distinct lowercase
+// tokens. Each has a compressed trie for prefix lookups and trigram postings
+// for fuzzy ones: a token within k edits of the query shares at least n - 3k
+// of the query's n trigrams, so only tokens passing that count are compared
+// in full. Every surname lists its customers with their first-name token, so
+// a two-word query filters by first name without touching customer records.
+class NameIndex {
 public:
-    Flight() : flightNo(0), cost(0), seats(0), booked_seats(0), businessSeats(0), economySeats(0),
-        bookedBusinessSeats(0), bookedEconomySeats(0) {
-    }
-    Flight(int no, int c, int s, int bs, string f, string t, string pt, Time tl, Time ta, string w, string d)
-        : flightNo(no), cost(c), seats(s), booked_seats(bs), from(f), to(t), plane_type(pt),
-        t_leave(tl), t_arrive(ta), weather(w), dayOfWeek(d), businessSeats(0), economySeats(s),
-        bookedBusinessSeats(0), bookedEconomySeats(bs) {
-    }
-    int getBookedSeats() const { return booked_seats; }
-    static void updateFlight(int flightNumber);
-    static void loadFromFile();
-    static void saveToFile();
+    static const int MAX_EDITS = 2;
+    static const int MAX_TOKEN = 32;  // letters kept per name
 
-    // Flight management
-    void addFlight();
-    static void deleteFlight(int num);
+    struct Match {
+        int passport;
+        int distance;  // edits between the query and the name
+    };
 
-    // Display functions
-    void displayInfo() const;
-    static void displayFlightInfo(int num);
-    static void displaySchedule();
+    NameIndex() : customers(0) {}
+    ~NameIndex() { clear(); }
+    NameIndex(const NameIndex&) = delete;
+    NameIndex& operator=(const NameIndex&) = delete;
 
-    // Booking functions
-    static void resSeat(int num, int val, bool isBusiness);
-    static bool checkForSeats(int num);
-    static bool flightExists(int num);
-    string getWeather() const { return weather; }
-    string getDayOfWeek() const { return dayOfWeek; }
-    void setWeather(const string& w) { weather = w; }
-    void setDayOfWeek(const string& d) { dayOfWeek = d; }
+    void insert(int passport, const string& name, const string& surname);
+    void erase(int passport, const string& name, const string& surname);
+    void clear();
 
-    // Getters
-    int getFlightNo() const { return flightNo; }
-    int getCost() const { return cost; }
-    Time getLeavingTime() const { return t_leave; }
-    Time getArrivingTime() const { return t_arrive; }
-    string getDeparture() const { return from; }
-    string getDestination() const { return to; }
-    string getPlaneType() const { return plane_type; }
-    int getAvailableSeats() const { return seats - booked_seats; }
-    void setAvailableSeats(int seats) { availableSeats = seats; }
+    // Customers matching "surname [first name]" (or "surname, first name"
+    // for multi-word surnames), closest first. Writes up to limit matches.
+    int search(const string& query, Match* out, int limit);
 
-    // Business/Economy class getters
-    int getBusinessSeats() const { return businessSeats; }
-    int getEconomySeats() const { return economySeats; }
-    int getBookedBusinessSeats() const { return bookedBusinessSeats; }
-    int getBookedEconomySeats() const { return bookedEconomySeats; }
-    int getAvailableBusinessSeats() const { return businessSeats - bookedBusinessSeats; }
-    int getAvailableEconomySeats() const { return economySeats - bookedEconomySeats; }
+    int size() const { return customers; }
 
-    // Setters
-    void setBookedSeats(int bs) { booked_seats = bs; }
-    void setBookedBusinessSeats(int bs) { bookedBusinessSeats = bs; }
-    void setBookedEconomySeats(int bs) { bookedEconomySeats = bs; }
-};
+    // Lowercase letters of text, capped at MAX_TOKEN.
+    static string normalize(const string& text);
 
-// Customer class
-class Customer {
 private:
-    int passportNo, tel;
-    DoublyLinkedList<int> flights;
-    string name, surname, nationality, address;
-    offers discount;
-    int totalSpent;
-
-public:
-    // Constructors
-    Customer() : passportNo(0), tel(0), discount(offers::NONE), totalSpent(0) {}
-    Customer(int pn, int t, string n, string s, string nat, string addr, offers d)
-        : passportNo(pn), tel(t), name(n), surname(s), nationality(nat), address(addr), discount(d), totalSpent(0) {
-    }
-    void manageQueue(int num);
-    // File operations
-    static void loadFromFile();
-    static void saveToFile();
+    template <typename T>
+    struct Array : MemoryTracked<Memory::MEM_NAME_INDEX> {
+        T* items;
+        int count, capacity;
+
+        Array() : items(nullptr), count(0), capacity(0) {}
+        ~Array() { release(); }
+        Array(const Array&) = delete;
+        Array& operator=(const Array&) = delete;
+
+        void push(const T& value) {
+            if (count == capacity) {
+                int grown = capacity ? capacity * 2 : 4;
+                T* bigger = new T[grown];
+                Memory::allocated(Memory::MEM_NAME_INDEX, sizeof(T) * grown);
+                for (int i = 0; i < count; i++) bigger[i] = items[i];
+                if (items) Memory::freed(Memory::MEM_NAME_INDEX, sizeof(T) * capacity);
+                delete[] items;
+                items = bigger;
+                capacity = grown;
+            }
+            items[count++] = value;
+        }
+        // Order is not kept: the last item takes the removed one's place.
+        void removeAt(int i) { items[i] = items[--count]; }
+        void release() {
+            if (items) Memory::freed(Memory::MEM_NAME_INDEX, sizeof(T) * capacity);
+            delete[] items;
+            items = nullptr;
+            count = capacity = 0;
+        }
+    };
 
-    // Booking functions
-    void book();
-    void bookFromQueue(int num);
-    void cancel();
+    struct TrieNode : MemoryTracked<Memory::MEM_NAME_INDEX> {
+        string label;         // edge text from the parent
+        TrieNode** children;  // sorted by first letter
+        int childCount, childCapacity;
+        int token;            // token ending here, or -1
+
+        TrieNode(const string& l) : label(l), children(nullptr), childCount(0), childCapacity(0), token(-1) {}
+        ~TrieNode() {
+            for (int i = 0; i < childCount; i++) delete children[i];
+            if (children) Memory::freed(Memory::MEM_NAME_INDEX, sizeof(TrieNode*) * childCapacity);
+            delete[] children;
+        }
+    };
 
-    // Information functions
-    static bool displayCustomerInfo(int passport);
-    static bool uniquePass(int passport);
+    // Distinct tokens of one name field with stable ids.
+    class Dictionary {
+    public:
+        static const int GRAMS = 27 * 27 * 27;  // a-z plus the '$' pad
+
+        Dictionary();
+        ~Dictionary();
+
+        int acquire(const string& token);  // id, adding the token if new
+        void release(int id);              // drops it with its last user
+        int find(const string& token) const;
+        void clear();
+
+        // Marks every token within maxEdits of query-as-a-prefix with its
+        // distance and lists the ids by distance; unmark() undoes it.
+        void match(const string& query, int maxEdits, Array<int>* byDistance);
+        void unmark(Array<int>* byDistance, int maxEdits);
+        int distance(int id) const { return marks[id]; }  // NO_MATCH when unmarked
+
+        static const unsigned char NO_MATCH = 255;
+        // Bytes per token id across text, refs, marks and hits.
+        static const size_t TOKEN_BYTES = sizeof(string) + sizeof(int) + sizeof(unsigned char) + sizeof(unsigned short);
+
+    private:
+        TrieNode* child(TrieNode* node, char first) const;
+        void addChild(TrieNode* node, TrieNode* child);
+        void removeChild(TrieNode* node, TrieNode* child);
+        void trieInsert(const string& token, int id);
+        void trieRemove(const string& token);
+        void collect(TrieNode* node, Array<int>& out);
+        void ensureCapacity(int id);
+        static int grams(const string& token, int* codes);
+
+        TrieNode* root;
+        string* text;
+        int* refs;
+        unsigned char* marks;
+        unsigned short* hits;
+        int used, capacity;
+        Array<int> freeIds;
+        Array<int>* postings;  // trigram code -> token ids
+    };
 
-    // Helper functions
-    void inputCustomeralInfo();
-    void copyFromExisting(int passport);
-    void applyDiscount();
-    float getDiscountRate() const;
+    struct Entry {
+        int passport;
+        int first;  // first-name token id
+    };
 
-    // Getters
-    int getPassport() const { return passportNo; }
-    string getName() const { return name; }
-    string getSurname() const { return surname; }
-    string getNationality() const { return nationality; }
-    string getAddress() const { return address; }
-    int getTel() const { return tel; }
-    offers getDiscount() const { return discount; }
-    int getTotalSpent() const { return totalSpent; }
-    const DoublyLinkedList<int>& getFlights() const { return flights; }
+    static int editsFor(const string& token) { return token.size() <= 3 ? 0 : token.size() <= 6 ? 1 : 2; }
+    static int prefixDistance(const string& query, const string& token, int limit);
+    int collect(Array<int>* lastMatches, int lastEdits, bool byFirstName, Match* out, int limit);
 
-    // Setters
-    void setTotalSpent(int amount) { totalSpent = amount; }
-    void setPassport(int passport) { passportNo = passport; }
+    Dictionary surnames, firstNames;
+    Array<Array<Entry>*> bySurname;  // surname token id -> its customers
+    int customers;
 };
 
-struct QueueNode {
-    Customer Customer;
-    QueueNode* next;
-    time_t joinTime;
-};
+string NameIndex::normalize(const string& text) {
+    string out;
+    for (char c : text) {
+        if (isalpha(static_cast<unsigned char>(c)) && out.size() < static_cast<size_t>(MAX_TOKEN)) {
+            out += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    return out;
+}
 
-// Queue class
-class Queue {
-private:
-    int queueNo;
-    QueueNode* front;
-    QueueNode* rear;
-    int size;
+// Fewest edits turning query into some prefix of token, or limit + 1 once
+// it is certain to exceed limit.
+int NameIndex::prefixDistance(const string& query, const string& token, int limit) {
+    int row[MAX_TOKEN + 1] = {};
+    int n = static_cast<int>(token.size());
+    if (n > MAX_TOKEN) n = MAX_TOKEN;
+    for (int j = 0; j <= n; j++) row[j] = j;
+    for (size_t i = 1; i <= query.size(); i++) {
+        int diagonal = row[0];
+        row[0] = static_cast<int>(i);
+        int best = row[0];
+        for (int j = 1; j <= n; j++) {
+            int above = row[j];
+            int cost = query[i - 1] == token[j - 1] ? 0 : 1;
+            row[j] = min(min(above + 1, row[j - 1] + 1), diagonal + cost);
+            diagonal = above;
+            if (row[j] < best) best = row[j];
+        }
+        if (best > limit) return limit + 1;
+    }
+    int best = row[0];
+    for (int j = 1; j <= n; j++) best = min(best, row[j]);
+    return best;
+}
 
-public:
-    Queue(int queueId) : queueNo(queueId), front(nullptr), rear(nullptr), size(0) {}
-    ~Queue() { clear(); }
+NameIndex::Dictionary::Dictionary()
+    : root(new TrieNode("")), text(nullptr), refs(nullptr), marks(nullptr), hits(nullptr), used(0), capacity(0),
+    postings(new Array<int>[GRAMS]) {
+}
 
-    // File operations
-    static void loadFromFile();
-    static void saveToFile();
-    void setSize(int newSize) { size = newSize; }
-    // Queue operations
-    void enqueue(const Customer& p);
-    void dequeue();
-    void clear();
+NameIndex::Dictionary::~Dictionary() {
+    delete root;
+    if (capacity) Memory::freed(Memory::MEM_NAME_INDEX, TOKEN_BYTES * capacity);
+    delete[] text;
+    delete[] refs;
+    delete[] marks;
+    delete[] hits;
+    delete[] postings;
+}
 
-    // Display functions
-    static void display(int num);
+void NameIndex::Dictionary::clear() {
+    delete root;
+    root = new TrieNode("");
+    for (int g = 0; g < GRAMS; g++) postings[g].release();
+    freeIds.release();
+    for (int i = 0; i < used; i++) text[i].clear();
+    used = 0;
+}
 
-    // Utility functions
-    Customer oldest() const;
-    bool isEmpty() const { return front == nullptr; }
-    int getPosition(int passport) const;
+void NameIndex::Dictionary::ensureCapacity(int id) {
+    if (id < capacity) return;
+    int grown = capacity ? capacity * 2 : 64;
+    string* biggerText = new string[grown];
+    int* biggerRefs = new int[grown];
+    unsigned char* biggerMarks = new unsigned char[grown];
+    unsigned short* biggerHits = new unsigned short[grown];
+    Memory::allocated(Memory::MEM_NAME_INDEX, TOKEN_BYTES * grown);
+    if (capacity) Memory::freed(Memory::MEM_NAME_INDEX, TOKEN_BYTES * capacity);
+    for (int i = 0; i < capacity; i++) {
+        biggerText[i].swap(text[i]);
+        biggerRefs[i] = refs[i];
+    }
+    for (int i = 0; i < grown; i++) {
+        biggerMarks[i] = NO_MATCH;
+        biggerHits[i] = 0;
+    }
+    delete[] text;
+    delete[] refs;
+    delete[] marks;
+    delete[] hits;
+    text = biggerText;
+    refs = biggerRefs;
+    marks = biggerMarks;
+    hits = biggerHits;
+    capacity = grown;
+}
 
-    // Getters
-    int getNo() const { return queueNo; }
-    int getSize() const { return size; }
-    QueueNode* getFront() const { return front; }
-    QueueNode* getRear() const { return rear; }
+// Trigram codes of "$$" + token, one per letter.
+int NameIndex::Dictionary::grams(const string& token, int* codes) {
+    int n = static_cast<int>(token.size());
+    for (int i = 0; i < n; i++) {
+        int a = i >= 2 ? token[i - 2] - 'a' : 26;
+        int b = i >= 1 ? token[i - 1] - 'a' : 26;
+        codes[i] = (a * 27 + b) * 27 + (token[i] - 'a');
+    }
+    return n;
+}
 
-    // Setters
-    void setFront(QueueNode* f) { front = f; }
-    void setRear(QueueNode* r) { rear = r; }
-};
+NameIndex::TrieNode* NameIndex::Dictionary::child(TrieNode* node, char first) const {
+    for (int i = 0; i < node->childCount; i++) {
+        if (node->children[i]->label[0] == first) return node->children[i];
+    }
+    return nullptr;
+}
 
-// Menu class
-class Menu {
-public:
-    static void displayMenu();
-    static void select(int selection);
-    static void exit_prog();
-};
+void NameIndex::Dictionary::addChild(TrieNode* node, TrieNode* added) {
+    if (node->childCount == node->childCapacity) {
+        int grown = node->childCapacity ? node->childCapacity * 2 : 2;
+        TrieNode** bigger = new TrieNode*[grown];
+        Memory::allocated(Memory::MEM_NAME_INDEX, sizeof(TrieNode*) * grown);
+        for (int i = 0; i < node->childCount; i++) bigger[i] = node->children[i];
+        if (node->children) Memory::freed(Memory::MEM_NAME_INDEX, sizeof(TrieNode*) * node->childCapacity);
+        delete[] node->children;
+        node->children = bigger;
+        node->childCapacity = grown;
+    }
+    int i = node->childCount++;
+    while (i > 0 && node->children[i - 1]->label[0] > added->label[0]) {
+        node->children[i] = node->children[i - 1];
+        i--;
+    }
+    node->children[i] = added;
+}
 
-// Input validation functions
-bool checkTime(string time) {
-    if (time.empty()) return false;
-    if (time.length() != 5 || time[2] != ':') return false;
+void NameIndex::Dictionary::removeChild(TrieNode* node, TrieNode* removed) {
+    int i = 0;
+    while (node->children[i] != removed) i++;
+    for (; i + 1 < node->childCount; i++) node->children[i] = node->children[i + 1];
+    node->childCount--;
+}
 
-    for (int i = 0; i < time.length(); i++) {
-        if (i == 2) {
-            if (time[i] != ':') return false;
+void NameIndex::Dictionary::trieInsert(const string& token, int id) {
+    TrieNode* node = root;
+    size_t pos = 0;
+    while (pos < token.size()) {
+        TrieNode* next = child(node, token[pos]);
+        if (!next) {
+            TrieNode* leaf = new TrieNode(token.substr(pos));
+            leaf->token = id;
+            addChild(node, leaf);
+            return;
         }
-        else if (!isdigit(time[i])) {
-            return false;
+        size_t common = 0;
+        while (common < next->label.size() && pos + common < token.size()
+            && next->label[common] == token[pos + common]) {
+            common++;
         }
+        if (common < next->label.size()) {
+            // Split the edge where the token leaves it
+            TrieNode* middle = new TrieNode(next->label.substr(0, common));
+            next->label.erase(0, common);
+            removeChild(node, next);
+            addChild(middle, next);
+            addChild(node, middle);
+            next = middle;
+        }
+        node = next;
+        pos += common;
     }
-
-    int hour = stoi(time.substr(0, 2));
-    int min = stoi(time.substr(3, 2));
-    return hour >= 0 && hour < 24 && min >= 0 && min < 60;
+    node->token = id;
 }
 
-bool checkNumber(const string& s) {
-    if (s.empty()) return false;
-    for (char c : s) {
-        if (!isdigit(c)) return false;
+void NameIndex::Dictionary::trieRemove(const string& token) {
+    TrieNode* parent = nullptr;
+    TrieNode* node = root;
+    size_t pos = 0;
+    while (pos < token.size()) {
+        parent = node;
+        node = child(node, token[pos]);
+        pos += node->label.size();
+    }
+    node->token = -1;
+    if (node == root) return;
+
+    if (node->childCount == 0) {
+        removeChild(parent, node);
+        delete node;
+        node = parent;
+    }
+    // Keep the trie compressed: fold a bare single-child node into its child
+    if (node != root && node->token < 0 && node->childCount == 1) {
+        TrieNode* only = node->children[0];
+        node->label += only->label;
+        node->token = only->token;
+        if (node->children) Memory::freed(Memory::MEM_NAME_INDEX, sizeof(TrieNode*) * node->childCapacity);
+        delete[] node->children;
+        node->children = only->children;
+        node->childCount = only->childCount;
+        node->childCapacity = only->childCapacity;
+        only->children = nullptr;
+        only->childCount = 0;
+        delete only;
     }
-    return true;
 }
 
-bool checkString(const string& s) {
-    if (s.empty()) return false;
-    for (char c : s) {
-        if (!isalpha(c) && c != ' ') return false;
+int NameIndex::Dictionary::find(const string& token) const {
+    TrieNode* node = root;
+    size_t pos = 0;
+    while (pos < token.size()) {
+        node = child(node, token[pos]);
+        if (!node || token.compare(pos, node->label.size(), node->label) != 0) return -1;
+        pos += node->label.size();
     }
-    return true;
+    return node->token;
 }
 
-bool checkTime2(Time tLeaving, Time tArriving) {
-    if (tLeaving.hour > tArriving.hour) {
-        return true;
+int NameIndex::Dictionary::acquire(const string& token) {
+    int id = find(token);
+    if (id >= 0) {
+        refs[id]++;
+        return id;
     }
-    else if (tLeaving.hour == tArriving.hour) {
-        if (tLeaving.min > tArriving.min) {
-            return true;
+
+    if (freeIds.count) {
+        id = freeIds.items[--freeIds.count];
+    }
+    else {
+        id = used++;
+        ensureCapacity(id);
+    }
+    text[id] = token;
+    refs[id] = 1;
+    trieInsert(token, id);
+
+    int codes[MAX_TOKEN];
+    int n = grams(token, codes);
+    for (int i = 0; i < n; i++) postings[codes[i]].push(id);
+    return id;
+}
+
+void NameIndex::Dictionary::release(int id) {
+    if (--refs[id] > 0) return;
+
+    trieRemove(text[id]);
+    int codes[MAX_TOKEN];
+    int n = grams(text[id], codes);
+    for (int i = 0; i < n; i++) {
+        Array<int>& list = postings[codes[i]];
+        for (int j = 0; j < list.count; j++) {
+            if (list.items[j] == id) {
+                list.removeAt(j);
+                break;
+            }
         }
     }
-    return false;
+    text[id].clear();
+    freeIds.push(id);
 }
 
-// Global data structures
-DoublyLinkedList<Flight> flist;
-CustomerBST customerBST;
-DoublyLinkedList<Queue> qlist;
-FlightBST flightBST;
+void NameIndex::Dictionary::collect(TrieNode* node, Array<int>& out) {
+    if (node->token >= 0) out.push(node->token);
+    for (int i = 0; i < node->childCount; i++) collect(node->children[i], out);
+}
 
-// File operations
-void Flight::loadFromFile() {
-    ifstream file("flights2.txt");
-    if (!file.is_open()) return;
+void NameIndex::Dictionary::match(const string& query, int maxEdits, Array<int>* byDistance) {
+    // Exact prefix: every token below the point where the query ends
+    TrieNode* node = root;
+    size_t pos = 0;
+    while (node && pos < query.size()) {
+        TrieNode* next = child(node, query[pos]);
+        size_t n = next ? min(next->label.size(), query.size() - pos) : 0;
+        if (!next || next->label.compare(0, n, query, pos, n) != 0) {
+            node = nullptr;
+            break;
+        }
+        node = next;
+        pos += n;
+    }
+    if (node) collect(node, byDistance[0]);
+    for (int i = 0; i < byDistance[0].count; i++) marks[byDistance[0].items[i]] = 0;
+    if (maxEdits == 0) return;
+
+    // Fuzzy: count shared trigrams, then verify the candidates
+    int codes[MAX_TOKEN];
+    int n = grams(query, codes);
+    int unique = 0;
+    for (int i = 0; i < n; i++) {
+        bool seen = false;
+        for (int j = 0; j < unique && !seen; j++) seen = codes[j] == codes[i];
+        if (!seen) codes[unique++] = codes[i];
+    }
+    int needed = max(1, unique - 3 * maxEdits);
 
-    flist.clear();
-    flightBST = FlightBST(); // Reset BST
+    Array<int> touched;
+    for (int i = 0; i < unique; i++) {
+        const Array<int>& list = postings[codes[i]];
+        for (int j = 0; j < list.count; j++) {
+            if (hits[list.items[j]]++ == 0) touched.push(list.items[j]);
+        }
+    }
+    for (int i = 0; i < touched.count; i++) {
+        int id = touched.items[i];
+        if (hits[id] >= needed && marks[id] == NO_MATCH) {
+            int d = prefixDistance(query, text[id], maxEdits);
+            if (d > 0 && d <= maxEdits) {
+                marks[id] = static_cast<unsigned char>(d);
+                byDistance[d].push(id);
+            }
+        }
+        hits[id] = 0;
+    }
+}
 
-    string line;
-    while (getline(file, line)) {
-        if (line.empty()) continue;
-
-        istringstream iss(line);
-        string token;
-        Flight f;
-
-        // Flight Number
-        getline(iss, token, ',');
-        if (!checkNumber(token)) continue;
-        f.flightNo = stoi(token);
-
-        // Departure
-        getline(iss, f.from, ',');
-
-        // Destination
-        getline(iss, f.to, ',');
-
-        // Boarding time
-        getline(iss, token, ',');
-        if (!checkTime(token)) continue;
-        size_t colon = token.find(':');
-        f.t_leave.hour = stoi(token.substr(0, colon));
-        f.t_leave.min = stoi(token.substr(colon + 1));
-
-        // Arrival time
-        getline(iss, token, ',');
-        if (!checkTime(token)) continue;
-        colon = token.find(':');
-        f.t_arrive.hour = stoi(token.substr(0, colon));
-        f.t_arrive.min = stoi(token.substr(colon + 1));
-
-        // Ticket price
-        getline(iss, token, ',');
-        if (!checkNumber(token)) continue;
-        f.cost = stoi(token);
-
-        // Plane type
-        getline(iss, f.plane_type, ',');
-
-        // Number of seats
-        getline(iss, token, ',');
-        if (!checkNumber(token)) continue;
-        f.seats = stoi(token);
-
-        // Booked seats
-        getline(iss, token, ',');
-        if (!checkNumber(token)) continue;
-        f.booked_seats = stoi(token);
-
-        // Business seats
-        getline(iss, token, ',');
-        if (!checkNumber(token)) continue;
-        f.businessSeats = stoi(token);
-
-        // Booked business seats
-        getline(iss, token, ',');
-        if (!checkNumber(token)) continue;
-        f.bookedBusinessSeats = stoi(token);
+void NameIndex::Dictionary::unmark(Array<int>* byDistance, int maxEdits) {
+    for (int d = 0; d <= maxEdits; d++) {
+        for (int i = 0; i < byDistance[d].count; i++) marks[byDistance[d].items[i]] = NO_MATCH;
+    }
+}
 
-        // Economy seats
-        getline(iss, token, ',');
-        if (!checkNumber(token)) continue;
-        f.economySeats = stoi(token);
+void NameIndex::insert(int passport, const string& name, const string& surname) {
+    string last = normalize(surname), first = normalize(name);
+    if (last.empty()) return;
 
-        // Booked economy seats
-        getline(iss, token, ',');
-        if (!checkNumber(token)) continue;
-        f.bookedEconomySeats = stoi(token);
+    int lastId = surnames.acquire(last);
+    Entry entry = { passport, first.empty() ? -1 : firstNames.acquire(first) };
+    while (bySurname.count <= lastId) bySurname.push(nullptr);
+    if (!bySurname.items[lastId]) bySurname.items[lastId] = new Array<Entry>();
+    bySurname.items[lastId]->push(entry);
+    customers++;
+}
 
-        // Weather
-        getline(iss, f.weather, ',');
+void NameIndex::erase(int passport, const string& name, const string& surname) {
+    string last = normalize(surname), first = normalize(name);
+    int lastId = last.empty() ? -1 : surnames.find(last);
+    if (lastId < 0 || lastId >= bySurname.count || !bySurname.items[lastId]) return;
+
+    Array<Entry>& entries = *bySurname.items[lastId];
+    for (int i = 0; i < entries.count; i++) {
+        if (entries.items[i].passport != passport) continue;
+        if (entries.items[i].first >= 0) firstNames.release(entries.items[i].first);
+        entries.removeAt(i);
+        if (entries.count == 0) {
+            delete bySurname.items[lastId];
+            bySurname.items[lastId] = nullptr;
+        }
+        surnames.release(lastId);
+        customers--;
+        return;
+    }
+}
 
-        // Day of week
-        getline(iss, f.dayOfWeek);
+void NameIndex::clear() {
+    for (int i = 0; i < bySurname.count; i++) delete bySurname.items[i];
+    bySurname.release();
+    surnames.clear();
+    firstNames.clear();
+    customers = 0;
+}
 
-        flist.push_back(f);
-        flightBST.insert(f.flightNo, &flist.getTail()->data);
+int NameIndex::search(const string& query, Match* out, int limit) {
+    FRS_TIMED(OP_SEARCH_NAMES);
+    size_t comma = query.find(',');
+    string last, first;
+    if (comma != string::npos) {
+        last = normalize(query.substr(0, comma));
+        first = normalize(query.substr(comma + 1));
+    }
+    else {
+        istringstream words(query);
+        string word, rest;
+        words >> word;
+        getline(words, rest);
+        last = normalize(word);
+        first = normalize(rest);
+    }
+    if (last.empty() || limit <= 0) return 0;
+
+    // Exact prefixes first; the trigram lookups only run when they fall short
+    int n = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        int lastEdits = pass ? editsFor(last) : 0;
+        int firstEdits = pass ? editsFor(first) : 0;
+        if (pass && lastEdits + firstEdits == 0) break;
+
+        Array<int> lastMatches[MAX_EDITS + 1], firstMatches[MAX_EDITS + 1];
+        surnames.match(last, lastEdits, lastMatches);
+        if (!first.empty()) firstNames.match(first, firstEdits, firstMatches);
+        n = collect(lastMatches, lastEdits, !first.empty(), out, limit);
+        surnames.unmark(lastMatches, lastEdits);
+        if (!first.empty()) firstNames.unmark(firstMatches, firstEdits);
+        if (n == limit) break;
+    }
+    return n;
+}
 
-        // Create queue for this flight if it doesn't exist
-        bool queueExists = false;
-        for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-            if (f.flightNo == qnode->data.getNo()) {
-                queueExists = true;
-                break;
+// Scans the customers of the matched surnames, filtering by the marked first
+// names when wanted. Results are bucketed by total distance; a bucket is
+// final once every surname at or below that distance has been scanned.
+int NameIndex::collect(Array<int>* lastMatches, int lastEdits, bool byFirstName, Match* out, int limit) {
+    const int BUCKETS = 2 * MAX_EDITS + 1;
+    Match* buckets = new Match[BUCKETS * limit];
+    int filled[BUCKETS] = {};
+    int ready = 0;
+    for (int d = 0; d <= lastEdits && ready < limit; d++) {
+        for (int i = 0; i < lastMatches[d].count && ready < limit; i++) {
+            int id = lastMatches[d].items[i];
+            if (id >= bySurname.count || !bySurname.items[id]) continue;
+            const Array<Entry>& entries = *bySurname.items[id];
+            for (int e = 0; e < entries.count; e++) {
+                int total = d;
+                if (byFirstName) {
+                    int firstId = entries.items[e].first;
+                    int fd = firstId >= 0 ? firstNames.distance(firstId) : Dictionary::NO_MATCH;
+                    if (fd == Dictionary::NO_MATCH) continue;
+                    total += fd;
+                }
+                if (filled[total] == limit) continue;
+                buckets[total * limit + filled[total]++] = Match{ entries.items[e].passport, total };
+                if (total <= d && ++ready == limit) break;
             }
         }
-        if (!queueExists) {
-            Queue q(f.flightNo);
-            qlist.push_back(q);
+        if (d + 1 <= lastEdits) {
+            ready = 0;
+            for (int t = 0; t <= d + 1; t++) ready += filled[t];
         }
     }
-    file.close();
-}
 
-void Flight::saveToFile() {
-    ofstream file("flights2.txt");
-    if (!file.is_open()) {
-        cerr << "Error: Could not save flight data to file." << endl;
-        return;
+    int n = 0;
+    for (int t = 0; t < BUCKETS && n < limit; t++) {
+        for (int i = 0; i < filled[t] && n < limit; i++) out[n++] = buckets[t * limit + i];
     }
-
-    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
-        file << node->data.getFlightNo() << ","
-            << node->data.getDeparture() << ","
-            << node->data.getDestination() << ","
-            << setw(2) << setfill('0') << node->data.getLeavingTime().hour << ":"
-            << setw(2) << setfill('0') << node->data.getLeavingTime().min << ","
-            << setw(2) << setfill('0') << node->data.getArrivingTime().hour << ":"
-            << setw(2) << setfill('0') << node->data.getArrivingTime().min << ","
-            << node->data.getCost() << ","
-            << node->data.getPlaneType() << ","
-            << node->data.getAvailableSeats() + node->data.getBookedSeats() << ","
-            << node->data.getBookedSeats() << ","
-            << node->data.getBusinessSeats() << ","
-            << node->data.getBookedBusinessSeats() << ","
-            << node->data.getEconomySeats() << ","
-            << node->data.getBookedEconomySeats() << ","
-            << node->data.getWeather() << ","
-            << node->data.getDayOfWeek() << "\n";
-    }
-    file.close();
+    delete[] buckets;
+    return n;
 }
 
-void Customer::loadFromFile() {
-    ifstream file("passengers2.txt");
-    if (!file.is_open()) return;
-
-    customerBST = CustomerBST(); // Reset BST
+// Intrusive timer; embed it in the object that needs a deadline.
+struct TimerNode {
+    unsigned long long deadline;
+    TimerNode* next;
+    TimerNode* prev;
+    int level, slot;  // where it is filed, -1 when not scheduled
+};
 
-    string line;
-    while (getline(file, line)) {
-        if (line.empty()) continue;
+// Hierarchical timing wheel: LEVELS wheels of SLOTS slots, each level SLOTS
+// times coarser than the one below. Scheduling and cancelling are O(1).
+// Advancing one tick expires a single level-0 slot; every SLOTS ticks the
+// next slot of the level above is re-filed one level down, so each timer
+// moves at most LEVELS times however many are pending.
+class TimerWheel {
+public:
+    typedef void (*Expire)(TimerNode* node, void* context);
 
-        istringstream iss(line);
-        string token;
-        Customer* p = new Customer();
-        int discountValue;
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
 
-        // Passport Number
-        getline(iss, token, ',');
-        if (!checkNumber(token)) {
-            delete p;
-            continue;
+    TimerWheel() : now(0), count(0) {
+        for (int l = 0; l < LEVELS; l++) {
+            for (int s = 0; s < SLOTS; s++) slots[l][s] = nullptr;
         }
-        p->passportNo = stoi(token);
-
-        // Name
-        getline(iss, p->name, ',');
-
-        // Surname
-        getline(iss, p->surname, ',');
-
-        // Nationality
-        getline(iss, p->nationality, ',');
+    }
 
-        // Address
-        getline(iss, p->address, ',');
+    // Deadlines at or before the current tick expire on the next advance.
+    void schedule(TimerNode* node, unsigned long long deadline) {
+        node->deadline = deadline > now ? deadline : now + 1;
+        file(node);
+        count++;
+    }
 
-        // Telephone
-        getline(iss, token, ',');
-        if (!checkNumber(token)) {
-            delete p;
-            continue;
-        }
-        p->tel = stoi(token);
+    void cancel(TimerNode* node) {
+        if (node->level < 0) return;
+        unlink(node);
+        count--;
+    }
 
-        // Discount Type
-        getline(iss, token, ',');
-        if (!checkNumber(token)) {
-            delete p;
-            continue;
+    // Moves time forward to tick, calling expire for every timer due by then.
+    void advance(unsigned long long tick, Expire expire, void* context) {
+        if (count == 0) {
+            if (tick > now) now = tick;
+            return;
         }
-        discountValue = stoi(token);
-        p->discount = static_cast<offers>(discountValue);
+        while (now < tick) {
+            now++;
+            for (int level = 1; level < LEVELS; level++) {
+                if (now & ((1ULL << (SLOT_BITS * level)) - 1)) break;
+                cascade(level, static_cast<int>((now >> (SLOT_BITS * level)) & (SLOTS - 1)));
+            }
 
-        // Total Spent
-        getline(iss, token, ',');
-        if (!checkNumber(token)) {
-            delete p;
-            continue;
-        }
-        p->totalSpent = stoi(token);
-
-        // Flights
-        string flightsStr;
-        getline(iss, flightsStr);
-        if (!flightsStr.empty()) {
-            istringstream flightsStream(flightsStr);
-            string flightToken;
-            while (getline(flightsStream, flightToken, ';')) {
-                if (checkNumber(flightToken)) {
-                    p->flights.push_back(stoi(flightToken));
-                }
+            int index = static_cast<int>(now & (SLOTS - 1));
+            TimerNode* due = slots[0][index];
+            slots[0][index] = nullptr;
+            while (due) {
+                TimerNode* next = due->next;
+                due->level = due->slot = -1;
+                count--;
+                expire(due, context);  // may schedule new timers
+                due = next;
             }
+            if (count == 0 && now < tick) now = tick;
         }
-
-        customerBST.insert(p->passportNo, p);
     }
-    file.close();
-}
 
-void Customer::saveToFile() {
-    ofstream file("passengers2.txt");
-    if (!file.is_open()) {
-        cerr << "Error: Could not open passengers.txt for writing." << endl;
-        return;
-    }
+    size_t size() const { return count; }
+    unsigned long long current() const { return now; }
 
-    DoublyLinkedList<Customer*> customers = customerBST.getAllCustomers();
-    for (ListNode<Customer*>* node = customers.begin(); node != customers.end(); node = node->next) {
-        try {
-            Customer* p = node->data;
-            // Save basic customer info
-            file << p->getPassport() << ","
-                << p->getName() << ","
-                << p->getSurname() << ","
-                << p->getNationality() << ","
-                << p->getAddress() << ","
-                << p->getTel() << ","
-                << static_cast<int>(p->getDiscount()) << ","
-                << p->getTotalSpent();
-
-            // Save flight list if not empty
-            if (!p->getFlights().empty()) {
-                file << ",";  // Separator before flight list
-
-                bool firstFlight = true;
-                ListNode<int>* fnode = p->getFlights().begin();
-
-                // Safer iteration using while loop
-                while (fnode != nullptr) {
-                    if (fnode->data < 0) {
-                        throw runtime_error("Invalid flight number: " + to_string(fnode->data));
-                    }
+private:
+    void file(TimerNode* node) {
+        const unsigned long long horizon = 1ULL << (SLOT_BITS * LEVELS);
+        unsigned long long deadline = node->deadline;
+        if (deadline - now >= horizon) deadline = now + horizon - 1;  // re-filed when it cascades
+
+        unsigned long long delta = deadline - now;
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (1ULL << (SLOT_BITS * (level + 1)))) level++;
+        int slot = static_cast<int>((deadline >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+        node->level = level;
+        node->slot = slot;
+        node->prev = nullptr;
+        node->next = slots[level][slot];
+        if (node->next) node->next->prev = node;
+        slots[level][slot] = node;
+    }
 
-                    if (!firstFlight) {
-                        file << ";";
-                    }
-                    file << fnode->data;
-                    firstFlight = false;
+    void unlink(TimerNode* node) {
+        if (node->prev) node->prev->next = node->next;
+        else slots[node->level][node->slot] = node->next;
+        if (node->next) node->next->prev = node->prev;
+        node->level = node->slot = -1;
+    }
 
-                    // Safely advance to next node
-                    ListNode<int>* nextNode = fnode->next;
-                    if (nextNode == fnode) {  // Detect circular reference
-                        throw runtime_error("Circular reference in flight list");
-                    }
-                    fnode = nextNode;
-                }
-            }
-            file << "\n";
-        }
-        catch (const exception& e) {
-            cerr << "Error saving customer " << node->data->getPassport()
-                << ": " << e.what() << endl;
-            // Continue with next customer
+    void cascade(int level, int slot) {
+        TimerNode* node = slots[level][slot];
+        slots[level][slot] = nullptr;
+        while (node) {
+            TimerNode* next = node->next;
+            file(node);
+            node = next;
         }
     }
 
-    if (!file.good()) {
-        cerr << "Error: Failed to write all data to file." << endl;
-    }
-    file.close();
-}
+    TimerNode* slots[LEVELS][SLOTS];
+    unsigned long long now;
+    size_t count;
+};
 
-void Queue::loadFromFile() {
-    ifstream file("queues2.txt");
-    if (!file.is_open()) return;
+// ---------------------------------------------------------------------------
+// Snapshot reads
+//
+// Threads other than the engine read flights and customers through
+// immutable versions instead of the live records. The engine copies a
+// record into a new version after each change and swaps it in with one
+// atomic store, so a reader sees a booking either fully applied or not at
+// all and never takes the engine lock. Old versions are retired with the
+// global epoch at the time; a reader announces the epoch it started in,
+// and a retired version is freed once every active reader started after
+// it. Only the records are versioned: the engine thread alone adds or
+// removes flights and customers, and readers must not run across a reload.
+// Publishing is off until enable(), which the server's --readers and the
+// stress test call; the console and a server without readers pay nothing.
+// ---------------------------------------------------------------------------
+
+struct Retired {
+    Retired* next;
+    unsigned long long epoch;
+    void (*destroy)(Retired*);
+};
 
-    qlist.clear();
+class Snapshots {
+public:
+    static const int MAX_READERS = 64;
+
+    // Marks the calling thread as reading until it goes out of scope;
+    // versions read inside stay valid until then. Nests.
+    class ReadGuard {
+    public:
+        ReadGuard();
+        ~ReadGuard();
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+    };
 
-    string line;
-    while (getline(file, line)) {
-        if (line.empty()) continue;
+    static bool enabled;
+    // Turns publishing on and publishes every loaded flight and customer.
+    static void enable();
+    static void publishAll();
 
-        istringstream iss(line);
-        string token;
+    // Frees the version once no reader can still hold it.
+    static void retire(Retired* version, void (*destroy)(Retired*));
+    // Frees what no active reader can see; returns how many.
+    static int reclaim();
+    static int pending();
+    static unsigned long long retiredCount() { return retiredTotal; }
+    static unsigned long long reclaimedCount() { return reclaimedTotal; }
 
-        // Queue Number
-        getline(iss, token, ':');
-        if (!checkNumber(token)) continue;
-        int queueNo = stoi(token);
+private:
+    struct alignas(64) Slot {
+        atomic<unsigned long long> epoch;  // 0 while the thread is not reading
+        atomic<bool> used;
+    };
+    // Gives the thread's slot back when it exits.
+    struct SlotOwner {
+        int slot = -1;
+        int depth = 0;
+        ~SlotOwner();
+    };
+    static Slot* acquireSlot();
+
+    static Slot slots[MAX_READERS];
+    static atomic<unsigned long long> globalEpoch;
+    static thread_local SlotOwner owner;
+    static mutex retiredLock;
+    static Retired* retiredHead;
+    static int retiredPending;
+    static unsigned long long retiredTotal, reclaimedTotal;
+};
 
-        // Find or create queue
-        Queue* currentQueue = nullptr;
-        for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-            if (queueNo == qnode->data.getNo()) {
-                currentQueue = &qnode->data;
+// Defined ahead of flist and customerBST so they outlive every version.
+Snapshots::Slot Snapshots::slots[Snapshots::MAX_READERS];
+atomic<unsigned long long> Snapshots::globalEpoch(1);
+thread_local Snapshots::SlotOwner Snapshots::owner;
+mutex Snapshots::retiredLock;
+Retired* Snapshots::retiredHead = nullptr;
+int Snapshots::retiredPending = 0;
+unsigned long long Snapshots::retiredTotal = 0, Snapshots::reclaimedTotal = 0;
+bool Snapshots::enabled = false;
+
+Snapshots::Slot* Snapshots::acquireSlot() {
+    if (owner.slot < 0) {
+        for (int i = 0; i < MAX_READERS; i++) {
+            bool expected = false;
+            if (slots[i].used.compare_exchange_strong(expected, true)) {
+                owner.slot = i;
                 break;
             }
         }
-        if (!currentQueue) {
-            Queue newQueue(queueNo);
-            qlist.push_back(newQueue);
-            currentQueue = &qlist.getTail()->data;
-        }
-
-        // Passengers in queue
-        string passengerStr;
-        getline(iss, passengerStr);
-        if (!passengerStr.empty()) {
-            istringstream passengerStream(passengerStr);
-            string passportToken;
-            while (getline(passengerStream, passportToken, ';')) {
-                if (checkNumber(passportToken)) {
-                    int passport = stoi(passportToken);
-                    // Find the Customer in BST
-                    Customer* customer = customerBST.find(passport);
-                    if (customer) {
-                        currentQueue->enqueue(*customer);
-                    }
-                }
-            }
+        if (owner.slot < 0) {
+            cerr << "Error: more than " << MAX_READERS << " snapshot reader threads." << endl;
+            abort();
         }
     }
-    file.close();
+    return &slots[owner.slot];
 }
 
-void Queue::saveToFile() {
-    ofstream file("queues2.txt");
-    if (!file.is_open()) {
-        cerr << "Error: Could not save queue data to file." << endl;
-        return;
-    }
+Snapshots::SlotOwner::~SlotOwner() {
+    if (slot >= 0) slots[slot].used.store(false);
+}
 
-    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-        file << qnode->data.getNo() << ":";
+Snapshots::ReadGuard::ReadGuard() {
+    if (owner.depth++ > 0) return;
+    // Sequentially consistent with the writer's swap: either this reader
+    // loads the new version, or the writer sees this epoch and keeps the old.
+    acquireSlot()->epoch.store(globalEpoch.load());
+}
 
-        bool firstPassenger = true;
-        QueueNode* current = qnode->data.getFront();
-        while (current) {
-            if (!firstPassenger) file << ";";
-            file << current->Customer.getPassport();
-            firstPassenger = false;
-            current = current->next;
+Snapshots::ReadGuard::~ReadGuard() {
+    if (--owner.depth > 0) return;
+    slots[owner.slot].epoch.store(0, memory_order_release);
+}
+
+void Snapshots::retire(Retired* version, void (*destroy)(Retired*)) {
+    version->destroy = destroy;
+    version->epoch = globalEpoch.fetch_add(1);
+    bool sweep;
+    {
+        lock_guard<mutex> guard(retiredLock);
+        version->next = retiredHead;
+        retiredHead = version;
+        retiredTotal++;
+        sweep = ++retiredPending % 64 == 0;
+    }
+    if (sweep) reclaim();
+}
+
+int Snapshots::reclaim() {
+    unsigned long long oldest = ~0ULL;
+    for (int i = 0; i < MAX_READERS; i++) {
+        unsigned long long epoch = slots[i].epoch.load();
+        if (epoch && epoch < oldest) oldest = epoch;
+    }
+    Retired* freed = nullptr;
+    {
+        lock_guard<mutex> guard(retiredLock);
+        Retired** link = &retiredHead;
+        while (*link) {
+            Retired* version = *link;
+            if (version->epoch < oldest) {
+                *link = version->next;
+                version->next = freed;
+                freed = version;
+                retiredPending--;
+            }
+            else {
+                link = &version->next;
+            }
         }
-        file << "\n";
     }
-    file.close();
+    int count = 0;
+    while (freed) {
+        Retired* next = freed->next;
+        freed->destroy(freed);
+        freed = next;
+        count++;
+    }
+    lock_guard<mutex> guard(retiredLock);
+    reclaimedTotal += count;
+    return count;
 }
 
-// Flight member functions implementation
-void Flight::addFlight() {
-    string temp;
-    bool flag = false;
+int Snapshots::pending() {
+    lock_guard<mutex> guard(retiredLock);
+    return retiredPending;
+}
 
-    cout << "Add new flights by giving the following attributes:\n";
-    cin.clear();
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+// The published version of a record. A copy starts with nothing published
+// and assigning keeps the target's own version, so queue snapshots and
+// other copies of a record never share or free its versions.
+template <typename T>
+class Versioned {
+public:
+    Versioned() : current(nullptr) {}
+    Versioned(const Versioned&) : current(nullptr) {}
+    Versioned& operator=(const Versioned&) { return *this; }
+    ~Versioned() { clear(); }
+
+    // Engine thread only.
+    void publish(const T& value) {
+        retireVersion(current.exchange(new Version(value)));
+    }
+    void clear() { retireVersion(current.exchange(nullptr)); }
 
-    // Flight Number
-    do {
-        cout << "Flight Number: ";
-        getline(cin, temp);
+    // Only inside a Snapshots::ReadGuard; null when nothing is published.
+    const T* read() const {
+        Version* version = current.load();
+        return version ? &version->value : nullptr;
+    }
 
-        if (!checkNumber(temp)) {
-            cout << "Please insert a valid Flight Number!\n";
-            continue;
-        }
+private:
+    struct Version : Retired, MemoryTracked<Memory::MEM_SNAPSHOTS> {
+        T value;
+        explicit Version(const T& v) : Retired(), value(v) {}
+    };
+    static void destroy(Retired* version) { delete static_cast<Version*>(version); }
+    static void retireVersion(Version* version) {
+        if (version) Snapshots::retire(version, destroy);
+    }
 
-        int num = stoi(temp);
-        if (Flight::flightExists(num)) {
-            cout << "This Flight already exists!\n";
-            continue;
-        }
+    atomic<Version*> current;
+};
 
-        this->flightNo = num;
-        break;
-    } while (true);
+// A flight's schedule and inventory as one consistent version.
+struct FlightView {
+    int flightNo, cost, seats, bookedSeats;
+    int businessSeats, economySeats, bookedBusinessSeats, bookedEconomySeats;
+    int heldBusinessSeats, heldEconomySeats;
+    string from, to, planeType, weather, dayOfWeek;
+    Time leave, arrive;
+};
 
-    // Departure
-    do {
-        cout << "Departure: ";
-        getline(cin, this->from);
+// Seat of a parsed booking whose record had no seat field, until
+// Customer::claimBookings assigns one; never handed out as a seat.
+const unsigned short SEAT_PENDING = 65535;
 
-        if (this->from.length() > 20 || !checkString(this->from)) {
-            cout << "Please insert a valid Departure city!\n";
-            continue;
+// Which seat numbers are taken, one byte per seat; grows on demand.
+class SeatMap {
+public:
+    // Lowest free seat in first..last, now taken; 0 when there is none.
+    int assign(int first, int last) {
+        if (last >= SEAT_PENDING) last = SEAT_PENDING - 1;
+        if (static_cast<int>(taken.size()) <= last) taken.resize(last + 1, '\0');
+        for (int seat = first; seat <= last; seat++) {
+            if (!taken[seat]) {
+                taken[seat] = 1;
+                return seat;
+            }
         }
-        break;
-    } while (true);
-
-    // Destination
-    do {
-        cout << "Destination: ";
-        getline(cin, this->to);
+        return 0;
+    }
 
-        if (this->to.length() > 20 || !checkString(this->to) || this->to == this->from) {
-            cout << "Please insert a valid Destination city!\n";
-            continue;
-        }
-        break;
-    } while (true);
+    bool isTaken(int seat) const {
+        return seat > 0 && seat < static_cast<int>(taken.size()) && taken[seat];
+    }
 
-    // Boarding time
-    do {
-        cout << "Boarding time (e.g. 19:40): ";
-        getline(cin, temp);
+    void claim(int seat) {
+        if (seat <= 0) return;
+        if (static_cast<int>(taken.size()) <= seat) taken.resize(seat + 1, '\0');
+        taken[seat] = 1;
+    }
 
-        if (!checkTime(temp)) {
-            cout << "Please insert a valid boarding time (e.g. 19:40)!\n";
-            continue;
-        }
+    void release(int seat) {
+        if (seat > 0 && seat < static_cast<int>(taken.size())) taken[seat] = 0;
+    }
 
-        size_t colon = temp.find(':');
-        this->t_leave.hour = stoi(temp.substr(0, colon));
-        this->t_leave.min = stoi(temp.substr(colon + 1));
-        break;
-    } while (true);
+    size_t heapBytes() const { return stringHeapBytes(taken); }
 
-    // Arrival time
-    do {
-        cout << "Arriving time (e.g. 21:40): ";
-        getline(cin, temp);
+private:
+    string taken;
+};
 
-        if (!checkTime(temp)) {
-            cout << "Please insert a valid arriving time (e.g. 21:40)!\n";
-            continue;
-        }
+class Flight {
+private:
+    int flightNo, cost, seats, booked_seats, availableSeats;
+    int businessSeats, economySeats, bookedBusinessSeats, bookedEconomySeats;
+    string from, to, plane_type, weather, dayOfWeek;
+    Time t_leave, t_arrive;
+    // Rendered schedule table row; empty when it must be reformatted.
+    mutable string scheduleRow;
+    // Seat prices in cents by cabin (0 economy, 1 business) and offer; see
+    // buildFares(). Read without the booking lock by concurrent quotes.
+    long long fareCents[2][OFFER_COUNT];
+    int waitlistDepth;
+    // Seats taken out of availability by SeatHolds; never saved.
+    int heldBusinessSeats, heldEconomySeats;
+    // Seats held by undated bookings; rebuilt from the booking records on load.
+    SeatMap seatMap;
+    // Weekly template for dated departures: bit d is weekday d (0 Monday),
+    // in force from firstDate through lastDate (0 leaves that end open).
+    // Taken from dayOfWeek unless schedules.txt lists the flight.
+    unsigned char operatingDays;
+    int firstDate, lastDate;
+    // Bookings accepted beyond each cabin's seats (0 economy, 1 business);
+    // from overbook.txt, see the overbooking analysis.
+    int overbookLimit[2];
+    // What other threads read; see "Snapshot reads".
+    Versioned<FlightView> view;
 
-        size_t colon = temp.find(':');
-        this->t_arrive.hour = stoi(temp.substr(0, colon));
-        this->t_arrive.min = stoi(temp.substr(colon + 1));
+public:
+    Flight() : flightNo(0), cost(0), seats(0), booked_seats(0), businessSeats(0), economySeats(0),
+        bookedBusinessSeats(0), bookedEconomySeats(0), fareCents(), waitlistDepth(0),
+        heldBusinessSeats(0), heldEconomySeats(0), operatingDays(0), firstDate(0), lastDate(0), overbookLimit() {
+    }
+    Flight(int no, int c, int s, int bs, string f, string t, string pt, Time tl, Time ta, string w, string d)
+        : flightNo(no), cost(c), seats(s), booked_seats(bs), businessSeats(0), economySeats(s),
+        bookedBusinessSeats(0), bookedEconomySeats(bs), from(f), to(t), plane_type(pt), weather(w), dayOfWeek(d),
+        t_leave(tl), t_arrive(ta), fareCents(), waitlistDepth(0), heldBusinessSeats(0), heldEconomySeats(0),
+        operatingDays(parseOperatingDays(d)), firstDate(0), lastDate(0), overbookLimit() {
+    }
+    int getBookedSeats() const { return booked_seats; }
+    static void updateFlight(int flightNumber);
+    // Applies every change or, when one fails validation, none of them (the
+    // reason goes to error). Returns how many distinct flights changed, or
+    // -1 when the batch was rejected.
+    static int applyChanges(const FlightChange* changes, int n, string& error);
+    static void loadFromFile();
+    // Parses one line in the flights2.txt layout; false when a field is invalid.
+    static bool parseRecord(const string& line, Flight& f);
+    // Rebuilds flightBST from flist and returns how many repeated flight
+    // numbers were dropped.
+    static int indexFlights();
+    static void loadOverbookLimits(const string& path);
+    static void loadSchedules(const string& path);
+    static void saveToFile();
+    static void writeRecords(ostream& file);
 
-        if (!checkTime2(this->t_arrive, this->t_leave)) {
-            cout << "Arrival time must be after departure time!\n";
-            continue;
-        }
-        break;
-    } while (true);
+    // Flight management
+    void addFlight();
+    static void deleteFlight(int num);
 
-    // Ticket price
-    do {
-        cout << "Ticket price: ";
-        getline(cin, temp);
+    // Display functions
+    void displayInfo() const;
+    static void displayFlightInfo(int num);
+    static void displaySchedule();
+    static void browseSchedule();
+
+    // Booking functions. A nonzero date works on that dated departure (see
+    // DatedFlights) instead of the flight's own, undated inventory.
+    static void resSeat(int num, int val, bool isBusiness, int date = 0);
+    // With overbook set, the cabin's overbooking limit counts as seats.
+    static bool holdSeat(int num, bool isBusiness, bool overbook, int date = 0);
+    static void releaseSeat(int num, bool isBusiness, int date = 0);
+    static bool checkForSeats(int num);
+    static bool flightExists(int num);
+    int seatsLeft(bool businessClass, bool overbook, int date) const;
+    // Lowest free seat number in the cabin, now taken; 0 when it is full.
+    int assignSeat(bool businessClass, int date = 0);
+    void claimSeat(int seat, int date = 0);
+    // Whether the seat is in the cabin and nobody holds it.
+    bool seatFree(bool businessClass, int seat, int date = 0) const;
+    void freeSeat(int seat, int date = 0);
+
+    // Schedule template
+    bool operatesOn(int date) const;
+    bool arrivesNextDay() const {
+        return t_arrive.hour * 60 + t_arrive.min <= t_leave.hour * 60 + t_leave.min;
+    }
+    const string& getWeather() const { return weather; }
+    const string& getDayOfWeek() const { return dayOfWeek; }
+    void setWeather(const string& w) { weather = w; invalidateRow(); }
+    void setDayOfWeek(const string& d) { dayOfWeek = d; operatingDays = parseOperatingDays(d); invalidateRow(); }
 
-        if (!checkNumber(temp)) {
-            cout << "Please insert a valid ticket price!\n";
-            continue;
-        }
-        this->cost = stoi(temp);
-        break;
-    } while (true);
+    // Getters
+    int getFlightNo() const { return flightNo; }
+    int getCost() const { return cost; }
+    Money fare(bool businessClass, offers discount) const {
+        return Money::fromCents(relaxedLoad(fareCents[businessClass][static_cast<int>(discount)]));
+    }
+    void buildFares();
+    static void waitlistChanged(int num, int depth);
+    int getWaitlistDepth() const { return waitlistDepth; }
+    Time getLeavingTime() const { return t_leave; }
+    Time getArrivingTime() const { return t_arrive; }
+    const string& getDeparture() const { return from; }
+    const string& getDestination() const { return to; }
+    const string& getPlaneType() const { return plane_type; }
+    int getSeats() const { return seats; }
+    int getAvailableSeats() const { return seats - booked_seats; }
+    void setAvailableSeats(int seats) { availableSeats = seats; }
 
-    // Aeroplane type
-    do {
-        cout << "Aeroplane type: ";
-        getline(cin, this->plane_type);
+    // Business/Economy class getters
+    int getBusinessSeats() const { return businessSeats; }
+    int getEconomySeats() const { return economySeats; }
+    int getBookedBusinessSeats() const { return bookedBusinessSeats; }
+    int getBookedEconomySeats() const { return bookedEconomySeats; }
+    int getAvailableBusinessSeats() const { return businessSeats - bookedBusinessSeats - heldBusinessSeats; }
+    int getAvailableEconomySeats() const { return economySeats - bookedEconomySeats - heldEconomySeats; }
+    // Available seats plus the overbooking still allowed in the cabin.
+    int getBookableSeats(bool businessClass) const {
+        return (businessClass ? getAvailableBusinessSeats() : getAvailableEconomySeats()) + overbookLimit[businessClass];
+    }
+    int getOverbookLimit(bool businessClass) const { return overbookLimit[businessClass]; }
 
-        if (this->plane_type.empty()) {
-            cout << "Please insert a valid Aeroplane type!\n";
-            continue;
-        }
-        break;
-    } while (true);
+    // Setters
+    void setBookedSeats(int bs) { booked_seats = bs; invalidateRow(); }
+    void setBookedBusinessSeats(int bs) { bookedBusinessSeats = bs; buildFares(); invalidateRow(); }
+    void setBookedEconomySeats(int bs) { bookedEconomySeats = bs; buildFares(); invalidateRow(); }
+
+    // Field layout of flights2.txt; see "Record schemas".
+    friend struct FlightSchema;
+
+    // Schedule view cache
+    const string& renderedRow() const;
+    void invalidateRow() { scheduleRow.clear(); publish(); }
+
+    // Snapshot reads: publish() is called after every change once
+    // Snapshots::enabled is set; snapshot() is for ReadGuard holders.
+    void publish();
+    // Copies the live record; engine thread only.
+    void capture(FlightView& v) const;
+    const FlightView* snapshot() const { return view.read(); }
+
+    // Heap held by the text fields, row cache and seat map; see memstats.
+    size_t stringBytes() const {
+        return stringHeapBytes(from) + stringHeapBytes(to) + stringHeapBytes(plane_type) + stringHeapBytes(weather)
+            + stringHeapBytes(dayOfWeek) + stringHeapBytes(scheduleRow) + seatMap.heapBytes();
+    }
+};
 
-    // Number of seats
-    do {
-        cout << "Total number of seats: ";
-        getline(cin, temp);
+// One departure of a flight's weekly template on a given date.
+struct DatedFlight : MemoryTracked<Memory::MEM_DATED_FLIGHTS> {
+    int flightNo, date;
+    int booked[2], held[2];  // 0 economy, 1 business
+    SeatMap seats;
+    DatedFlight* next;       // hash chain
+};
 
-        if (!checkNumber(temp)) {
-            cout << "Please insert a valid number of seats!\n";
-            continue;
-        }
-        this->seats = stoi(temp);
+// Dated departures exist only while something is booked or held on them.
+// An instance is created the first time its date is booked or held and is
+// dropped when the last booking or hold goes, so memory follows activity
+// rather than the calendar. A date with no instance has the template's
+// cabins all free.
+class DatedFlights {
+public:
+    static DatedFlight* find(int flightNo, int date);
+    static DatedFlight* materialize(int flightNo, int date);
+    // Drops the instance if nothing is booked or held on it any more.
+    static void releaseIfIdle(DatedFlight* instance);
+    static void dropFlight(int flightNo);
+    static void clear();
+    static int size() { return count; }
 
-        // Business class seats
-        cout << "Number of business class seats: ";
-        getline(cin, temp);
+private:
+    static unsigned bucketOf(int flightNo, int date) {
+        unsigned h = static_cast<unsigned>(flightNo) * 2654435761u ^ static_cast<unsigned>(date) * 40503u;
+        return (h ^ h >> 15) & (bucketCount - 1);
+    }
+    static void unlink(DatedFlight* instance);
 
-        if (!checkNumber(temp) || stoi(temp) > this->seats) {
-            cout << "Please insert a valid number of business class seats!\n";
-            continue;
-        }
-        this->businessSeats = stoi(temp);
-        this->economySeats = this->seats - this->businessSeats;
-        break;
-    } while (true);
+    static DatedFlight** buckets;
+    static int bucketCount, count;
+};
 
-    // Number of booked seats
-    do {
-        cout << "Number of booked business class seats: ";
-        getline(cin, temp);
+// One seat a customer paid for. Seat numbers run 1..business seats for the
+// business cabin and on through economy; 0 means no seat was assigned (an
+// overbooked or legacy booking). A negative fare means the price paid is
+// unknown and cancellation falls back to the current quote.
+struct Booking {
+    Money fare;
+    time_t bookedAt;
+    int flightNo;
+    int date;  // departure day for a dated booking, 0 for the undated flight
+    unsigned short seat;
+    bool businessClass;
+};
 
-        if (!checkNumber(temp) || stoi(temp) > this->businessSeats) {
-            cout << "Please insert a valid number of booked business class seats!\n";
-            continue;
-        }
-        this->bookedBusinessSeats = stoi(temp);
+// Most customers hold a couple of bookings, which then stay inline.
+const int INLINE_BOOKINGS = 2;
 
-        cout << "Number of booked economy class seats: ";
-        getline(cin, temp);
+// A customer's details and bookings as one consistent version.
+struct CustomerView {
+    int passport;
+    string name, surname, nationality;
+    offers discount;
+    Money totalSpent;
+    SmallVector<Booking, INLINE_BOOKINGS> bookings;
+};
 
-        if (!checkNumber(temp) || stoi(temp) > this->economySeats) {
-            cout << "Please insert a valid number of booked economy class seats!\n";
-            continue;
-        }
-        this->bookedEconomySeats = stoi(temp);
+// Customer class
+class Customer : public MemoryTracked<Memory::MEM_CUSTOMERS> {
+private:
+    int passportNo, tel;
+    SmallVector<Booking, INLINE_BOOKINGS> bookings;
+    string name, surname, nationality, address;
+    offers discount;
+    Money totalSpent;
+    // What other threads read; see "Snapshot reads".
+    Versioned<CustomerView> view;
 
-        this->booked_seats = this->bookedBusinessSeats + this->bookedEconomySeats;
-        break;
-    } while (true);
 
-    do {
-        cout << "Weather condition (e.g., Sunny, Rainy, Cloudy, etc.): ";
-        getline(cin, this->weather);
-        if (this->weather.empty()) {
-            cout << "Please enter a valid weather condition!\n";
-            continue;
-        }
-        break;
-    } while (true);
+    // Field layout of passengers2.txt; see "Record schemas".
+    friend struct CustomerSchema;
+    friend struct BookingListField;
 
-    // Day of week
-    do {
-        cout << "Day of week (e.g., Monday, Tuesday, etc.): ";
-        getline(cin, this->dayOfWeek);
-        if (this->dayOfWeek.empty()) {
-            cout << "Please enter a valid day of week!\n";
-            continue;
-        }
-        break;
-    } while (true);
+public:
+    // Constructors
+    Customer() : passportNo(0), tel(0), discount(offers::NONE) {}
+    Customer(int pn, int t, string n, string s, string nat, string addr, offers d)
+        : passportNo(pn), tel(t), name(n), surname(s), nationality(nat), address(addr), discount(d) {
+    }
+    void manageQueue(int num);
+    // File operations
+    static void loadFromFile();
+    static void saveToFile();
+    static void writeRecords(ostream& file);
+    // Parses one line in the passengers2.txt layout; null when a field is
+    // invalid. The bookings take no seats until claimBookings().
+    static Customer* parseRecord(const string& line, time_t now);
+    // Takes the seats of freshly parsed bookings and gives the ones read
+    // without a seat field the lowest free seat.
+    void claimBookings();
+    // Whether claimBookings() can take every booking: each flight (and date)
+    // exists, its cabin has room and a given seat is free. Otherwise the
+    // reason goes to error.
+    bool bookingsFit(string& error) const;
+    // Builds customerBST from the records. Of a repeated passport only the
+    // first is kept; the rest are freed and nulled, and their count returned.
+    static int indexCustomers(Customer** customers, int n);
 
-    flist.push_back(*this);
-    flightBST.insert(this->flightNo, &flist.getTail()->data);
+    // Booking functions
+    void book();
+    void bookFromQueue(int num);
+    void cancel();
+    // A nonzero date prices that dated departure by the days left to it.
+    Money quote(const Flight* flight, bool businessClass, int date = 0) const;
+    // A nonzero date books or cancels that dated departure of the flight.
+    void confirmBooking(int num, bool businessClass, Money price, int date = 0);
+    static bool cancelBooking(int passport, int flightNum, Money& refundAmount, int date = 0);
+    bool hasFlight(int num, int date = 0) const;
+    // Drops every booking on the flight; returns how many and adds their fares to refund.
+    int removeFlight(int num, Money& refund);
 
-    Queue q(this->flightNo);
-    qlist.push_back(q);
+    // Information functions
+    static bool displayCustomerInfo(int passport);
+    // Lists the closest matches for "surname [first name]".
+    static void displaySearch(const string& query);
+    static bool uniquePass(int passport);
 
-    // Save to file
-    Flight::saveToFile();
-    Queue::saveToFile();
+    // Helper functions
+    void inputCustomeralInfo();
+    static Customer* registerRecord(const Customer& customer);
+    void applyDiscount();
+    int getDiscountPercent() const { return OFFER_DISCOUNT_BP[static_cast<int>(discount)] / 100; }
 
-    cout << "Flight No: " << this->flightNo << " was successfully added!\n";
-}
+    // Getters
+    int getPassport() const { return passportNo; }
+    string getName() const { return name; }
+    string getSurname() const { return surname; }
+    string getNationality() const { return nationality; }
+    string getAddress() const { return address; }
+    int getTel() const { return tel; }
+    offers getDiscount() const { return discount; }
+    Money getTotalSpent() const { return totalSpent; }
+    const SmallVector<Booking, INLINE_BOOKINGS>& getBookings() const { return bookings; }
 
-void Flight::deleteFlight(int num) {
-    // Check if flight exists
-    Flight* flight = flightBST.find(num);
-    if (!flight) {
-        cout << "Flight with number " << num << " does not exist!\n";
-        return;
-    }
+    // Setters
+    void setTotalSpent(Money amount) { totalSpent = amount; publish(); }
+    void setPassport(int passport) { passportNo = passport; }
 
-    // Find the queue for this flight
-    ListNode<Queue>* queueNodeToDelete = nullptr;
-    Queue* flightQueue = nullptr;
+    // Snapshot reads, as for Flight
+    void publish();
+    void capture(CustomerView& v) const;
+    const CustomerView* snapshot() const { return view.read(); }
 
-    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-        if (num == qnode->data.getNo()) {
-            flightQueue = &qnode->data;
-            queueNodeToDelete = qnode;
-            break;
-        }
+    size_t stringBytes() const {
+        return stringHeapBytes(name) + stringHeapBytes(surname) + stringHeapBytes(nationality) + stringHeapBytes(address);
     }
+};
 
-    // Handle passengers in queue
-    if (flightQueue && !flightQueue->isEmpty()) {
-        cout << "\nThere are " << flightQueue->getSize() << " passengers in the waiting queue for this flight.\n";
-        cout << "You need to manage the queue before deleting this flight.\n";
-
-        cout << "Options:\n";
-        cout << "1. Manage queue now\n";
-        cout << "2. Cancel deletion\n";
-        cout << "Enter your choice (1-2): ";
+// The timer fires when the entry ages or expires (see WaitlistAging).
+struct QueueNode : TimerNode, MemoryTracked<Memory::MEM_WAITLISTS> {
+    ::Customer Customer;
+    QueueNode* next;
+    QueueNode* prev;
+    Queue* owner;
+    time_t joinTime;
+    bool aged;
+};
 
-        string choice;
-        getline(cin, choice);
+// Queue class
+class Queue {
+private:
+    int queueNo;
+    QueueNode* front;
+    QueueNode* rear;
+    int size;
 
-        while (choice != "1" && choice != "2") {
-            cout << "Invalid choice. Please enter 1 or 2: ";
-            getline(cin, choice);
-        }
+public:
+    Queue(int queueId) : queueNo(queueId), front(nullptr), rear(nullptr), size(0), aged(0) {}
+    ~Queue() { freeNodes(); }
+    // Entries point back at their queue, so queues are built in place in
+    // qlist (emplace_back) and never copied.
+    Queue(const Queue&) = delete;
+    Queue& operator=(const Queue&) = delete;
 
-        if (choice == "1") {
-            Customer customer;
-            customer.manageQueue(num);
-            // Check if queue is now empty
-            if (flightQueue && !flightQueue->isEmpty()) {
-                cout << "There are still " << flightQueue->getSize()
-                    << " passengers in the queue. Cannot delete flight.\n";
-                return;
-            }
-        }
-        else {
-            cout << "Flight deletion cancelled.\n";
-            return;
-        }
-    }
+    // File operations
+    static void loadFromFile();
+    static void saveToFile();
+    static void writeRecords(ostream& file);
+    // Queue operations
+    void enqueue(const Customer& p) { enqueue(p, time(nullptr)); }
+    void enqueue(const Customer& p, time_t joined);
+    void dequeue();
+    void remove(QueueNode* node);
+    void clear();
+    // Stops counting the entry as waitlist demand.
+    void markAged(QueueNode* node);
 
-    // Remove from flight list
-    ListNode<Flight>* flightNodeToDelete = nullptr;
-    for (ListNode<Flight>* fnode = flist.begin(); fnode != flist.end(); fnode = fnode->next) {
-        if (num == fnode->data.getFlightNo()) {
-            flightNodeToDelete = fnode;
-            break;
-        }
-    }
+    // Display functions
+    static void display(int num);
 
-    if (flightNodeToDelete) {
-        flist.erase(flightNodeToDelete);
-        flightBST = FlightBST(); // Rebuild BST without this flight
+    // Utility functions
+    static Queue* forFlight(int num, bool create);
+    Customer oldest() const;
+    bool isEmpty() const { return front == nullptr; }
+    int getPosition(int passport) const;
 
-        // Rebuild flight BST
-        for (ListNode<Flight>* fnode = flist.begin(); fnode != flist.end(); fnode = fnode->next) {
-            flightBST.insert(fnode->data.getFlightNo(), &fnode->data);
-        }
-    }
+    // Getters
+    int getNo() const { return queueNo; }
+    int getSize() const { return size; }
+    int getAgedCount() const { return aged; }
+    QueueNode* getFront() const { return front; }
+    QueueNode* getRear() const { return rear; }
 
-    // Remove from queue list if exists
-    if (queueNodeToDelete) {
-        qlist.erase(queueNodeToDelete);
-    }
+private:
+    // Adds the entry without repricing.
+    void link(const Customer& p, time_t joined);
+    void freeNodes();
+    // Lets the flight reprice for the new waitlist depth; aged entries
+    // no longer count as demand.
+    void depthChanged() { Flight::waitlistChanged(queueNo, size - aged); }
+
+    int aged;
+};
 
-    // Save changes to files
-    Flight::saveToFile();
-    Queue::saveToFile();
+// ---------------------------------------------------------------------------
+// Waitlist aging
+//
+// Each waitlist entry carries a timer on its join time. Once the aging
+// period has passed the entry stays in line but stops counting toward the
+// flight's waitlist demand; once the expiry period has passed it leaves the
+// queue. Either period is off when zero. Deadlines live in a timing wheel of
+// one-minute ticks, so a purge touches only the entries that are due.
+// ---------------------------------------------------------------------------
+
+class WaitlistAging {
+public:
+    static const unsigned TICK_SECONDS = 60;
 
-    cout << "\nFlight " << num << " has been successfully deleted.\n";
+    // Files the node's next deadline; nothing when no policy applies.
+    static void track(QueueNode* node);
+    static void untrack(QueueNode* node) { wheel.cancel(node); }
+    // Ages and removes every entry that is due; returns how many left.
+    static int expire();
 
-    // Update all customers who had this flight booked
-    DoublyLinkedList<Customer*> customers = customerBST.getAllCustomers();
-    for (ListNode<Customer*>* cnode = customers.begin(); cnode != customers.end(); cnode = cnode->next) {
-        Customer* customer = cnode->data;
-        bool modified = false;
+    static bool isAged(time_t joined, time_t now) { return ageSeconds > 0 && now - joined >= ageSeconds; }
+    static bool isExpired(time_t joined, time_t now) { return expireSeconds > 0 && now - joined >= expireSeconds; }
 
-        // Remove this flight from customer's bookings
-        ListNode<int>* fnode = customer->getFlights().begin();
-        while (fnode != nullptr) {
-            ListNode<int>* nextNode = fnode->next; // Store next before possible deletion
-            if (fnode->data == num) {
-                DoublyLinkedList<int> flights = customer->getFlights();
-                flights.erase(fnode);
-                modified = true;
-            }
-            fnode = nextNode;
-        }
+    static size_t pending() { return wheel.size(); }
+    static void setAgeSeconds(long long seconds) { ageSeconds = seconds > 0 ? seconds : 0; }
+    static void setExpireSeconds(long long seconds) { expireSeconds = seconds > 0 ? seconds : 0; }
+    static long long getAgeSeconds() { return ageSeconds; }
+    static long long getExpireSeconds() { return expireSeconds; }
 
-        if (modified) {
-            // Calculate refund (full price without discount as penalty)
-            int refundAmount = flight->getCost();
-            customer->setTotalSpent(customer->getTotalSpent() - refundAmount);
+private:
+    static unsigned long long tickAt(time_t when);
+    static void onExpire(TimerNode* node, void* context);
 
-            cout << "Customer " << customer->getName() << " " << customer->getSurname()
-                << " (Passport: " << customer->getPassport() << ") was booked on this flight.\n";
-            cout << "Refund issued: $" << refundAmount << endl;
-        }
-    }
+    static TimerWheel wheel;
+    static long long ageSeconds, expireSeconds;
+};
 
-    // Save customer changes
-    Customer::saveToFile();
-}
-void Flight::displayInfo() const {
-    cout << left << setw(10) << flightNo
-        << left << setw(15) << from
-        << left << setw(15) << to
-        << left << setw(10) << (to_string(t_leave.hour) + ":" + (t_leave.min < 10 ? "0" : "") + to_string(t_leave.min))
-        << left << setw(10) << (to_string(t_arrive.hour) + ":" + (t_arrive.min < 10 ? "0" : "") + to_string(t_arrive.min))
-        << left << setw(10) << "$" + to_string(cost)
-        << left << setw(15) << plane_type
-        << left << setw(10) << seats
-        << left << setw(10) << booked_seats
-        << left << setw(15) << "B:" + to_string(bookedBusinessSeats) + "/" + to_string(businessSeats)
-        << left << setw(15) << "E:" + to_string(bookedEconomySeats) + "/" + to_string(economySeats)
-        << left << setw(10) << weather
-        << left << setw(10) << dayOfWeek << endl;
-}
+// Defined ahead of qlist so the wheel outlives every queue.
+TimerWheel WaitlistAging::wheel;
+long long WaitlistAging::ageSeconds = 24 * 3600;
+long long WaitlistAging::expireSeconds = 7 * 24 * 3600;
 
-void Flight::displayFlightInfo(int num) {
-    Flight* flight = flightBST.find(num);
-    if (flight) {
-        cout << left << setw(10) << "FLIGHT" << left << setw(15) << "FROM" << left << setw(15) << "TO"
-            << left << setw(10) << "LEAVE" << left << setw(10) << "ARRIVE" << left << setw(10) << "COST"
-            << left << setw(15) << "TYPE" << left << setw(10) << "SEATS" << left << setw(10) << "BOOKED"
-            << left << setw(15) << "BUSINESS" << left << setw(15) << "ECONOMY" << endl;
-        flight->displayInfo();
-        Queue::display(num);
-    }
-    else {
-        cout << "Invalid number of flight was given.\n";
+// Menu class
+class Menu {
+public:
+    static void displayMenu();
+    static void select(int selection);
+    static void exit_prog();
+};
+
+// Input validation functions
+bool checkTime(string time) {
+    if (time.empty()) return false;
+    if (time.length() != 5 || time[2] != ':') return false;
+
+    for (int i = 0; i < time.length(); i++) {
+        if (i == 2) {
+            if (time[i] != ':') return false;
+        }
+        else if (!isdigit(time[i])) {
+            return false;
+        }
     }
-}
 
-void Flight::displaySchedule() {
-    cout << "\n\t\t\t\t FLIGHT SCHEDULE\n\n";
-    cout << left << setw(10) << "FLIGHT" << left << setw(15) << "FROM" << left << setw(15) << "TO"
-        << left << setw(10) << "LEAVE" << left << setw(10) << "ARRIVE" << left << setw(10) << "COST"
-        << left << setw(15) << "TYPE" << left << setw(10) << "SEATS" << left << setw(10) << "BOOKED"
-        << left << setw(15) << "BUSINESS" << left << setw(15) << "ECONOMY"
-        << left << setw(10) << "WEATHER" << left << setw(10) << "DAY" << endl;
+    int hour = stoi(time.substr(0, 2));
+    int min = stoi(time.substr(3, 2));
+    return hour >= 0 && hour < 24 && min >= 0 && min < 60;
+}
 
-    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
-        node->data.displayInfo();
+bool checkNumber(const string& s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!isdigit(c)) return false;
     }
-    cout << endl;
+    return true;
 }
 
-void Flight::resSeat(int num, int val, bool isBusiness) {
-    Flight* flight = flightBST.find(num);
-    if (flight) {
-        if (isBusiness) {
-            flight->bookedBusinessSeats += val;
-        }
-        else {
-            flight->bookedEconomySeats += val;
-        }
-        flight->booked_seats += val;
-        Flight::saveToFile(); // Save changes to file
+// A flight as "1016", or "1016@2026-11-02" for one dated departure (date
+// is left 0 for the plain form).
+bool parseFlightRef(const string& text, int& num, int& date) {
+    size_t at = text.find('@');
+    string number = text.substr(0, at);
+    if (!checkNumber(number) || number.size() > 9) return false;
+    num = stoi(number);
+    date = 0;
+    return at == string::npos || parseDate(text.substr(at + 1), date);
+}
+
+bool checkString(const string& s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!isalpha(c) && c != ' ') return false;
     }
+    return true;
 }
 
-bool Flight::flightExists(int num) {
-    return flightBST.exists(num);
+bool sameTime(Time a, Time b) {
+    return a.hour == b.hour && a.min == b.min;
 }
 
-bool Flight::checkForSeats(int num) {
-    Flight* flight = flightBST.find(num);
-    return flight ? (flight->seats > flight->booked_seats) : false;
+// Global data structures
+DoublyLinkedList<Flight> flist;
+CustomerBST customerBST;
+NameIndex customerNames;  // by surname and first name, kept in step with customerBST
+DoublyLinkedList<Queue> qlist;
+FlightBST flightBST;
+
+// Directory prefix (with trailing separator) for the data files; empty means
+// the working directory.
+string dataDirectory;
+
+string dataFile(const string& name) {
+    return dataDirectory + name;
 }
 
-// Customer member functions implementation
-void Customer::applyDiscount() {
-    string choice;
-    cout << "\nAvailable Discounts:\n";
-    cout << "1. Student (15% discount)\n";
-    cout << "2. Senior Citizen (20% discount)\n";
-    cout << "3. Military (10% discount)\n";
-    cout << "4. Frequent Flyer (25% discount)\n";
-    cout << "5. No discount\n";
-    cout << "Enter your choice (1-5): ";
+// ---------------------------------------------------------------------------
+// File I/O backends
+//
+// Data files are read and written whole. The POSIX backend uses pread/pwrite
+// and fsync; on Linux the io_uring backend batches every chunk of a save
+// (across all files) into one submission through registered buffers, with
+// each file's writes linked in a chain that ends in its fsync. FRS_IO=posix
+// or --io=posix selects the fallback; io_uring is used whenever the kernel
+// allows it. The ring is probed for the opcodes it needs, and a request the
+// kernel or file system rejects as unsupported switches I/O to the POSIX path
+// for good. Either way a save writes "<file>.tmp", syncs it and renames it
+// over the file, so a crash leaves the old contents or the new, never a mix.
+// ---------------------------------------------------------------------------
+
+enum IoBackend {
+    IO_POSIX,
+    IO_URING
+};
 
-    getline(cin, choice);
-    while (choice.empty() || choice[0] < '1' || choice[0] > '5') {
-        cout << "Invalid choice. Please enter a number between 1 and 5: ";
-        getline(cin, choice);
+struct FileWrite {
+    string path;
+    const string* data;
+};
+
+class FileIO {
+public:
+    static bool readFile(const string& path, string& out);
+    static bool writeFile(const string& path, const string& data);
+    // Replaces each file's contents and makes them durable; false if any failed.
+    static bool writeFiles(const FileWrite* files, int count);
+
+    // Returns false (and keeps the current backend) when unavailable.
+    static bool select(IoBackend backend);
+    // The backend in use, which is POSIX once the ring has been given up.
+    static IoBackend backend();
+    static const char* backendName() { return backend() == IO_URING ? "io_uring" : "posix"; }
+
+private:
+    static bool readPosix(const string& path, string& out);
+    static bool writePosix(const FileWrite* files, int count);
+    static string tempPath(const string& path) { return path + ".tmp"; }
+    static int openTemp(const string& path);
+    // Renames the synced temp file over path and syncs its directory.
+    static bool commit(const string& path);
+
+    static IoBackend current;
+};
+
+#if defined(__linux__) && defined(FRS_HAVE_IO_URING)
+
+// Minimal io_uring ring driven through the raw system calls. All callers
+// share one instance, serialized by its mutex.
+class UringRing {
+public:
+    static const unsigned ENTRIES = 32;
+    static const unsigned BUFFERS = 8;
+    static const size_t BUFFER_SIZE = 256 * 1024;
+    static const int MAX_FILES = 8;  // per write() call
+
+    // The shared ring, or nullptr when io_uring cannot be set up.
+    static UringRing* instance() {
+        static UringRing* ring = create();
+        return ring;
+    }
+    // The shared ring while it still works, else nullptr.
+    static UringRing* active() {
+        UringRing* ring = instance();
+        return ring && !ring->unsupported.load(memory_order_relaxed) ? ring : nullptr;
     }
 
-    switch (choice[0]) {
-    case '1': discount = offers::STUDENT; break;
-    case '2': discount = offers::SENIOR; break;
-    case '3': discount = offers::MILITARY; break;
-    case '4': discount = offers::FREQUENT_FLYER; break;
-    case '5': discount = offers::NONE; break;
+    bool write(const FileWrite* files, const int* fds, int count);
+    bool read(int fd, size_t size, string& out);
+
+private:
+    struct Slot {
+        int file;
+        size_t offset;
+        size_t length;
+    };
+
+    UringRing() : ringFd(-1), sqRing(MAP_FAILED), cqRing(MAP_FAILED), sqes(nullptr), buffers(nullptr),
+        fixedBuffers(false), unsupported(false) {
+    }
+
+    static UringRing* create();
+    // Notes a completion that says the request itself is not supported.
+    void checkSupported(long long result) {
+        if (result == -EINVAL || result == -EOPNOTSUPP) unsupported.store(true, memory_order_relaxed);
+    }
+    io_uring_sqe* nextSqe();
+    bool submitAndWait(unsigned count, long long* results);
+
+    int ringFd;
+    void* sqRing;
+    void* cqRing;
+    size_t sqRingSize, cqRingSize, sqesSize;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_sqe* sqes;
+    io_uring_cqe* cqes;
+    unsigned pendingSqes;
+    char* buffers;
+    bool fixedBuffers;
+    atomic<bool> unsupported;
+    mutex lock;
+};
+
+UringRing* UringRing::create() {
+    if (getenv("FRS_NO_URING")) return nullptr;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, ENTRIES, &params));
+    if (fd < 0) return nullptr;
+
+    UringRing* ring = new UringRing();
+    ring->ringFd = fd;
+    ring->pendingSqes = 0;
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        if (ring->cqRingSize > ring->sqRingSize) ring->sqRingSize = ring->cqRingSize;
+        ring->cqRingSize = ring->sqRingSize;
+    }
+
+    ring->sqRing = mmap(nullptr, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        fd, IORING_OFF_SQ_RING);
+    ring->cqRing = singleMap ? ring->sqRing : mmap(nullptr, ring->cqRingSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqeMap = mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+        fd, IORING_OFF_SQES);
+    if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || sqeMap == MAP_FAILED) {
+        close(fd);
+        return nullptr;  // the mappings die with the process
+    }
+
+    char* sq = static_cast<char*>(ring->sqRing);
+    char* cq = static_cast<char*>(ring->cqRing);
+    ring->sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    ring->sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+    // Kernels before 5.6 have no probe and no plain READ/WRITE either
+    const int PROBE_OPS = 64;
+    alignas(io_uring_probe) char probeSpace[sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op)];
+    memset(probeSpace, 0, sizeof(probeSpace));
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeSpace);
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0) {
+        close(fd);
+        return nullptr;
+    }
+    auto supported = [probe](int op) {
+        return op <= probe->last_op && op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    };
+    if (!supported(IORING_OP_READ) || !supported(IORING_OP_WRITE) || !supported(IORING_OP_FSYNC)) {
+        close(fd);
+        return nullptr;
     }
-}
 
-float Customer::getDiscountRate() const {
-    switch (discount) {
-    case offers::STUDENT: return 0.15f;
-    case offers::SENIOR: return 0.20f;
-    case offers::MILITARY: return 0.10f;
-    case offers::FREQUENT_FLYER: return 0.25f;
-    case offers::NONE: return 0.0f;
+    // Registered buffers save the per-request page pinning; a low
+    // RLIMIT_MEMLOCK makes registration fail, and plain buffers still work.
+    ring->buffers = static_cast<char*>(mmap(nullptr, BUFFERS * BUFFER_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (ring->buffers == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+    iovec vectors[BUFFERS];
+    for (unsigned i = 0; i < BUFFERS; i++) {
+        vectors[i].iov_base = ring->buffers + i * BUFFER_SIZE;
+        vectors[i].iov_len = BUFFER_SIZE;
     }
-    return 0.0f;
+    ring->fixedBuffers = supported(IORING_OP_READ_FIXED) && supported(IORING_OP_WRITE_FIXED)
+        && syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, vectors, BUFFERS) == 0;
+    return ring;
 }
 
-void Customer::inputCustomeralInfo() {
-    string temp;
+io_uring_sqe* UringRing::nextSqe() {
+    unsigned tail = *sqTail + pendingSqes;
+    unsigned index = tail & *sqMask;
+    io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqArray[index] = index;
+    pendingSqes++;
+    return sqe;
+}
 
-    // Name
-    do {
-        cout << "Name: ";
-        getline(cin, this->name);
-        if (this->name.length() > 20 || !checkString(this->name)) {
-            cout << "Please insert a valid Name (letters only, max 20 chars)!\n";
+// Submits the queued entries and collects one completion per entry; results
+// are stored by each entry's user_data index.
+bool UringRing::submitAndWait(unsigned count, long long* results) {
+    __atomic_store_n(sqTail, *sqTail + pendingSqes, __ATOMIC_RELEASE);
+    unsigned toSubmit = pendingSqes;
+    pendingSqes = 0;
+
+    unsigned reaped = 0;
+    bool failed = false;
+    while (reaped < count) {
+        long ret = syscall(__NR_io_uring_enter, ringFd, toSubmit, count - reaped, IORING_ENTER_GETEVENTS,
+            nullptr, 0);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            if (failed) return false;  // cannot even wait; give up on the stragglers
+            // Withdraw what the kernel has not taken and wait for the rest,
+            // so none of this batch completes into the next one
+            failed = true;
+            __atomic_store_n(sqTail, __atomic_load_n(sqHead, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+            count -= toSubmit;
+            toSubmit = 0;
             continue;
         }
-        break;
-    } while (true);
-
-    // Surname
-    do {
-        cout << "Surname: ";
-        getline(cin, this->surname);
-        if (this->surname.length() > 20 || !checkString(this->surname)) {
-            cout << "Please insert a valid Surname (letters only, max 20 chars)!\n";
-            continue;
+        toSubmit -= static_cast<unsigned>(ret) < toSubmit ? static_cast<unsigned>(ret) : toSubmit;
+
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            results[cqe.user_data] = cqe.res;
+            head++;
+            reaped++;
         }
-        break;
-    } while (true);
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+    return !failed;
+}
 
-    // Passport number
-    do {
-        cout << "Passport number: ";
-        getline(cin, temp);
-        if (!checkNumber(temp) || !Customer::uniquePass(stoi(temp))) {
-            cout << "Please insert a valid and unique passport number!\n";
-            continue;
+bool UringRing::write(const FileWrite* files, const int* fds, int count) {
+    lock_guard<mutex> guard(lock);
+    Slot slots[BUFFERS];
+    long long results[2 * BUFFERS];
+    int fsyncFile[2 * BUFFERS];
+    bool patched[MAX_FILES] = {};
+    bool ok = true;
+
+    int file = 0;
+    size_t offset = 0;
+    while (file < count) {
+        // One round: fill the buffers with the next chunks of every file.
+        // A file's writes link to each other and to its fsync, so the fsync
+        // starts only after all of them.
+        unsigned used = 0, entries = 0;
+        io_uring_sqe* lastWrite = nullptr;
+        while (file < count && used < BUFFERS) {
+            const string& data = *files[file].data;
+            size_t length = data.size() - offset;
+            if (length > BUFFER_SIZE) length = BUFFER_SIZE;
+            bool last = offset + length == data.size();
+
+            if (length > 0) {
+                char* buffer = buffers + used * BUFFER_SIZE;
+                memcpy(buffer, data.data() + offset, length);
+                io_uring_sqe* sqe = nextSqe();
+                sqe->opcode = fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+                sqe->fd = fds[file];
+                sqe->off = offset;
+                sqe->addr = reinterpret_cast<unsigned long long>(buffer);
+                sqe->len = static_cast<unsigned>(length);
+                sqe->buf_index = static_cast<unsigned short>(used);
+                sqe->user_data = entries;
+                sqe->flags |= IOSQE_IO_LINK;
+                lastWrite = sqe;
+                slots[used] = Slot{ file, offset, length };
+                fsyncFile[entries] = -1;
+                entries++;
+                used++;
+            }
+            if (last) {
+                io_uring_sqe* sqe = nextSqe();
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->fd = fds[file];
+                sqe->user_data = entries;
+                fsyncFile[entries] = file;
+                entries++;
+                file++;
+                offset = 0;
+                lastWrite = nullptr;
+            }
+            else {
+                offset += length;
+            }
         }
-        this->passportNo = stoi(temp);
-        break;
-    } while (true);
-
-    // Nationality
-    do {
-        cout << "Nationality: ";
-        getline(cin, this->nationality);
-        if (this->nationality.length() > 20 || !checkString(this->nationality)) {
-            cout << "Please insert a valid Nationality (letters only, max 20 chars)!\n";
-            continue;
+        // The file goes on next round; this round's writes complete first
+        if (lastWrite) lastWrite->flags &= ~IOSQE_IO_LINK;
+
+        if (!submitAndWait(entries, results)) return false;
+
+        // Finish short and cancelled writes by hand; a short write cancels
+        // the rest of its chain, so the file is synced again here
+        unsigned slot = 0;
+        for (unsigned e = 0; e < entries; e++) {
+            checkSupported(results[e]);
+            if (fsyncFile[e] >= 0) {
+                bool synced = results[e] >= 0 && !patched[fsyncFile[e]];
+                if (!synced && fsync(fds[fsyncFile[e]]) != 0) ok = false;
+                continue;
+            }
+            const Slot& s = slots[slot];
+            long long written = results[e] == -ECANCELED ? 0 : results[e];
+            if (written < 0) {
+                ok = false;
+            }
+            else if (static_cast<size_t>(written) < s.length) {
+                const string& data = *files[s.file].data;
+                size_t done = static_cast<size_t>(written);
+                patched[s.file] = true;
+                while (done < s.length) {
+                    ssize_t n = pwrite(fds[s.file], data.data() + s.offset + done, s.length - done,
+                        static_cast<off_t>(s.offset + done));
+                    if (n <= 0) { ok = false; break; }
+                    done += static_cast<size_t>(n);
+                }
+            }
+            slot++;
         }
-        break;
-    } while (true);
+    }
+    return ok;
+}
 
-    // Address
-    do {
-        cout << "Address: ";
-        getline(cin, this->address);
-        if (this->address.empty()) {
-            cout << "Address cannot be empty!\n";
-            continue;
+bool UringRing::read(int fd, size_t size, string& out) {
+    lock_guard<mutex> guard(lock);
+    out.resize(size);
+    long long results[BUFFERS];
+    size_t offset = 0;
+    while (offset < size) {
+        unsigned used = 0;
+        size_t roundStart = offset;
+        while (offset < size && used < BUFFERS) {
+            size_t length = size - offset < BUFFER_SIZE ? size - offset : BUFFER_SIZE;
+            io_uring_sqe* sqe = nextSqe();
+            sqe->opcode = fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+            sqe->fd = fd;
+            sqe->off = offset;
+            sqe->addr = reinterpret_cast<unsigned long long>(buffers + used * BUFFER_SIZE);
+            sqe->len = static_cast<unsigned>(length);
+            sqe->buf_index = static_cast<unsigned short>(used);
+            sqe->user_data = used;
+            offset += length;
+            used++;
         }
-        break;
-    } while (true);
-
-    // Telephone
-    do {
-        cout << "Telephone: ";
-        getline(cin, temp);
-        if (!checkNumber(temp)) {
-            cout << "Please insert a valid telephone number!\n";
-            continue;
+        if (!submitAndWait(used, results)) return false;
+
+        size_t chunkOffset = roundStart;
+        for (unsigned i = 0; i < used; i++) {
+            size_t length = size - chunkOffset < BUFFER_SIZE ? size - chunkOffset : BUFFER_SIZE;
+            if (results[i] < 0) {
+                checkSupported(results[i]);
+                return false;
+            }
+            size_t got = static_cast<size_t>(results[i]);
+            memcpy(&out[chunkOffset], buffers + i * BUFFER_SIZE, got);
+            while (got < length) {
+                ssize_t n = pread(fd, &out[chunkOffset + got], length - got, static_cast<off_t>(chunkOffset + got));
+                if (n <= 0) return false;
+                got += static_cast<size_t>(n);
+            }
+            chunkOffset += length;
         }
-        this->tel = stoi(temp);
-        break;
-    } while (true);
+    }
+    return true;
+}
 
-    // Apply discount
-    applyDiscount();
+IoBackend FileIO::current = IO_URING;
+
+#else
+
+IoBackend FileIO::current = IO_POSIX;
+
+#endif
+
+bool FileIO::select(IoBackend backend) {
+#if defined(__linux__) && defined(FRS_HAVE_IO_URING)
+    if (backend == IO_URING && !UringRing::active()) return false;
+    current = backend;
+    return true;
+#else
+    return backend == IO_POSIX;
+#endif
+}
+
+IoBackend FileIO::backend() {
+#if defined(__linux__) && defined(FRS_HAVE_IO_URING)
+    if (current == IO_URING && !UringRing::active()) return IO_POSIX;
+#endif
+    return current;
+}
+
+bool FileIO::writeFile(const string& path, const string& data) {
+    FileWrite file = { path, &data };
+    return writeFiles(&file, 1);
+}
+
+#ifdef _WIN32
+
+bool FileIO::readPosix(const string& path, string& out) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) return false;
+    ostringstream contents;
+    contents << file.rdbuf();
+    out = contents.str();
+    return true;
+}
+
+bool FileIO::writePosix(const FileWrite* files, int count) {
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+        ofstream file(files[i].path, ios::binary);
+        file.write(files[i].data->data(), static_cast<streamsize>(files[i].data->size()));
+        if (!file.good()) ok = false;
+    }
+    return ok;
+}
+
+bool FileIO::readFile(const string& path, string& out) {
+    return readPosix(path, out);
+}
+
+bool FileIO::writeFiles(const FileWrite* files, int count) {
+    return writePosix(files, count);
+}
+
+#else
+
+bool FileIO::readPosix(const string& path, string& out) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) { close(fd); return false; }
+
+    size_t size = static_cast<size_t>(info.st_size);
+    out.resize(size);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, &out[done], size - done, static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    out.resize(done);
+    close(fd);
+    return true;
+}
+
+int FileIO::openTemp(const string& path) {
+    return open(tempPath(path).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
 }
 
-void Customer::copyFromExisting(int passport) {
-    Customer* existing = customerBST.find(passport);
-    if (existing) {
-        this->name = existing->name;
-        this->surname = existing->surname;
-        this->passportNo = existing->passportNo;
-        this->nationality = existing->nationality;
-        this->address = existing->address;
-        this->tel = existing->tel;
-        this->discount = existing->discount;
-        this->totalSpent = existing->totalSpent;
+bool FileIO::commit(const string& path) {
+    if (rename(tempPath(path).c_str(), path.c_str()) != 0) {
+        unlink(tempPath(path).c_str());
+        return false;
+    }
+    size_t slash = path.find_last_of('/');
+    string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
 
-        // Copy flights
-        for (ListNode<int>* fnode = existing->flights.begin(); fnode != existing->flights.end(); fnode = fnode->next) {
-            this->flights.push_back(fnode->data);
+bool FileIO::writePosix(const FileWrite* files, int count) {
+    bool ok = true;
+    for (int i = 0; i < count; i++) {
+        int fd = openTemp(files[i].path);
+        if (fd < 0) { ok = false; continue; }
+        const string& data = *files[i].data;
+        size_t done = 0;
+        bool written = true;
+        while (done < data.size()) {
+            ssize_t n = pwrite(fd, data.data() + done, data.size() - done, static_cast<off_t>(done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) { written = false; break; }
+            done += static_cast<size_t>(n);
         }
+        if (fsync(fd) != 0) written = false;
+        close(fd);
+        if (written) written = commit(files[i].path);
+        else unlink(tempPath(files[i].path).c_str());
+        ok = ok && written;
+    }
+    return ok;
+}
 
-        // Remove from BST
-        customerBST.erase(passport);
-        delete existing;
+bool FileIO::readFile(const string& path, string& out) {
+#if defined(__linux__) && defined(FRS_HAVE_IO_URING)
+    UringRing* ring = current == IO_URING ? UringRing::active() : nullptr;
+    if (ring) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0 && ring->read(fd, static_cast<size_t>(info.st_size), out);
+        close(fd);
+        // A ring that turned out not to support the read leaves it to pread
+        if (ok || UringRing::active()) return ok;
     }
+#endif
+    return readPosix(path, out);
 }
 
-//void Customer::book() {
-//    if (flist.empty()) {
-//        cout << "There are no available flights at the moment.\n";
-//        return;
-//    }
-//
-//    cin.clear();
-//    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+bool FileIO::writeFiles(const FileWrite* files, int count) {
+#if defined(__linux__) && defined(FRS_HAVE_IO_URING)
+    UringRing* ring = current == IO_URING ? UringRing::active() : nullptr;
+    if (ring) {
+        int fds[UringRing::MAX_FILES];
+        bool ok = true;
+        for (int start = 0; start < count; start += UringRing::MAX_FILES) {
+            int batch = count - start < UringRing::MAX_FILES ? count - start : UringRing::MAX_FILES;
+            int opened = 0;
+            for (; opened < batch; opened++) {
+                fds[opened] = openTemp(files[start + opened].path);
+                if (fds[opened] < 0) break;
+            }
+            bool written = opened == batch && ring->write(files + start, fds, batch);
+            for (int i = 0; i < opened; i++) close(fds[i]);
+            // A failed batch leaves every original file as it was
+            for (int i = 0; i < opened; i++) {
+                if (!written) unlink(tempPath(files[start + i].path).c_str());
+                else if (!commit(files[start + i].path)) ok = false;
+            }
+            // The ring rejected its requests: this batch and the rest go through pwrite
+            if (!written && !UringRing::active()) {
+                return writePosix(files + start, count - start) && ok;
+            }
+            if (!written) ok = false;
+        }
+        return ok;
+    }
+#endif
+    return writePosix(files, count);
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Dynamic pricing
 //
-//    string choice;
-//    cout << "Insert y (yes) for a new client or n (no) for an existing client: ";
-//    getline(cin, choice);
+// A cabin's fare multiplier follows its load factor along a curve of
+// (load %, multiplier in basis points) points, interpolated linearly, and
+// rises with each waiting passenger up to a cap. A dated departure's quote
+// is then scaled by a curve over the days left before it leaves. Curves
+// come from pricing.txt in the data directory:
 //
-//    if (choice == "y" || choice == "Y") {
-//        cout << "Please provide your personal information.\n";
-//        inputCustomeralInfo();
-//    }
-//    else {
-//        string temp;
-//        cout << "Please provide your passport number: ";
-//        getline(cin, temp);
+//   economy 0:10000 60:11500 85:14000 95:18000
+//   business 0:20000 70:23000 90:28000
+//   waitlist 250 2500        (bp per waiting passenger, cap)
+//   advance 0:13000 7:11500 21:10000 60:9000   (days out : bp)
 //
-//        while (!checkNumber(temp)) {
-//            cout << "Please insert a valid passport number!\n";
-//            getline(cin, temp);
-//        }
-//
-//        int passport = stoi(temp);
-//        if (!Customer::uniquePass(passport)) {
-//            copyFromExisting(passport);
-//        }
-//        else {
-//            cout << "Wrong passport number!\n";
-//            return;
-//        }
-//    }
-//
-//    Flight::displaySchedule();
-//
-//    string temp;
-//    int num;
-//    do {
-//        cout << "\n\nEnter the number of the flight you're interested in: ";
-//        getline(cin, temp);
-//
-//        if (!checkNumber(temp) || !Flight::flightExists(stoi(temp))) {
-//            cout << "Please insert a valid Flight No!\n";
-//            continue;
-//        }
-//        num = stoi(temp);
-//        break;
-//    } while (true);
-//
-//    Flight* flight = flightBST.find(num);
-//    if (!flight) {
-//        cout << "Flight not found!\n";
-//        return;
-//    }
-//
-//    // Select class
-//    string seatClass;
-//    bool businessClass = false;
-//    int availableSeats = 0;
-//    int priceMultiplier = 1;
-//
-//    do {
-//        cout << "\nSelect class:\n";
-//        cout << "1. Business Class (2x price, " << flight->getAvailableBusinessSeats() << " available)\n";
-//        cout << "2. Economy Class (" << flight->getAvailableEconomySeats() << " available)\n";
-//        cout << "Enter your choice (1-2): ";
-//        getline(cin, seatClass);
-//
-//        if (seatClass == "1") {
-//            businessClass = true;
-//            availableSeats = flight->getAvailableBusinessSeats();
-//            priceMultiplier = 2;
-//            if (availableSeats <= 0) {
-//                cout << "No available business class seats!\n";
-//                continue;
-//            }
-//        }
-//        else if (seatClass == "2") {
-//            businessClass = false;
-//            availableSeats = flight->getAvailableEconomySeats();
-//            priceMultiplier = 1;
-//            if (availableSeats <= 0) {
-//                cout << "No available economy class seats!\n";
-//                continue;
-//            }
-//        }
-//        else {
-//            cout << "Invalid choice!\n";
-//            continue;
-//        }
-//        break;
-//    } while (true);
-//
-//    if (availableSeats > 0) {
-//        float discountRate = getDiscountRate();
-//        int originalPrice = flight->getCost() * priceMultiplier;
-//        int discountedPrice = originalPrice * (1 - discountRate);
-//
-//        cout << "\nFlight Details:\n";
-//        cout << "From: " << flight->getDeparture() << " To: " << flight->getDestination() << "\n";
-//        cout << "Class: " << (businessClass ? "Business" : "Economy") << "\n";
-//        cout << "Departure: " << flight->getLeavingTime().hour << ":"
-//            << (flight->getLeavingTime().min < 10 ? "0" : "") << flight->getLeavingTime().min << "\n";
-//        cout << "Original Price: $" << originalPrice << "\n";
-//
-//        if (discountRate > 0) {
-//            cout << "Discount Applied: " << (discountRate * 100) << "%\n";
-//            cout << "Discounted Price: $" << discountedPrice << "\n";
-//        }
-//
-//        cout << "\nConfirm booking? (y/n): ";
-//        getline(cin, choice);
-//
-//        if (choice == "y" || choice == "Y") {
-//            flights.push_back(num);
-//
-//            // Update the correct seat count
-//            Flight::resSeat(num, 1, businessClass);
-//
-//            totalSpent += discountedPrice;
-//
-//            // Add to BST
-//            Customer* newCustomer = new Customer(*this);
-//            customerBST.insert(newCustomer->getPassport(), newCustomer);
-//
-//            // Save to file
-//            Customer::saveToFile();
-//            Flight::saveToFile();
-//
-//            cout << "Your " << (businessClass ? "Business" : "Economy")
-//                << " class flight with No: " << num << " was successfully booked.\n";
-//            cout << "Total amount paid: $" << discountedPrice << "\n";
-//        }
-//        else {
-//            cout << "Booking cancelled.\n";
-//        }
-//    }
-//    else {
-//        cout << "\nThis flight class is fully booked. You can be added to the waiting queue.\n";
-//        cout << "Would you like to join the waiting queue? (y/n): ";
-//        getline(cin, choice);
-//
-//        if (choice == "y" || choice == "Y") {
-//            // Find or create queue for this flight
-//            Queue* flightQueue = nullptr;
-//            for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-//                if (num == qnode->data.getNo()) {
-//                    flightQueue = &qnode->data;
-//                    break;
-//                }
-//            }
-//
-//            if (!flightQueue) {
-//                // Create new queue if it doesn't exist
-//                Queue newQueue(num);
-//                qlist.push_back(newQueue);
-//                flightQueue = &qlist.getTail()->data;
-//            }
-//
-//            // Add customer to queue
-//            flightQueue->enqueue(*this);
-//            int queuePosition = flightQueue->getSize();
-//
-//            // Add to BST
-//            Customer* newCustomer = new Customer(*this);
-//            customerBST.insert(newCustomer->getPassport(), newCustomer);
-//
-//            // Save to file
-//            Customer::saveToFile();
-//            Queue::saveToFile();
-//
-//            cout << "\nYou have been added to the waiting queue for Flight " << num << ".\n";
-//            cout << "Your position in queue: " << queuePosition << endl;
-//            cout << "You will be automatically notified if a seat becomes available.\n";
+// Without that file the curves are flat (economy 1x, business 2x, every
+// day 1x), which gives the fixed fares. The days-out factor is kept as a
+// table per day, so a dated quote stays two lookups.
+// ---------------------------------------------------------------------------
+
+class PricingEngine {
+public:
+    static const int MAX_POINTS = 8;
+
+    static const int MAX_ADVANCE_DAYS = 366;  // the last day's factor covers the rest
+
+    struct Curve {
+        int points;
+        int at[MAX_POINTS];  // load % or, for the advance curve, days out
+        int multiplierBp[MAX_POINTS];
+    };
+
+    // Reads pricing.txt-style curves; on a missing or bad file the current
+    // curves are kept and false is returned.
+    static bool loadConfig(const string& path);
+    static void useFlatCurves();
+    // Example revenue-managed curves, used by the pricing benchmark.
+    static void useDemandCurves();
+
+    static long long multiplierBp(bool businessClass, int booked, int seats, int waiting);
+    static Money price(int cost, bool businessClass, offers discount, int booked, int seats, int waiting);
+    // Scales a cabin fare for a departure daysOut days away (past dates as 0).
+    static Money priceForDeparture(Money fare, int daysOut);
+
+private:
+    static bool parseCurve(istringstream& in, Curve& curve);
+    static long long interpolate(const Curve& curve, int x);
+    static void buildAdvanceTable(const Curve& curve);
+
+    static Curve curves[2];
+    static int waitlistStepBp, waitlistCapBp;
+    // Days-out multiplier minus 1x, so the zeroed table is the flat curve.
+    static int advanceExtraBp[MAX_ADVANCE_DAYS + 1];
+};
+
+PricingEngine::Curve PricingEngine::curves[2] = { { 1, { 0 }, { 10000 } }, { 1, { 0 }, { 20000 } } };
+int PricingEngine::waitlistStepBp = 0;
+int PricingEngine::waitlistCapBp = 0;
+int PricingEngine::advanceExtraBp[PricingEngine::MAX_ADVANCE_DAYS + 1] = {};
+
+void PricingEngine::useFlatCurves() {
+    curves[0] = Curve{ 1, { 0 }, { 10000 } };
+    curves[1] = Curve{ 1, { 0 }, { 20000 } };
+    waitlistStepBp = waitlistCapBp = 0;
+    buildAdvanceTable(Curve{ 1, { 0 }, { 10000 } });
+}
+
+void PricingEngine::useDemandCurves() {
+    curves[0] = Curve{ 4, { 0, 60, 85, 95 }, { 10000, 11500, 14000, 18000 } };
+    curves[1] = Curve{ 3, { 0, 70, 90 }, { 20000, 23000, 28000 } };
+    waitlistStepBp = 250;
+    waitlistCapBp = 2500;
+    buildAdvanceTable(Curve{ 4, { 0, 7, 21, 60 }, { 13000, 11500, 10000, 9000 } });
+}
+
+void PricingEngine::buildAdvanceTable(const Curve& curve) {
+    for (int days = 0; days <= MAX_ADVANCE_DAYS; days++) {
+        advanceExtraBp[days] = static_cast<int>(interpolate(curve, days)) - 10000;
+    }
+}
+
+bool PricingEngine::parseCurve(istringstream& in, Curve& curve) {
+    curve.points = 0;
+    string point;
+    while (in >> point) {
+        size_t colon = point.find(':');
+        if (colon == string::npos || curve.points == MAX_POINTS) return false;
+        string load = point.substr(0, colon), multiplier = point.substr(colon + 1);
+        if (!checkNumber(load) || !checkNumber(multiplier)) return false;
+        int x = stoi(load);
+        if (curve.points > 0 && x <= curve.at[curve.points - 1]) return false;
+        curve.at[curve.points] = x;
+        curve.multiplierBp[curve.points] = stoi(multiplier);
+        curve.points++;
+    }
+    return curve.points > 0;
+}
+
+bool PricingEngine::loadConfig(const string& path) {
+    string contents;
+    if (!FileIO::readFile(path, contents)) return false;
+
+    Curve parsed[2] = { curves[0], curves[1] };
+    Curve advance = { 0, { 0 }, { 0 } };
+    int step = waitlistStepBp, cap = waitlistCapBp;
+    istringstream file(contents);
+    string line;
+    while (getline(file, line)) {
+        size_t hash = line.find('#');
+        if (hash != string::npos) line.erase(hash);
+        istringstream fields(line);
+        string key;
+        if (!(fields >> key)) continue;
+
+        bool ok;
+        if (key == "economy") ok = parseCurve(fields, parsed[0]);
+        else if (key == "business") ok = parseCurve(fields, parsed[1]);
+        else if (key == "waitlist") ok = static_cast<bool>(fields >> step >> cap) && step >= 0 && cap >= 0;
+        else if (key == "advance") ok = parseCurve(fields, advance);
+        else ok = false;
+        if (!ok) {
+            cerr << "Error: invalid pricing line '" << line << "'; keeping the current fares." << endl;
+            return false;
+        }
+    }
+
+    curves[0] = parsed[0];
+    curves[1] = parsed[1];
+    waitlistStepBp = step;
+    waitlistCapBp = cap;
+    if (advance.points) buildAdvanceTable(advance);
+    return true;
+}
+
+long long PricingEngine::interpolate(const Curve& curve, int x) {
+    if (x <= curve.at[0]) return curve.multiplierBp[0];
+    for (int i = 1; i < curve.points; i++) {
+        if (x <= curve.at[i]) {
+            int span = curve.at[i] - curve.at[i - 1];
+            int rise = curve.multiplierBp[i] - curve.multiplierBp[i - 1];
+            return curve.multiplierBp[i - 1] + static_cast<long long>(rise) * (x - curve.at[i - 1]) / span;
+        }
+    }
+    return curve.multiplierBp[curve.points - 1];
+}
+
+long long PricingEngine::multiplierBp(bool businessClass, int booked, int seats, int waiting) {
+    int load = seats > 0 ? booked * 100 / seats : 100;
+    long long multiplier = interpolate(curves[businessClass], load);
+
+    long long surcharge = static_cast<long long>(waiting) * waitlistStepBp;
+    if (surcharge > waitlistCapBp) surcharge = waitlistCapBp;
+    return multiplier * (10000 + surcharge) / 10000;
+}
+
+Money PricingEngine::price(int cost, bool businessClass, offers discount, int booked, int seats, int waiting) {
+    long long base = static_cast<long long>(cost) * 100 * multiplierBp(businessClass, booked, seats, waiting);
+    long long keep = 10000 - OFFER_DISCOUNT_BP[static_cast<int>(discount)];
+    return Money::fromCents((base * keep + 50000000) / 100000000);
+}
+
+Money PricingEngine::priceForDeparture(Money fare, int daysOut) {
+    int days = daysOut < 0 ? 0 : daysOut > MAX_ADVANCE_DAYS ? MAX_ADVANCE_DAYS : daysOut;
+    return Money::fromCents((fare.getCents() * (10000 + advanceExtraBp[days]) + 5000) / 10000);
+}
+
+// ---------------------------------------------------------------------------
+// Record schemas
 //
-//            // Check if we can immediately allocate a seat (in case of race condition)
-//            if (flight->getAvailableSeats() > 0) {
-//                cout << "\nSeat became available! Processing your booking...\n";
-//                manageQueue(num);
-//            }
-//        }
-//        else {
-//            cout << "You were not added to the waiting queue.\n";
-//        }
-//    }
-//}
-void Customer::book() {
-    if (flist.empty()) {
-        cout << "There are no available flights at the moment.\n";
+// Each data file's line layout is declared once, as its fields in file
+// order. RecordSchema expands that list at compile time into straight-line
+// readers and writers for the CSV text and for a compact binary form, so
+// loading and saving cannot drift apart and nothing dispatches on a field
+// at run time.
+// ---------------------------------------------------------------------------
+
+// One field's text, between separators.
+struct FieldText {
+    const char* begin;
+    const char* end;
+};
+
+// Binary records are raw host-order values; text is length-prefixed.
+struct BinaryReader {
+    const char* p;
+    const char* end;
+
+    template <typename T>
+    bool raw(T& value) {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+};
+
+template <typename T>
+void appendRaw(string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void appendInt(string& out, long long value) {
+    char digits[20];
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+        : static_cast<unsigned long long>(value);
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) out += '-';
+    while (n) out += digits[--n];
+}
+
+// Hands buffered records to the stream in large writes.
+void flushRecords(ostream& file, string& buffer, bool last) {
+    if (buffer.size() < 65536 && !last) return;
+    file.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+// Unsigned decimal of up to maxDigits digits, as checkNumber accepts.
+bool parseDigits(FieldText text, int maxDigits, long long& value) {
+    if (text.begin == text.end || text.end - text.begin > maxDigits) return false;
+    long long n = 0;
+    for (const char* c = text.begin; c != text.end; c++) {
+        if (*c < '0' || *c > '9') return false;
+        n = n * 10 + (*c - '0');
+    }
+    value = n;
+    return true;
+}
+
+// Value codecs. parse() gets the load time for fields that default to it.
+struct IntCodec {
+    static bool parse(FieldText text, int& value, time_t) {
+        long long n;
+        if (!parseDigits(text, 10, n) || n > numeric_limits<int>::max()) return false;
+        value = static_cast<int>(n);
+        return true;
+    }
+    static void write(string& out, int value) { appendInt(out, value); }
+    static void writeBinary(string& out, int value) { appendRaw(out, value); }
+    static bool readBinary(BinaryReader& in, int& value) { return in.raw(value); }
+};
+
+struct TextCodec {
+    static bool parse(FieldText text, string& value, time_t) {
+        value.assign(text.begin, text.end);
+        return true;
+    }
+    static void write(string& out, const string& value) { out += value; }
+    static void writeBinary(string& out, const string& value) {
+        appendRaw(out, static_cast<unsigned>(value.size()));
+        out += value;
+    }
+    static bool readBinary(BinaryReader& in, string& value) {
+        unsigned size;
+        if (!in.raw(size) || static_cast<size_t>(in.end - in.p) < size) return false;
+        value.assign(in.p, size);
+        in.p += size;
+        return true;
+    }
+};
+
+// "HH:MM", as checkTime accepts.
+struct TimeCodec {
+    static bool parse(FieldText text, Time& value, time_t) {
+        const char* c = text.begin;
+        if (text.end - c != 5 || c[2] != ':') return false;
+        for (int i = 0; i < 5; i++) {
+            if (i != 2 && (c[i] < '0' || c[i] > '9')) return false;
+        }
+        value.hour = (c[0] - '0') * 10 + (c[1] - '0');
+        value.min = (c[3] - '0') * 10 + (c[4] - '0');
+        return value.hour < 24 && value.min < 60;
+    }
+    static void write(string& out, Time value) {
+        out += static_cast<char>('0' + value.hour / 10);
+        out += static_cast<char>('0' + value.hour % 10);
+        out += ':';
+        out += static_cast<char>('0' + value.min / 10);
+        out += static_cast<char>('0' + value.min % 10);
+    }
+    static void writeBinary(string& out, Time value) {
+        appendRaw(out, static_cast<unsigned char>(value.hour));
+        appendRaw(out, static_cast<unsigned char>(value.min));
+    }
+    static bool readBinary(BinaryReader& in, Time& value) {
+        unsigned char hour, min;
+        if (!in.raw(hour) || !in.raw(min)) return false;
+        value.hour = hour;
+        value.min = min;
+        return true;
+    }
+};
+
+struct MoneyCodec {
+    static bool parse(FieldText text, Money& value, time_t) {
+        return Money::parse(string(text.begin, text.end), value);
+    }
+    static void write(string& out, Money value) { out += value.str(); }
+    static void writeBinary(string& out, Money value) { appendRaw(out, value.getCents()); }
+    static bool readBinary(BinaryReader& in, Money& value) {
+        long long cents;
+        if (!in.raw(cents)) return false;
+        value = Money::fromCents(cents);
+        return true;
+    }
+};
+
+struct OfferCodec {
+    static bool parse(FieldText text, offers& value, time_t now) {
+        int n;
+        if (!IntCodec::parse(text, n, now) || !validOffer(n)) return false;
+        value = static_cast<offers>(n);
+        return true;
+    }
+    static void write(string& out, offers value) { appendInt(out, static_cast<int>(value)); }
+    static void writeBinary(string& out, offers value) { appendRaw(out, static_cast<int>(value)); }
+    static bool readBinary(BinaryReader& in, offers& value) {
+        int n;
+        if (!in.raw(n) || !validOffer(n)) return false;
+        value = static_cast<offers>(n);
+        return true;
+    }
+};
+
+// A timestamp that older files leave out; it then reads as the load time.
+struct JoinTimeCodec {
+    static bool parse(FieldText text, time_t& value, time_t now) {
+        long long n;
+        value = parseDigits(text, 18, n) ? static_cast<time_t>(n) : now;
+        return true;
+    }
+    static void write(string& out, time_t value) { appendInt(out, static_cast<long long>(value)); }
+    static void writeBinary(string& out, time_t value) { appendRaw(out, static_cast<long long>(value)); }
+    static bool readBinary(BinaryReader& in, time_t& value) {
+        long long n;
+        if (!in.raw(n)) return false;
+        value = static_cast<time_t>(n);
+        return true;
+    }
+};
+
+template <typename M>
+struct MemberOf;
+
+template <typename R, typename T>
+struct MemberOf<T R::*> {
+    typedef R Record;
+};
+
+// A data member read and written with Codec.
+template <auto Member, typename Codec>
+struct Field {
+    typedef typename MemberOf<decltype(Member)>::Record Record;
+
+    static bool parse(FieldText text, Record& r, time_t now) { return Codec::parse(text, r.*Member, now); }
+    static void write(string& out, const Record& r) { Codec::write(out, r.*Member); }
+    static void writeBinary(string& out, const Record& r) { Codec::writeBinary(out, r.*Member); }
+    static bool readBinary(BinaryReader& in, Record& r) { return Codec::readBinary(in, r.*Member); }
+};
+
+template <char Separator, typename... Fields>
+struct RecordSchema {
+    // Fields past the end of the text read as empty. The last field runs to
+    // the end of the line, separators included, as a day template such as
+    // "Mon,Wed,Fri" does.
+    template <typename Record>
+    static bool parse(const char* begin, const char* end, Record& r, time_t now) {
+        size_t index = 0;
+        return (Fields::parse(++index == sizeof...(Fields) ? FieldText{ begin, end } : nextField(begin, end), r, now)
+            && ...);
+    }
+
+    // A trailing empty field is left off together with its separator.
+    template <typename Record>
+    static void write(string& out, const Record& r) {
+        size_t mark = string::npos;
+        ((mark == string::npos ? (void)(mark = 0) : (void)(mark = out.size(), out += Separator),
+            Fields::write(out, r)), ...);
+        if (mark && out.size() == mark + 1) out.resize(mark);
+    }
+
+    template <typename Record>
+    static void writeBinary(string& out, const Record& r) {
+        (Fields::writeBinary(out, r), ...);
+    }
+
+    template <typename Record>
+    static bool readBinary(BinaryReader& in, Record& r) {
+        return (Fields::readBinary(in, r) && ...);
+    }
+
+private:
+    static FieldText nextField(const char*& p, const char* end) {
+        FieldText text = { p, end };
+        if (const void* stop = memchr(p, Separator, end - p)) text.end = static_cast<const char*>(stop);
+        p = text.end == end ? end : text.end + 1;
+        return text;
+    }
+};
+
+// One booking of passengers2.txt is "flight:cabin:fare:seat:time", plus
+// ":YYYY-MM-DD" for a dated departure, with cabin B or E and fare "-" when
+// unknown. Older files hold a bare flight
+// number, read as an economy booking of unknown fare made at load time.
+// Without a seat field the seat is SEAT_PENDING.
+bool parseBooking(FieldText token, time_t now, Booking& out) {
+    FieldText fields[6];
+    int count = 0;
+    for (const char* p = token.begin; count < 6;) {
+        const char* colon = static_cast<const char*>(memchr(p, ':', token.end - p));
+        fields[count].begin = p;
+        fields[count++].end = colon ? colon : token.end;
+        if (!colon) break;
+        p = colon + 1;
+    }
+    if (!IntCodec::parse(fields[0], out.flightNo, now)) return false;
+
+    long long n;
+    out.businessClass = count > 1 && fields[1].end - fields[1].begin == 1 && *fields[1].begin == 'B';
+    out.fare = Money::fromCents(-1);
+    out.bookedAt = now;
+    out.date = 0;
+    if (count > 5 && !parseDate(string(fields[5].begin, fields[5].end), out.date)) return false;
+    bool unknownFare = count > 2 && fields[2].end - fields[2].begin == 1 && *fields[2].begin == '-';
+    if (count > 2 && !unknownFare && !MoneyCodec::parse(fields[2], out.fare, now)) return false;
+    if (count > 3 && parseDigits(fields[3], 9, n)) out.seat = static_cast<unsigned short>(n);
+    else out.seat = SEAT_PENDING;
+    if (count > 4 && parseDigits(fields[4], 18, n)) out.bookedAt = static_cast<time_t>(n);
+    return true;
+}
+
+// The ';'-separated bookings that end a passengers2.txt line. Parsing only
+// fills in the record; Customer::claimBookings then takes the seats.
+struct BookingListField {
+    static bool parse(FieldText text, Customer& c, time_t now) {
+        for (const char* p = text.begin; p < text.end;) {
+            const char* stop = static_cast<const char*>(memchr(p, ';', text.end - p));
+            if (!stop) stop = text.end;
+            FieldText token = { p, stop };
+            Booking booking;
+            if (stop != p && parseBooking(token, now, booking)) c.bookings.push_back(booking);
+            p = stop + 1;
+        }
+        return true;
+    }
+
+    static void write(string& out, const Customer& c) {
+        for (int i = 0; i < c.bookings.getSize(); i++) {
+            const Booking& booking = c.bookings[i];
+            if (i) out += ';';
+            appendInt(out, booking.flightNo);
+            out += booking.businessClass ? ":B:" : ":E:";
+            if (booking.fare.getCents() >= 0) out += booking.fare.str();
+            else out += '-';
+            out += ':';
+            appendInt(out, booking.seat);
+            out += ':';
+            appendInt(out, static_cast<long long>(booking.bookedAt));
+            if (booking.date) {
+                out += ':';
+                out += formatDate(booking.date);
+            }
+        }
+    }
+
+    static void writeBinary(string& out, const Customer& c) {
+        appendRaw(out, c.bookings.getSize());
+        for (const Booking& booking : c.bookings) {
+            appendRaw(out, booking.fare.getCents());
+            appendRaw(out, static_cast<long long>(booking.bookedAt));
+            appendRaw(out, booking.flightNo);
+            appendRaw(out, booking.date);
+            appendRaw(out, booking.seat);
+            appendRaw(out, booking.businessClass);
+        }
+    }
+
+    static bool readBinary(BinaryReader& in, Customer& c) {
+        int count;
+        if (!in.raw(count)) return false;
+        for (int i = 0; i < count; i++) {
+            Booking booking;
+            long long cents, bookedAt;
+            if (!in.raw(cents) || !in.raw(bookedAt) || !in.raw(booking.flightNo) || !in.raw(booking.date)
+                || !in.raw(booking.seat) || !in.raw(booking.businessClass)) {
+                return false;
+            }
+            booking.fare = Money::fromCents(cents);
+            booking.bookedAt = static_cast<time_t>(bookedAt);
+            c.bookings.push_back(booking);
+        }
+        return true;
+    }
+};
+
+// flights2.txt: no,from,to,leave,arrive,cost,type,seats,booked,
+// business,booked business,economy,booked economy,weather,day
+struct FlightSchema : RecordSchema<',',
+    Field<&Flight::flightNo, IntCodec>,
+    Field<&Flight::from, TextCodec>,
+    Field<&Flight::to, TextCodec>,
+    Field<&Flight::t_leave, TimeCodec>,
+    Field<&Flight::t_arrive, TimeCodec>,
+    Field<&Flight::cost, IntCodec>,
+    Field<&Flight::plane_type, TextCodec>,
+    Field<&Flight::seats, IntCodec>,
+    Field<&Flight::booked_seats, IntCodec>,
+    Field<&Flight::businessSeats, IntCodec>,
+    Field<&Flight::bookedBusinessSeats, IntCodec>,
+    Field<&Flight::economySeats, IntCodec>,
+    Field<&Flight::bookedEconomySeats, IntCodec>,
+    Field<&Flight::weather, TextCodec>,
+    Field<&Flight::dayOfWeek, TextCodec>> {
+};
+
+// passengers2.txt: passport,name,surname,nationality,address,tel,discount,
+// spent,bookings
+struct CustomerSchema : RecordSchema<',',
+    Field<&Customer::passportNo, IntCodec>,
+    Field<&Customer::name, TextCodec>,
+    Field<&Customer::surname, TextCodec>,
+    Field<&Customer::nationality, TextCodec>,
+    Field<&Customer::address, TextCodec>,
+    Field<&Customer::tel, IntCodec>,
+    Field<&Customer::discount, OfferCodec>,
+    Field<&Customer::totalSpent, MoneyCodec>,
+    BookingListField> {
+};
+
+// One waitlisted passenger of queues2.txt, "passport@joinTime".
+struct WaitlistEntry {
+    int passport;
+    time_t joined;
+};
+
+struct WaitlistSchema : RecordSchema<'@',
+    Field<&WaitlistEntry::passport, IntCodec>,
+    Field<&WaitlistEntry::joined, JoinTimeCodec>> {
+};
+
+// File operations
+bool Flight::parseRecord(const string& line, Flight& f) {
+    if (!FlightSchema::parse(line.data(), line.data() + line.size(), f, 0)) return false;
+    f.operatingDays = parseOperatingDays(f.dayOfWeek);
+    return true;
+}
+
+void Flight::loadFromFile() {
+    FRS_TIMED(OP_LOAD_FLIGHTS);
+    PricingEngine::loadConfig(dataFile("pricing.txt"));
+    string contents;
+    if (!FileIO::readFile(dataFile("flights2.txt"), contents)) return;
+    istringstream file(contents);
+
+    flist.clear();
+
+    string line;
+    while (getline(file, line)) {
+        if (line.empty()) continue;
+
+        // Parsed straight into its list node
+        Flight& f = flist.emplace_back();
+        if (!parseRecord(line, f)) {
+            flist.erase(flist.getTail());
+            continue;
+        }
+        f.buildFares();
+    }
+    indexFlights();
+    loadOverbookLimits(dataFile("overbook.txt"));
+    loadSchedules(dataFile("schedules.txt"));
+}
+
+// Sorts the flight numbers, keeps the first flight of any repeated number
+// and builds the index bottom-up. A sorted merge against the existing queues
+// gives every flight its waitlist queue.
+int Flight::indexFlights() {
+    int n = flist.getSize();
+    unsigned long long* entries = new unsigned long long[n > 0 ? n : 1];
+    ListNode<Flight>** nodes = new ListNode<Flight>*[n > 0 ? n : 1];
+    int i = 0;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next, i++) {
+        nodes[i] = node;
+        entries[i] = sortEntry(node->data.flightNo, i);
+    }
+    int threads = static_cast<int>(thread::hardware_concurrency());
+    radixSortEntries(entries, n, threads);
+
+    int* keys = new int[n > 0 ? n : 1];
+    Flight** flights = new Flight*[n > 0 ? n : 1];
+    int kept = 0, dropped = 0;
+    for (i = 0; i < n; i++) {
+        ListNode<Flight>* node = nodes[entryPosition(entries[i])];
+        if (kept > 0 && keys[kept - 1] == entryKey(entries[i])) {
+            cerr << "Error: flight " << entryKey(entries[i]) << " is listed twice; keeping the first." << endl;
+            flist.erase(node);
+            dropped++;
+            continue;
+        }
+        keys[kept] = entryKey(entries[i]);
+        flights[kept++] = &node->data;
+        node->data.publish();
+    }
+    flightBST.build(keys, flights, kept);
+
+    int queueCount = qlist.getSize();
+    unsigned long long* queues = new unsigned long long[queueCount > 0 ? queueCount : 1];
+    i = 0;
+    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next, i++) {
+        queues[i] = sortEntry(qnode->data.getNo(), i);
+    }
+    radixSortEntries(queues, queueCount, threads);
+    for (int f = 0, q = 0; f < kept; f++) {
+        while (q < queueCount && entryKey(queues[q]) < keys[f]) q++;
+        if (q < queueCount && entryKey(queues[q]) == keys[f]) continue;
+        qlist.emplace_back(keys[f]);
+    }
+
+    delete[] entries;
+    delete[] nodes;
+    delete[] keys;
+    delete[] flights;
+    delete[] queues;
+    return dropped;
+}
+
+// Reads "<flight> <business> <economy>" lines written by --overbook --apply.
+// Flights missing from the file cannot be overbooked.
+void Flight::loadOverbookLimits(const string& path) {
+    string contents;
+    if (!FileIO::readFile(path, contents)) return;
+    istringstream file(contents);
+
+    string line;
+    while (getline(file, line)) {
+        size_t hash = line.find('#');
+        if (hash != string::npos) line.erase(hash);
+        istringstream fields(line);
+        int num, business, economy;
+        if (!(fields >> num)) continue;
+        if (!(fields >> business >> economy) || business < 0 || economy < 0) {
+            cerr << "Error: invalid overbooking line '" << line << "'." << endl;
+            continue;
+        }
+        Flight* flight = flightBST.find(num);
+        if (!flight) continue;
+        flight->overbookLimit[1] = business;
+        flight->overbookLimit[0] = economy;
+    }
+}
+
+// Reads "<flight> <days> [<first date> [<last date>]]" lines, such as
+// "1016 Mon,Wed,Fri 2026-11-01 2027-03-31", with "-" for an open end. They
+// replace the flight's dayOfWeek as the template for dated departures.
+void Flight::loadSchedules(const string& path) {
+    string contents;
+    if (!FileIO::readFile(path, contents)) return;
+    istringstream file(contents);
+
+    string line;
+    while (getline(file, line)) {
+        size_t hash = line.find('#');
+        if (hash != string::npos) line.erase(hash);
+        istringstream fields(line);
+        int num;
+        if (!(fields >> num)) continue;
+        string days, first = "-", last = "-";
+        fields >> days >> first >> last;
+        unsigned char mask = parseOperatingDays(days);
+        int firstDate = 0, lastDate = 0;
+        if (!mask || (first != "-" && !parseDate(first, firstDate)) || (last != "-" && !parseDate(last, lastDate))) {
+            cerr << "Error: invalid schedule line '" << line << "'." << endl;
+            continue;
+        }
+        Flight* flight = flightBST.find(num);
+        if (!flight) continue;
+        flight->operatingDays = mask;
+        flight->firstDate = firstDate;
+        flight->lastDate = lastDate;
+    }
+}
+
+void Flight::saveToFile() {
+    FRS_TIMED(OP_SAVE_FLIGHTS);
+    ostringstream file;
+    writeRecords(file);
+    string contents = file.str();
+    if (!FileIO::writeFile(dataFile("flights2.txt"), contents)) {
+        cerr << "Error: Could not save flight data to file." << endl;
+        return;
+    }
+    FRS_COUNT(BYTES_WRITTEN, contents.size());
+}
+
+void Flight::writeRecords(ostream& file) {
+    string buffer;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+        FlightSchema::write(buffer, node->data);
+        buffer += '\n';
+        flushRecords(file, buffer, false);
+    }
+    flushRecords(file, buffer, true);
+}
+
+// Keeps a booking read from disk and marks its seat taken. Records from
+// older files have no seat yet and get the first free one in their cabin.
+void Customer::claimBookings() {
+    for (Booking& booking : bookings) {
+        Flight* flight = flightBST.find(booking.flightNo);
+        if (!flight) {
+            if (booking.seat == SEAT_PENDING) booking.seat = 0;
+            continue;
+        }
+        // A dated departure comes back into being with its first booking
+        if (booking.date) DatedFlights::materialize(booking.flightNo, booking.date)->booked[booking.businessClass]++;
+        if (booking.seat == SEAT_PENDING) booking.seat = static_cast<unsigned short>(flight->assignSeat(booking.businessClass, booking.date));
+        else if (booking.seat) flight->claimSeat(booking.seat, booking.date);
+    }
+}
+
+bool Customer::bookingsFit(string& error) const {
+    for (int i = 0; i < bookings.getSize(); i++) {
+        const Booking& booking = bookings[i];
+        const Flight* flight = flightBST.find(booking.flightNo);
+        if (!flight) {
+            error = "unknown flight " + to_string(booking.flightNo);
+            return false;
+        }
+        if (booking.date && !flight->operatesOn(booking.date)) {
+            error = "flight " + to_string(booking.flightNo) + " has no departure on " + formatDate(booking.date);
+            return false;
+        }
+        // The record's own earlier bookings of the same cabin and seat count too
+        int sameCabin = 0;
+        bool seatRepeated = false;
+        for (int j = 0; j < i; j++) {
+            const Booking& earlier = bookings[j];
+            if (earlier.flightNo != booking.flightNo || earlier.date != booking.date) continue;
+            if (earlier.businessClass == booking.businessClass) sameCabin++;
+            if (earlier.seat == booking.seat && booking.seat != SEAT_PENDING && booking.seat) seatRepeated = true;
+        }
+        if (flight->seatsLeft(booking.businessClass, false, booking.date) <= sameCabin) {
+            error = "flight " + to_string(booking.flightNo) + " has no free " + (booking.businessClass ? "business" : "economy")
+                + " seat";
+            return false;
+        }
+        if (booking.seat != SEAT_PENDING && booking.seat
+            && (seatRepeated || !flight->seatFree(booking.businessClass, booking.seat, booking.date))) {
+            error = "seat " + to_string(booking.seat) + " on flight " + to_string(booking.flightNo) + " is not free";
+            return false;
+        }
+    }
+    return true;
+}
+
+Customer* Customer::parseRecord(const string& line, time_t now) {
+    Customer* p = new Customer();
+    if (!CustomerSchema::parse(line.data(), line.data() + line.size(), *p, now)) {
+        delete p;
+        return nullptr;
+    }
+    return p;
+}
+
+void Customer::loadFromFile() {
+    FRS_TIMED(OP_LOAD_CUSTOMERS);
+    string contents;
+    if (!FileIO::readFile(dataFile("passengers2.txt"), contents)) return;
+    istringstream file(contents);
+
+    for (Customer* customer : customerBST) delete customer;
+    customerBST.clear();
+    customerNames.clear();
+    DatedFlights::clear();
+
+    SmallVector<Customer*, 1> loaded;
+    size_t lines = 0;
+    for (char c : contents) lines += c == '\n';
+    loaded.reserve(static_cast<int>(lines + 1));
+
+    time_t now = time(nullptr);
+    string line;
+    while (getline(file, line)) {
+        if (line.empty()) continue;
+        Customer* p = parseRecord(line, now);
+        if (p) loaded.push_back(p);
+    }
+
+    // Seats are taken in file order once repeated passports are gone, so a
+    // dropped record never holds a seat
+    indexCustomers(loaded.begin(), loaded.getSize());
+    for (Customer* p : loaded) {
+        if (!p) continue;
+        p->claimBookings();
+        p->publish();
+        customerNames.insert(p->passportNo, p->name, p->surname);
+    }
+}
+
+// Sorts the customers by passport and rebuilds customerBST bottom-up. A
+// repeated passport keeps its first record; the others are freed, their
+// seats given back, and their slots set to null. Returns how many went.
+int Customer::indexCustomers(Customer** customers, int n) {
+    unsigned long long* entries = new unsigned long long[n > 0 ? n : 1];
+    for (int i = 0; i < n; i++) entries[i] = sortEntry(customers[i]->passportNo, i);
+    radixSortEntries(entries, n, static_cast<int>(thread::hardware_concurrency()));
+
+    int* keys = new int[n > 0 ? n : 1];
+    Customer** sorted = new Customer*[n > 0 ? n : 1];
+    int kept = 0, dropped = 0;
+    for (int i = 0; i < n; i++) {
+        int position = entryPosition(entries[i]);
+        if (kept > 0 && keys[kept - 1] == entryKey(entries[i])) {
+            cerr << "Error: passport " << entryKey(entries[i]) << " is listed twice; keeping the first." << endl;
+            delete customers[position];
+            customers[position] = nullptr;
+            dropped++;
+            continue;
+        }
+        keys[kept] = entryKey(entries[i]);
+        sorted[kept++] = customers[position];
+    }
+    customerBST.build(keys, sorted, kept);
+
+    delete[] entries;
+    delete[] keys;
+    delete[] sorted;
+    return dropped;
+}
+
+void Customer::saveToFile() {
+    FRS_TIMED(OP_SAVE_CUSTOMERS);
+    ostringstream file;
+    writeRecords(file);
+    string contents = file.str();
+    if (!FileIO::writeFile(dataFile("passengers2.txt"), contents)) {
+        cerr << "Error: Failed to write all data to passengers2.txt." << endl;
+        return;
+    }
+    FRS_COUNT(BYTES_WRITTEN, contents.size());
+}
+
+void Customer::writeRecords(ostream& file) {
+    string buffer;
+    for (CustomerBST::Iterator it = customerBST.begin(); it != customerBST.end(); ++it) {
+        CustomerSchema::write(buffer, **it);
+        buffer += '\n';
+        flushRecords(file, buffer, false);
+    }
+    flushRecords(file, buffer, true);
+}
+
+void Queue::loadFromFile() {
+    FRS_TIMED(OP_LOAD_QUEUES);
+    string contents;
+    if (!FileIO::readFile(dataFile("queues2.txt"), contents)) return;
+    istringstream file(contents);
+
+    qlist.clear();
+
+    time_t now = time(nullptr);
+    string line;
+    while (getline(file, line)) {
+        if (line.empty()) continue;
+
+        istringstream iss(line);
+        string token;
+
+        // Queue Number
+        getline(iss, token, ':');
+        if (!checkNumber(token)) continue;
+        int queueNo = stoi(token);
+
+        // Find or create queue
+        Queue* currentQueue = nullptr;
+        for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+            if (queueNo == qnode->data.getNo()) {
+                currentQueue = &qnode->data;
+                break;
+            }
+        }
+        if (!currentQueue) {
+            currentQueue = &qlist.emplace_back(queueNo);
+        }
+
+        // Passengers in queue
+        string passengerStr;
+        getline(iss, passengerStr);
+        if (!passengerStr.empty()) {
+            istringstream passengerStream(passengerStr);
+            string entryToken;
+            while (getline(passengerStream, entryToken, ';')) {
+                WaitlistEntry entry;
+                const char* text = entryToken.data();
+                if (!WaitlistSchema::parse(text, text + entryToken.size(), entry, now)) continue;
+                if (WaitlistAging::isExpired(entry.joined, now)) continue;
+
+                // Find the Customer in BST
+                Customer* customer = customerBST.find(entry.passport);
+                if (customer) {
+                    currentQueue->link(*customer, entry.joined);
+                }
+            }
+        }
+        currentQueue->depthChanged();
+    }
+}
+
+void Queue::saveToFile() {
+    FRS_TIMED(OP_SAVE_QUEUES);
+    ostringstream file;
+    writeRecords(file);
+    string contents = file.str();
+    if (!FileIO::writeFile(dataFile("queues2.txt"), contents)) {
+        cerr << "Error: Could not save queue data to file." << endl;
+        return;
+    }
+    FRS_COUNT(BYTES_WRITTEN, contents.size());
+}
+
+void Queue::writeRecords(ostream& file) {
+    string buffer;
+    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+        appendInt(buffer, qnode->data.getNo());
+        buffer += ':';
+        for (QueueNode* current = qnode->data.getFront(); current; current = current->next) {
+            if (current != qnode->data.getFront()) buffer += ';';
+            WaitlistEntry entry = { current->Customer.getPassport(), current->joinTime };
+            WaitlistSchema::write(buffer, entry);
+        }
+        buffer += '\n';
+        flushRecords(file, buffer, false);
+    }
+    flushRecords(file, buffer, true);
+}
+
+// Flight member functions implementation
+void Flight::addFlight() {
+    string temp;
+    bool flag = false;
+
+    cout << "Add new flights by giving the following attributes:\n";
+    cin.clear();
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+    // Flight Number
+    do {
+        cout << "Flight Number: ";
+        getline(cin, temp);
+
+        if (!checkNumber(temp)) {
+            cout << "Please insert a valid Flight Number!\n";
+            continue;
+        }
+
+        int num = stoi(temp);
+        if (Flight::flightExists(num)) {
+            cout << "This Flight already exists!\n";
+            continue;
+        }
+
+        this->flightNo = num;
+        break;
+    } while (true);
+
+    // Departure
+    do {
+        cout << "Departure: ";
+        getline(cin, this->from);
+
+        if (this->from.length() > 20 || !checkString(this->from)) {
+            cout << "Please insert a valid Departure city!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Destination
+    do {
+        cout << "Destination: ";
+        getline(cin, this->to);
+
+        if (this->to.length() > 20 || !checkString(this->to) || this->to == this->from) {
+            cout << "Please insert a valid Destination city!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Boarding time
+    do {
+        cout << "Boarding time (e.g. 19:40): ";
+        getline(cin, temp);
+
+        if (!checkTime(temp)) {
+            cout << "Please insert a valid boarding time (e.g. 19:40)!\n";
+            continue;
+        }
+
+        size_t colon = temp.find(':');
+        this->t_leave.hour = stoi(temp.substr(0, colon));
+        this->t_leave.min = stoi(temp.substr(colon + 1));
+        break;
+    } while (true);
+
+    // Arrival time
+    do {
+        cout << "Arriving time (e.g. 21:40): ";
+        getline(cin, temp);
+
+        if (!checkTime(temp)) {
+            cout << "Please insert a valid arriving time (e.g. 21:40)!\n";
+            continue;
+        }
+
+        size_t colon = temp.find(':');
+        this->t_arrive.hour = stoi(temp.substr(0, colon));
+        this->t_arrive.min = stoi(temp.substr(colon + 1));
+
+        // An arrival earlier in the day than the departure lands the next day
+        if (sameTime(this->t_arrive, this->t_leave)) {
+            cout << "Arrival time must differ from departure time!\n";
+            continue;
+        }
+        if (arrivesNextDay()) cout << "The flight arrives the next day.\n";
+        break;
+    } while (true);
+
+    // Ticket price
+    do {
+        cout << "Ticket price: ";
+        getline(cin, temp);
+
+        if (!checkNumber(temp)) {
+            cout << "Please insert a valid ticket price!\n";
+            continue;
+        }
+        this->cost = stoi(temp);
+        break;
+    } while (true);
+
+    // Aeroplane type
+    do {
+        cout << "Aeroplane type: ";
+        getline(cin, this->plane_type);
+
+        if (this->plane_type.empty()) {
+            cout << "Please insert a valid Aeroplane type!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Number of seats
+    do {
+        cout << "Total number of seats: ";
+        getline(cin, temp);
+
+        if (!checkNumber(temp)) {
+            cout << "Please insert a valid number of seats!\n";
+            continue;
+        }
+        this->seats = stoi(temp);
+
+        // Business class seats
+        cout << "Number of business class seats: ";
+        getline(cin, temp);
+
+        if (!checkNumber(temp) || stoi(temp) > this->seats) {
+            cout << "Please insert a valid number of business class seats!\n";
+            continue;
+        }
+        this->businessSeats = stoi(temp);
+        this->economySeats = this->seats - this->businessSeats;
+        break;
+    } while (true);
+
+    // Number of booked seats
+    do {
+        cout << "Number of booked business class seats: ";
+        getline(cin, temp);
+
+        if (!checkNumber(temp) || stoi(temp) > this->businessSeats) {
+            cout << "Please insert a valid number of booked business class seats!\n";
+            continue;
+        }
+        this->bookedBusinessSeats = stoi(temp);
+
+        cout << "Number of booked economy class seats: ";
+        getline(cin, temp);
+
+        if (!checkNumber(temp) || stoi(temp) > this->economySeats) {
+            cout << "Please insert a valid number of booked economy class seats!\n";
+            continue;
+        }
+        this->bookedEconomySeats = stoi(temp);
+
+        this->booked_seats = this->bookedBusinessSeats + this->bookedEconomySeats;
+        break;
+    } while (true);
+
+    do {
+        cout << "Weather condition (e.g., Sunny, Rainy, Cloudy, etc.): ";
+        getline(cin, this->weather);
+        if (this->weather.empty()) {
+            cout << "Please enter a valid weather condition!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Day of week
+    do {
+        cout << "Day of week (e.g., Monday, Tuesday, etc.): ";
+        getline(cin, this->dayOfWeek);
+        if (this->dayOfWeek.empty()) {
+            cout << "Please enter a valid day of week!\n";
+            continue;
+        }
+        this->operatingDays = parseOperatingDays(this->dayOfWeek);
+        break;
+    } while (true);
+
+    buildFares();
+    invalidateRow();
+    flist.push_back(*this);
+    flist.getTail()->data.publish();
+    flightBST.insert(this->flightNo, &flist.getTail()->data);
+
+    qlist.emplace_back(this->flightNo);
+
+    // Save to file
+    Flight::saveToFile();
+    Queue::saveToFile();
+
+    cout << "Flight No: " << this->flightNo << " was successfully added!\n";
+}
+
+void Flight::deleteFlight(int num) {
+    FRS_TIMED(OP_DELETE_FLIGHT);
+    // Check if flight exists
+    Flight* flight = flightBST.find(num);
+    if (!flight) {
+        cout << "Flight with number " << num << " does not exist!\n";
+        return;
+    }
+
+    // Find the queue for this flight
+    ListNode<Queue>* queueNodeToDelete = nullptr;
+    Queue* flightQueue = nullptr;
+
+    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+        if (num == qnode->data.getNo()) {
+            flightQueue = &qnode->data;
+            queueNodeToDelete = qnode;
+            break;
+        }
+    }
+
+    // Handle passengers in queue
+    if (flightQueue && !flightQueue->isEmpty()) {
+        cout << "\nThere are " << flightQueue->getSize() << " passengers in the waiting queue for this flight.\n";
+        cout << "You need to manage the queue before deleting this flight.\n";
+
+        cout << "Options:\n";
+        cout << "1. Manage queue now\n";
+        cout << "2. Cancel deletion\n";
+        cout << "Enter your choice (1-2): ";
+
+        string choice;
+        getline(cin, choice);
+
+        while (choice != "1" && choice != "2") {
+            cout << "Invalid choice. Please enter 1 or 2: ";
+            getline(cin, choice);
+        }
+
+        if (choice == "1") {
+            Customer customer;
+            customer.manageQueue(num);
+            // Check if queue is now empty
+            if (flightQueue && !flightQueue->isEmpty()) {
+                cout << "There are still " << flightQueue->getSize()
+                    << " passengers in the queue. Cannot delete flight.\n";
+                return;
+            }
+        }
+        else {
+            cout << "Flight deletion cancelled.\n";
+            return;
+        }
+    }
+
+    // Refund everyone booked on it while the flight can still price
+    // bookings whose fare was never recorded
+    for (Customer* customer : customerBST) {
+        Money refundAmount;
+        if (customer->removeFlight(num, refundAmount) > 0) {
+            customer->setTotalSpent(customer->getTotalSpent() - refundAmount);
+
+            cout << "Customer " << customer->getName() << " " << customer->getSurname()
+                << " (Passport: " << customer->getPassport() << ") was booked on this flight.\n";
+            cout << "Refund issued: $" << refundAmount << endl;
+        }
+    }
+    DatedFlights::dropFlight(num);
+
+    // Remove from flight list
+    ListNode<Flight>* flightNodeToDelete = nullptr;
+    for (ListNode<Flight>* fnode = flist.begin(); fnode != flist.end(); fnode = fnode->next) {
+        if (num == fnode->data.getFlightNo()) {
+            flightNodeToDelete = fnode;
+            break;
+        }
+    }
+
+    if (flightNodeToDelete) {
+        flist.erase(flightNodeToDelete);
+        indexFlights(); // Rebuild BST without this flight
+    }
+
+    // Remove from queue list if exists
+    if (queueNodeToDelete) {
+        qlist.erase(queueNodeToDelete);
+    }
+
+    // Save changes to files
+    Flight::saveToFile();
+    Queue::saveToFile();
+
+    cout << "\nFlight " << num << " has been successfully deleted.\n";
+
+
+    // Save customer changes
+    Customer::saveToFile();
+}
+// ---------------------------------------------------------------------------
+// Schedule rendering
+//
+// Rows are formatted by hand into one reusable buffer that reaches the stream
+// in large blocks, instead of going through setw/to_string per field and
+// flushing with endl per row. Each thread has one such block; rendering into
+// a string appends to the string directly and needs none.
+// ---------------------------------------------------------------------------
+
+const int SCHEDULE_PAGE_ROWS = 40;
+
+enum RenderFormat {
+    RENDER_TABLE,
+    RENDER_CSV,
+    RENDER_JSONL
+};
+
+class RenderBuffer {
+public:
+    static const size_t CAPACITY = 64 * 1024;
+
+    // A stream buffer takes the thread's block; one opened while that is
+    // taken writes straight through.
+    explicit RenderBuffer(ostream& o) : out(&o), sink(nullptr), data(blockTaken ? nullptr : block), used(0) {
+        if (data) blockTaken = true;
+    }
+    explicit RenderBuffer(string& s) : out(nullptr), sink(&s), data(nullptr), used(0) {}
+    ~RenderBuffer() {
+        flush();
+        if (data) blockTaken = false;
+    }
+    RenderBuffer(const RenderBuffer&) = delete;
+    RenderBuffer& operator=(const RenderBuffer&) = delete;
+
+    void append(const char* s, size_t n) {
+        if (!data) { write(s, n); return; }
+        if (used + n > CAPACITY) {
+            flush();
+            if (n > CAPACITY) { write(s, n); return; }
+        }
+        memcpy(data + used, s, n);
+        used += n;
+    }
+    void append(const string& s) { append(s.data(), s.size()); }
+    void append(const char* s) { append(s, strlen(s)); }
+    void append(char c) {
+        if (!data) { write(&c, 1); return; }
+        if (used == CAPACITY) flush();
+        data[used++] = c;
+    }
+
+    void appendInt(long long v) {
+        char digits[24];
+        append(digits, formatInt(digits, v));
+    }
+
+    // Left-justified in width columns, like left << setw(width).
+    void appendCell(const char* s, size_t n, int width) {
+        append(s, n);
+        for (size_t i = n; i < static_cast<size_t>(width); i++) append(' ');
+    }
+    void appendCell(const string& s, int width) { appendCell(s.data(), s.size(), width); }
+
+    void appendCsv(const string& s) {
+        if (s.find_first_of(",\"\n") == string::npos) { append(s); return; }
+        append('"');
+        for (char c : s) {
+            if (c == '"') append('"');
+            append(c);
+        }
+        append('"');
+    }
+
+    void appendJson(const string& s) {
+        append('"');
+        for (char c : s) {
+            if (c == '"' || c == '\\') append('\\');
+            if (static_cast<unsigned char>(c) < 0x20) c = ' ';
+            append(c);
+        }
+        append('"');
+    }
+
+    void flush() {
+        if (used) write(data, used);
+        used = 0;
+    }
+
+    // Writes v in decimal to dst and returns the length.
+    static size_t formatInt(char* dst, long long v) {
+        char reversed[24];
+        size_t n = 0;
+        unsigned long long u = v < 0 ? 0ULL - static_cast<unsigned long long>(v) : static_cast<unsigned long long>(v);
+        do {
+            reversed[n++] = static_cast<char>('0' + u % 10);
+            u /= 10;
+        } while (u);
+        size_t len = 0;
+        if (v < 0) dst[len++] = '-';
+        while (n) dst[len++] = reversed[--n];
+        return len;
+    }
+
+    // H:MM as the console shows it, or HH:MM as the data files store it.
+    static size_t formatTime(char* dst, Time t, bool padHour) {
+        size_t len = 0;
+        if (padHour && t.hour < 10) dst[len++] = '0';
+        len += formatInt(dst + len, t.hour);
+        dst[len++] = ':';
+        dst[len++] = static_cast<char>('0' + (t.min / 10) % 10);
+        dst[len++] = static_cast<char>('0' + t.min % 10);
+        return len;
+    }
+
+private:
+    void write(const char* s, size_t n) {
+        if (sink) sink->append(s, n);
+        else out->write(s, static_cast<streamsize>(n));
+    }
+
+    static thread_local char block[CAPACITY];
+    static thread_local bool blockTaken;
+
+    ostream* out;
+    string* sink;
+    char* data;
+    size_t used;
+};
+
+thread_local char RenderBuffer::block[RenderBuffer::CAPACITY];
+thread_local bool RenderBuffer::blockTaken = false;
+
+class ScheduleRenderer {
+public:
+    static void header(RenderBuffer& buffer, RenderFormat format, bool withStatus);
+    static void row(RenderBuffer& buffer, const Flight& flight, RenderFormat format);
+
+    // Renders up to limit rows (all when limit <= 0) starting at from and
+    // returns the first row not rendered.
+    static ListNode<Flight>* render(ostream& out, RenderFormat format, ListNode<Flight>* from, int limit);
+};
+
+void ScheduleRenderer::header(RenderBuffer& buffer, RenderFormat format, bool withStatus) {
+    if (format == RENDER_CSV) {
+        buffer.append("flight,from,to,leave,arrive,cost,type,seats,booked,business_booked,business_seats,"
+            "economy_booked,economy_seats,weather,day\n");
+        return;
+    }
+    if (format == RENDER_JSONL) return;
+
+    buffer.append("FLIGHT    FROM           TO             LEAVE     ARRIVE    COST      "
+        "TYPE           SEATS     BOOKED    BUSINESS       ECONOMY        ");
+    if (withStatus) buffer.append("WEATHER   DAY       ");
+    buffer.append('\n');
+}
+
+void ScheduleRenderer::row(RenderBuffer& buffer, const Flight& flight, RenderFormat format) {
+    char scratch[64];
+    size_t n;
+
+    if (format == RENDER_TABLE) {
+        buffer.appendCell(scratch, RenderBuffer::formatInt(scratch, flight.getFlightNo()), 10);
+        buffer.appendCell(flight.getDeparture(), 15);
+        buffer.appendCell(flight.getDestination(), 15);
+        buffer.appendCell(scratch, RenderBuffer::formatTime(scratch, flight.getLeavingTime(), false), 10);
+        n = RenderBuffer::formatTime(scratch, flight.getArrivingTime(), false);
+        if (flight.arrivesNextDay()) {
+            scratch[n++] = '+';
+            scratch[n++] = '1';
+        }
+        buffer.appendCell(scratch, n, 10);
+        scratch[0] = '$';
+        buffer.appendCell(scratch, 1 + RenderBuffer::formatInt(scratch + 1, flight.getCost()), 10);
+        buffer.appendCell(flight.getPlaneType(), 15);
+        buffer.appendCell(scratch, RenderBuffer::formatInt(scratch, flight.getSeats()), 10);
+        buffer.appendCell(scratch, RenderBuffer::formatInt(scratch, flight.getBookedSeats()), 10);
+
+        n = 0;
+        scratch[n++] = 'B';
+        scratch[n++] = ':';
+        n += RenderBuffer::formatInt(scratch + n, flight.getBookedBusinessSeats());
+        scratch[n++] = '/';
+        n += RenderBuffer::formatInt(scratch + n, flight.getBusinessSeats());
+        buffer.appendCell(scratch, n, 15);
+        n = 0;
+        scratch[n++] = 'E';
+        scratch[n++] = ':';
+        n += RenderBuffer::formatInt(scratch + n, flight.getBookedEconomySeats());
+        scratch[n++] = '/';
+        n += RenderBuffer::formatInt(scratch + n, flight.getEconomySeats());
+        buffer.appendCell(scratch, n, 15);
+
+        buffer.appendCell(flight.getWeather(), 10);
+        buffer.appendCell(flight.getDayOfWeek(), 10);
+        buffer.append('\n');
+        return;
+    }
+
+    if (format == RENDER_CSV) {
+        buffer.appendInt(flight.getFlightNo());
+        buffer.append(',');
+        buffer.appendCsv(flight.getDeparture());
+        buffer.append(',');
+        buffer.appendCsv(flight.getDestination());
+        buffer.append(',');
+        buffer.append(scratch, RenderBuffer::formatTime(scratch, flight.getLeavingTime(), true));
+        buffer.append(',');
+        buffer.append(scratch, RenderBuffer::formatTime(scratch, flight.getArrivingTime(), true));
+        buffer.append(',');
+        buffer.appendInt(flight.getCost());
+        buffer.append(',');
+        buffer.appendCsv(flight.getPlaneType());
+        buffer.append(',');
+        buffer.appendInt(flight.getSeats());
+        buffer.append(',');
+        buffer.appendInt(flight.getBookedSeats());
+        buffer.append(',');
+        buffer.appendInt(flight.getBookedBusinessSeats());
+        buffer.append(',');
+        buffer.appendInt(flight.getBusinessSeats());
+        buffer.append(',');
+        buffer.appendInt(flight.getBookedEconomySeats());
+        buffer.append(',');
+        buffer.appendInt(flight.getEconomySeats());
+        buffer.append(',');
+        buffer.appendCsv(flight.getWeather());
+        buffer.append(',');
+        buffer.appendCsv(flight.getDayOfWeek());
+        buffer.append('\n');
+        return;
+    }
+
+    buffer.append("{\"flight\":");
+    buffer.appendInt(flight.getFlightNo());
+    buffer.append(",\"from\":");
+    buffer.appendJson(flight.getDeparture());
+    buffer.append(",\"to\":");
+    buffer.appendJson(flight.getDestination());
+    buffer.append(",\"leave\":\"");
+    buffer.append(scratch, RenderBuffer::formatTime(scratch, flight.getLeavingTime(), true));
+    buffer.append("\",\"arrive\":\"");
+    buffer.append(scratch, RenderBuffer::formatTime(scratch, flight.getArrivingTime(), true));
+    buffer.append("\",\"cost\":");
+    buffer.appendInt(flight.getCost());
+    buffer.append(",\"type\":");
+    buffer.appendJson(flight.getPlaneType());
+    buffer.append(",\"seats\":");
+    buffer.appendInt(flight.getSeats());
+    buffer.append(",\"booked\":");
+    buffer.appendInt(flight.getBookedSeats());
+    buffer.append(",\"business_booked\":");
+    buffer.appendInt(flight.getBookedBusinessSeats());
+    buffer.append(",\"business_seats\":");
+    buffer.appendInt(flight.getBusinessSeats());
+    buffer.append(",\"economy_booked\":");
+    buffer.appendInt(flight.getBookedEconomySeats());
+    buffer.append(",\"economy_seats\":");
+    buffer.appendInt(flight.getEconomySeats());
+    buffer.append(",\"weather\":");
+    buffer.appendJson(flight.getWeather());
+    buffer.append(",\"day\":");
+    buffer.appendJson(flight.getDayOfWeek());
+    buffer.append("}\n");
+}
+
+ListNode<Flight>* ScheduleRenderer::render(ostream& out, RenderFormat format, ListNode<Flight>* from, int limit) {
+    RenderBuffer buffer(out);
+    header(buffer, format, true);
+    ListNode<Flight>* node = from;
+    for (int rows = 0; node != flist.end() && (limit <= 0 || rows < limit); rows++, node = node->next) {
+        if (format == RENDER_TABLE) buffer.append(node->data.renderedRow());
+        else row(buffer, node->data, format);
+    }
+    return node;
+}
+
+// The schedule view keeps each flight's table row as rendered bytes.
+// Anything that changes a displayed field calls invalidateRow(); new flights
+// start empty and deleted ones take their row with them.
+const string& Flight::renderedRow() const {
+    if (scheduleRow.empty()) {
+        FRS_COUNT(SCHEDULE_ROWS_RENDERED, 1);
+        RenderBuffer buffer(scheduleRow);
+        ScheduleRenderer::row(buffer, *this, RENDER_TABLE);
+    }
+    else {
+        FRS_COUNT(SCHEDULE_ROWS_CACHED, 1);
+    }
+    return scheduleRow;
+}
+
+void Flight::displayInfo() const {
+    cout << renderedRow();
+}
+
+void Flight::displayFlightInfo(int num) {
+    Flight* flight = flightBST.find(num);
+    if (flight) {
+        {
+            RenderBuffer buffer(cout);
+            ScheduleRenderer::header(buffer, RENDER_TABLE, false);
+            buffer.append(flight->renderedRow());
+        }
+        Queue::display(num);
+    }
+    else {
+        cout << "Invalid number of flight was given.\n";
+    }
+}
+
+void Flight::displaySchedule() {
+    cout << "\n\t\t\t\t FLIGHT SCHEDULE\n\n";
+    ScheduleRenderer::render(cout, RENDER_TABLE, flist.begin(), 0);
+    cout << endl;
+}
+
+// Menu view of the schedule, SCHEDULE_PAGE_ROWS flights at a time.
+void Flight::browseSchedule() {
+    int pages = (flist.getSize() + SCHEDULE_PAGE_ROWS - 1) / SCHEDULE_PAGE_ROWS;
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+    cout << "\n\t\t\t\t FLIGHT SCHEDULE\n\n";
+    ListNode<Flight>* node = flist.begin();
+    for (int page = 1; node != flist.end(); page++) {
+        node = ScheduleRenderer::render(cout, RENDER_TABLE, node, SCHEDULE_PAGE_ROWS);
+        if (node == flist.end()) break;
+
+        cout << "-- Page " << page << " of " << pages << ": press Enter for more, q to stop -- " << flush;
+        string answer;
+        if (!getline(cin, answer) || (!answer.empty() && (answer[0] == 'q' || answer[0] == 'Q'))) break;
+    }
+    cout << endl;
+}
+
+// Reprices every cabin and offer from the current inventory. Called when
+// the cost, seats or waitlist change, so quotes stay a table lookup.
+void Flight::buildFares() {
+    for (int cabin = 0; cabin < 2; cabin++) {
+        bool business = cabin == 1;
+        int booked = business ? bookedBusinessSeats : bookedEconomySeats;
+        int capacity = business ? businessSeats : economySeats;
+        for (int offer = 0; offer < OFFER_COUNT; offer++) {
+            Money price = PricingEngine::price(cost, business, static_cast<offers>(offer), booked, capacity,
+                waitlistDepth);
+            relaxedStore(fareCents[cabin][offer], price.getCents());
+        }
+    }
+}
+
+void Flight::waitlistChanged(int num, int depth) {
+    Flight* flight = flightBST.find(num);
+    if (flight && flight->waitlistDepth != depth) {
+        flight->waitlistDepth = depth;
+        flight->buildFares();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Seat holds
+//
+// A hold takes a seat out of a cabin's availability at the quoted price
+// while the customer decides, and gives it back automatically once its TTL
+// passes. Deadlines live in a timing wheel ticking every HOLD_TICK_MS, so
+// expiring holds costs O(1) per tick however many are pending. Holds are
+// in memory only: held seats are never saved as booked.
+// ---------------------------------------------------------------------------
+
+class SeatHolds {
+public:
+    static const unsigned HOLD_TICK_MS = 100;
+
+    struct Hold : TimerNode, MemoryTracked<Memory::MEM_SEAT_HOLDS> {
+        unsigned index, generation;
+        int flightNo;
+        int date;  // dated departure, or 0
+        int passport;
+        bool businessClass;
+        Money price;
+        Hold* nextFree;
+    };
+
+    // Holds a seat and returns the hold id, or -1 when the cabin is full.
+    static long long place(int flightNo, int passport, bool businessClass, Money price, bool overbook, int date = 0);
+    // Ends a live hold without returning the seat, so the caller can book it.
+    static bool take(long long id, Hold& hold);
+    // Ends a live hold and returns its seat.
+    static bool release(long long id);
+    // Returns the seats of every hold whose TTL has passed.
+    static void expire();
+
+    static size_t active() { return wheel.size(); }
+    static void setTtlMs(unsigned ms) { ttlMs = ms > 0 ? ms : 1; }
+    static unsigned getTtlMs() { return ttlMs; }
+
+private:
+    static unsigned long long currentTick();
+    static Hold* lookup(long long id);
+    static void finish(Hold* hold);
+    static void onExpire(TimerNode* node, void* context);
+
+    static TimerWheel wheel;
+    static unsigned ttlMs;
+    static Hold** table;  // by index; ids carry a generation so stale ids miss
+    static unsigned capacity, used;
+    static Hold* freeList;
+};
+
+TimerWheel SeatHolds::wheel;
+unsigned SeatHolds::ttlMs = 120000;
+SeatHolds::Hold** SeatHolds::table = nullptr;
+unsigned SeatHolds::capacity = 0;
+unsigned SeatHolds::used = 0;
+SeatHolds::Hold* SeatHolds::freeList = nullptr;
+
+unsigned long long SeatHolds::currentTick() {
+    return static_cast<unsigned long long>(chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count()) / HOLD_TICK_MS;
+}
+
+void SeatHolds::expire() {
+    wheel.advance(currentTick(), onExpire, nullptr);
+}
+
+long long SeatHolds::place(int flightNo, int passport, bool businessClass, Money price, bool overbook, int date) {
+    expire();
+    if (!Flight::holdSeat(flightNo, businessClass, overbook, date)) return -1;
+
+    Hold* hold = freeList;
+    if (hold) {
+        freeList = hold->nextFree;
+    }
+    else {
+        if (used == capacity) {
+            unsigned grown = capacity ? capacity * 2 : 64;
+            Hold** bigger = new Hold*[grown];
+            Memory::allocated(Memory::MEM_SEAT_HOLDS, sizeof(Hold*) * grown);
+            for (unsigned i = 0; i < used; i++) bigger[i] = table[i];
+            if (table) Memory::freed(Memory::MEM_SEAT_HOLDS, sizeof(Hold*) * capacity);
+            delete[] table;
+            table = bigger;
+            capacity = grown;
+        }
+        hold = new Hold();
+        hold->index = used;
+        hold->generation = 0;
+        hold->level = hold->slot = -1;
+        table[used++] = hold;
+    }
+
+    hold->flightNo = flightNo;
+    hold->date = date;
+    hold->passport = passport;
+    hold->businessClass = businessClass;
+    hold->price = price;
+    hold->nextFree = nullptr;
+    unsigned long long ticks = (ttlMs + HOLD_TICK_MS - 1) / HOLD_TICK_MS;
+    wheel.schedule(hold, wheel.current() + ticks);
+    return static_cast<long long>(hold->generation) << 32 | hold->index;
+}
+
+SeatHolds::Hold* SeatHolds::lookup(long long id) {
+    if (id < 0) return nullptr;
+    unsigned index = static_cast<unsigned>(id & 0xffffffffLL);
+    unsigned generation = static_cast<unsigned>(id >> 32);
+    if (index >= used) return nullptr;
+    Hold* hold = table[index];
+    return hold->generation == generation && hold->level >= 0 ? hold : nullptr;
+}
+
+// Retires the hold's id and recycles it.
+void SeatHolds::finish(Hold* hold) {
+    hold->generation = (hold->generation + 1) & 0x7fffffff;
+    hold->nextFree = freeList;
+    freeList = hold;
+}
+
+bool SeatHolds::take(long long id, Hold& out) {
+    expire();
+    Hold* hold = lookup(id);
+    if (!hold) return false;
+    wheel.cancel(hold);
+    Flight::releaseSeat(hold->flightNo, hold->businessClass, hold->date);
+    out = *hold;
+    finish(hold);
+    return true;
+}
+
+bool SeatHolds::release(long long id) {
+    expire();
+    Hold* hold = lookup(id);
+    if (!hold) return false;
+    wheel.cancel(hold);
+    Flight::releaseSeat(hold->flightNo, hold->businessClass, hold->date);
+    finish(hold);
+    return true;
+}
+
+void SeatHolds::onExpire(TimerNode* node, void*) {
+    Hold* hold = static_cast<Hold*>(node);
+    Flight::releaseSeat(hold->flightNo, hold->businessClass, hold->date);
+    finish(hold);
+}
+
+DatedFlight** DatedFlights::buckets = nullptr;
+int DatedFlights::bucketCount = 0;
+int DatedFlights::count = 0;
+
+DatedFlight* DatedFlights::find(int flightNo, int date) {
+    if (count == 0) return nullptr;
+    for (DatedFlight* d = buckets[bucketOf(flightNo, date)]; d; d = d->next) {
+        if (d->flightNo == flightNo && d->date == date) return d;
+    }
+    return nullptr;
+}
+
+DatedFlight* DatedFlights::materialize(int flightNo, int date) {
+    DatedFlight* instance = find(flightNo, date);
+    if (instance) return instance;
+
+    if (count >= bucketCount) {
+        int oldCount = bucketCount;
+        DatedFlight** old = buckets;
+        bucketCount = oldCount ? oldCount * 2 : 64;
+        buckets = new DatedFlight*[bucketCount]();
+        Memory::allocated(Memory::MEM_DATED_FLIGHTS, sizeof(DatedFlight*) * bucketCount);
+        for (int b = 0; b < oldCount; b++) {
+            while (old[b]) {
+                DatedFlight* d = old[b];
+                old[b] = d->next;
+                unsigned target = bucketOf(d->flightNo, d->date);
+                d->next = buckets[target];
+                buckets[target] = d;
+            }
+        }
+        if (old) Memory::freed(Memory::MEM_DATED_FLIGHTS, sizeof(DatedFlight*) * oldCount);
+        delete[] old;
+    }
+
+    instance = new DatedFlight();
+    instance->flightNo = flightNo;
+    instance->date = date;
+    instance->booked[0] = instance->booked[1] = instance->held[0] = instance->held[1] = 0;
+    unsigned b = bucketOf(flightNo, date);
+    instance->next = buckets[b];
+    buckets[b] = instance;
+    count++;
+    return instance;
+}
+
+void DatedFlights::unlink(DatedFlight* instance) {
+    DatedFlight** link = &buckets[bucketOf(instance->flightNo, instance->date)];
+    while (*link != instance) link = &(*link)->next;
+    *link = instance->next;
+    delete instance;
+    count--;
+}
+
+void DatedFlights::releaseIfIdle(DatedFlight* instance) {
+    if (instance->booked[0] + instance->booked[1] + instance->held[0] + instance->held[1] > 0) return;
+    unlink(instance);
+}
+
+void DatedFlights::dropFlight(int flightNo) {
+    for (int b = 0; b < bucketCount; b++) {
+        DatedFlight** link = &buckets[b];
+        while (*link) {
+            DatedFlight* d = *link;
+            if (d->flightNo == flightNo) {
+                *link = d->next;
+                delete d;
+                count--;
+            }
+            else {
+                link = &d->next;
+            }
+        }
+    }
+}
+
+void DatedFlights::clear() {
+    for (int b = 0; b < bucketCount; b++) {
+        while (buckets[b]) {
+            DatedFlight* d = buckets[b];
+            buckets[b] = d->next;
+            delete d;
+        }
+    }
+    count = 0;
+}
+
+void Flight::resSeat(int num, int val, bool isBusiness, int date) {
+    if (date) {
+        DatedFlight* instance = val > 0 ? DatedFlights::materialize(num, date) : DatedFlights::find(num, date);
+        if (!instance) return;
+        instance->booked[isBusiness] += val;
+        DatedFlights::releaseIfIdle(instance);
+        return;
+    }
+    Flight* flight = flightBST.find(num);
+    if (flight) {
+        if (isBusiness) {
+            flight->bookedBusinessSeats += val;
+        }
+        else {
+            flight->bookedEconomySeats += val;
+        }
+        flight->booked_seats += val;
+        flight->buildFares();
+        flight->invalidateRow();
+    }
+}
+
+// Takes one seat of the cabin out of availability; false when it is full.
+bool Flight::holdSeat(int num, bool isBusiness, bool overbook, int date) {
+    Flight* flight = flightBST.find(num);
+    if (!flight) return false;
+    if (date && !flight->operatesOn(date)) return false;
+    if (flight->seatsLeft(isBusiness, overbook, date) <= 0) return false;
+    if (date) DatedFlights::materialize(num, date)->held[isBusiness]++;
+    else if (isBusiness) flight->heldBusinessSeats++;
+    else flight->heldEconomySeats++;
+    if (!date) flight->publish();
+    return true;
+}
+
+void Flight::releaseSeat(int num, bool isBusiness, int date) {
+    if (date) {
+        DatedFlight* instance = DatedFlights::find(num, date);
+        if (!instance) return;
+        if (instance->held[isBusiness] > 0) instance->held[isBusiness]--;
+        DatedFlights::releaseIfIdle(instance);
+        return;
+    }
+    Flight* flight = flightBST.find(num);
+    if (!flight) return;
+    int& held = isBusiness ? flight->heldBusinessSeats : flight->heldEconomySeats;
+    if (held > 0) held--;
+    flight->publish();
+}
+
+// Seats still free in the cabin, counting its overbooking limit when
+// overbook is set; date 0 is the undated inventory.
+int Flight::seatsLeft(bool businessClass, bool overbook, int date) const {
+    int left;
+    if (date) {
+        const DatedFlight* instance = DatedFlights::find(flightNo, date);
+        left = (businessClass ? businessSeats : economySeats)
+            - (instance ? instance->booked[businessClass] + instance->held[businessClass] : 0);
+    }
+    else {
+        left = businessClass ? getAvailableBusinessSeats() : getAvailableEconomySeats();
+    }
+    return overbook ? left + overbookLimit[businessClass] : left;
+}
+
+bool Flight::operatesOn(int date) const {
+    if (date <= 0 || !(operatingDays >> weekdayOf(date) & 1)) return false;
+    return (!firstDate || date >= firstDate) && (!lastDate || date <= lastDate);
+}
+
+int Flight::assignSeat(bool businessClass, int date) {
+    SeatMap* map = &seatMap;
+    if (date) {
+        DatedFlight* instance = DatedFlights::find(flightNo, date);
+        if (!instance) return 0;
+        map = &instance->seats;
+    }
+    return businessClass ? map->assign(1, businessSeats) : map->assign(businessSeats + 1, businessSeats + economySeats);
+}
+
+void Flight::claimSeat(int seat, int date) {
+    if (!date) {
+        seatMap.claim(seat);
+        return;
+    }
+    DatedFlight* instance = DatedFlights::find(flightNo, date);
+    if (instance) instance->seats.claim(seat);
+}
+
+bool Flight::seatFree(bool businessClass, int seat, int date) const {
+    int first = businessClass ? 1 : businessSeats + 1, last = businessClass ? businessSeats : businessSeats + economySeats;
+    if (seat < first || seat > last) return false;
+    if (!date) return !seatMap.isTaken(seat);
+    const DatedFlight* instance = DatedFlights::find(flightNo, date);
+    return !instance || !instance->seats.isTaken(seat);
+}
+
+void Flight::freeSeat(int seat, int date) {
+    if (!date) {
+        seatMap.release(seat);
+        return;
+    }
+    DatedFlight* instance = DatedFlights::find(flightNo, date);
+    if (instance) instance->seats.release(seat);
+}
+
+bool Flight::flightExists(int num) {
+    return flightBST.exists(num);
+}
+
+bool Flight::checkForSeats(int num) {
+    Flight* flight = flightBST.find(num);
+    return flight ? (flight->seats > flight->booked_seats + flight->heldBusinessSeats + flight->heldEconomySeats) : false;
+}
+
+void Flight::publish() {
+    if (!Snapshots::enabled) return;
+    FlightView v;
+    capture(v);
+    view.publish(v);
+}
+
+void Flight::capture(FlightView& v) const {
+    v.flightNo = flightNo;
+    v.cost = cost;
+    v.seats = seats;
+    v.bookedSeats = booked_seats;
+    v.businessSeats = businessSeats;
+    v.economySeats = economySeats;
+    v.bookedBusinessSeats = bookedBusinessSeats;
+    v.bookedEconomySeats = bookedEconomySeats;
+    v.heldBusinessSeats = heldBusinessSeats;
+    v.heldEconomySeats = heldEconomySeats;
+    v.from = from;
+    v.to = to;
+    v.planeType = plane_type;
+    v.weather = weather;
+    v.dayOfWeek = dayOfWeek;
+    v.leave = t_leave;
+    v.arrive = t_arrive;
+}
+
+void Customer::publish() {
+    if (!Snapshots::enabled) return;
+    CustomerView v;
+    capture(v);
+    view.publish(v);
+}
+
+void Customer::capture(CustomerView& v) const {
+    v.passport = passportNo;
+    v.name = name;
+    v.surname = surname;
+    v.nationality = nationality;
+    v.discount = discount;
+    v.totalSpent = totalSpent;
+    v.bookings = bookings;
+}
+
+void Snapshots::enable() {
+    enabled = true;
+    publishAll();
+}
+
+void Snapshots::publishAll() {
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+        node->data.publish();
+    }
+    for (Customer* customer : customerBST) customer->publish();
+}
+
+// Customer member functions implementation
+void Customer::applyDiscount() {
+    string choice;
+    cout << "\nAvailable Discounts:\n";
+    cout << "1. Student (15% discount)\n";
+    cout << "2. Senior Citizen (20% discount)\n";
+    cout << "3. Military (10% discount)\n";
+    cout << "4. Frequent Flyer (25% discount)\n";
+    cout << "5. No discount\n";
+    cout << "Enter your choice (1-5): ";
+
+    getline(cin, choice);
+    while (choice.empty() || choice[0] < '1' || choice[0] > '5') {
+        cout << "Invalid choice. Please enter a number between 1 and 5: ";
+        getline(cin, choice);
+    }
+
+    switch (choice[0]) {
+    case '1': discount = offers::STUDENT; break;
+    case '2': discount = offers::SENIOR; break;
+    case '3': discount = offers::MILITARY; break;
+    case '4': discount = offers::FREQUENT_FLYER; break;
+    case '5': discount = offers::NONE; break;
+    }
+}
+
+void Customer::inputCustomeralInfo() {
+    string temp;
+
+    // Name
+    do {
+        cout << "Name: ";
+        getline(cin, this->name);
+        if (this->name.length() > 20 || !checkString(this->name)) {
+            cout << "Please insert a valid Name (letters only, max 20 chars)!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Surname
+    do {
+        cout << "Surname: ";
+        getline(cin, this->surname);
+        if (this->surname.length() > 20 || !checkString(this->surname)) {
+            cout << "Please insert a valid Surname (letters only, max 20 chars)!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Passport number
+    do {
+        cout << "Passport number: ";
+        getline(cin, temp);
+        if (!checkNumber(temp) || !Customer::uniquePass(stoi(temp))) {
+            cout << "Please insert a valid and unique passport number!\n";
+            continue;
+        }
+        this->passportNo = stoi(temp);
+        break;
+    } while (true);
+
+    // Nationality
+    do {
+        cout << "Nationality: ";
+        getline(cin, this->nationality);
+        if (this->nationality.length() > 20 || !checkString(this->nationality)) {
+            cout << "Please insert a valid Nationality (letters only, max 20 chars)!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Address
+    do {
+        cout << "Address: ";
+        getline(cin, this->address);
+        if (this->address.empty()) {
+            cout << "Address cannot be empty!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Telephone
+    do {
+        cout << "Telephone: ";
+        getline(cin, temp);
+        if (!checkNumber(temp)) {
+            cout << "Please insert a valid telephone number!\n";
+            continue;
+        }
+        this->tel = stoi(temp);
+        break;
+    } while (true);
+
+    // Apply discount
+    applyDiscount();
+}
+
+// Stores a copy of a newly registered customer and returns the resident
+// record; later bookings mutate that record in place.
+Customer* Customer::registerRecord(const Customer& customer) {
+    Customer* record = new Customer(customer);
+    record->publish();
+    customerBST.insert(record->getPassport(), record);
+    customerNames.insert(record->getPassport(), record->getName(), record->getSurname());
+    return record;
+}
+
+//void Customer::book() {
+//    if (flist.empty()) {
+//        cout << "There are no available flights at the moment.\n";
+//        return;
+//    }
+//
+//    cin.clear();
+//    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+//
+//    string choice;
+//    cout << "Insert y (yes) for a new client or n (no) for an existing client: ";
+//    getline(cin, choice);
+//
+//    if (choice == "y" || choice == "Y") {
+//        cout << "Please provide your personal information.\n";
+//        inputCustomeralInfo();
+//    }
+//    else {
+//        string temp;
+//        cout << "Please provide your passport number: ";
+//        getline(cin, temp);
+//
+//        while (!checkNumber(temp)) {
+//            cout << "Please insert a valid passport number!\n";
+//            getline(cin, temp);
+//        }
+//
+//        int passport = stoi(temp);
+//        if (!Customer::uniquePass(passport)) {
+//            copyFromExisting(passport);
+//        }
+//        else {
+//            cout << "Wrong passport number!\n";
+//            return;
+//        }
+//    }
+//
+//    Flight::displaySchedule();
+//
+//    string temp;
+//    int num;
+//    do {
+//        cout << "\n\nEnter the number of the flight you're interested in: ";
+//        getline(cin, temp);
+//
+//        if (!checkNumber(temp) || !Flight::flightExists(stoi(temp))) {
+//            cout << "Please insert a valid Flight No!\n";
+//            continue;
+//        }
+//        num = stoi(temp);
+//        break;
+//    } while (true);
+//
+//    Flight* flight = flightBST.find(num);
+//    if (!flight) {
+//        cout << "Flight not found!\n";
+//        return;
+//    }
+//
+//    // Select class
+//    string seatClass;
+//    bool businessClass = false;
+//    int availableSeats = 0;
+//    int priceMultiplier = 1;
+//
+//    do {
+//        cout << "\nSelect class:\n";
+//        cout << "1. Business Class (2x price, " << flight->getAvailableBusinessSeats() << " available)\n";
+//        cout << "2. Economy Class (" << flight->getAvailableEconomySeats() << " available)\n";
+//        cout << "Enter your choice (1-2): ";
+//        getline(cin, seatClass);
+//
+//        if (seatClass == "1") {
+//            businessClass = true;
+//            availableSeats = flight->getAvailableBusinessSeats();
+//            priceMultiplier = 2;
+//            if (availableSeats <= 0) {
+//                cout << "No available business class seats!\n";
+//                continue;
+//            }
+//        }
+//        else if (seatClass == "2") {
+//            businessClass = false;
+//            availableSeats = flight->getAvailableEconomySeats();
+//            priceMultiplier = 1;
+//            if (availableSeats <= 0) {
+//                cout << "No available economy class seats!\n";
+//                continue;
+//            }
+//        }
+//        else {
+//            cout << "Invalid choice!\n";
+//            continue;
+//        }
+//        break;
+//    } while (true);
+//
+//    if (availableSeats > 0) {
+//        float discountRate = getDiscountRate();
+//        int originalPrice = flight->getCost() * priceMultiplier;
+//        int discountedPrice = originalPrice * (1 - discountRate);
+//
+//        cout << "\nFlight Details:\n";
+//        cout << "From: " << flight->getDeparture() << " To: " << flight->getDestination() << "\n";
+//        cout << "Class: " << (businessClass ? "Business" : "Economy") << "\n";
+//        cout << "Departure: " << flight->getLeavingTime().hour << ":"
+//            << (flight->getLeavingTime().min < 10 ? "0" : "") << flight->getLeavingTime().min << "\n";
+//        cout << "Original Price: $" << originalPrice << "\n";
+//
+//        if (discountRate > 0) {
+//            cout << "Discount Applied: " << (discountRate * 100) << "%\n";
+//            cout << "Discounted Price: $" << discountedPrice << "\n";
+//        }
+//
+//        cout << "\nConfirm booking? (y/n): ";
+//        getline(cin, choice);
+//
+//        if (choice == "y" || choice == "Y") {
+//            flights.push_back(num);
+//
+//            // Update the correct seat count
+//            Flight::resSeat(num, 1, businessClass);
+//
+//            totalSpent += discountedPrice;
+//
+//            // Add to BST
+//            Customer* newCustomer = new Customer(*this);
+//            customerBST.insert(newCustomer->getPassport(), newCustomer);
+//
+//            // Save to file
+//            Customer::saveToFile();
+//            Flight::saveToFile();
+//
+//            cout << "Your " << (businessClass ? "Business" : "Economy")
+//                << " class flight with No: " << num << " was successfully booked.\n";
+//            cout << "Total amount paid: $" << discountedPrice << "\n";
+//        }
+//        else {
+//            cout << "Booking cancelled.\n";
+//        }
+//    }
+//    else {
+//        cout << "\nThis flight class is fully booked. You can be added to the waiting queue.\n";
+//        cout << "Would you like to join the waiting queue? (y/n): ";
+//        getline(cin, choice);
+//
+//        if (choice == "y" || choice == "Y") {
+//            // Find or create queue for this flight
+//            Queue* flightQueue = nullptr;
+//            for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+//                if (num == qnode->data.getNo()) {
+//                    flightQueue = &qnode->data;
+//                    break;
+//                }
+//            }
+//
+//            if (!flightQueue) {
+//                // Create new queue if it doesn't exist
+//                Queue newQueue(num);
+//                qlist.push_back(newQueue);
+//                flightQueue = &qlist.getTail()->data;
+//            }
+//
+//            // Add customer to queue
+//            flightQueue->enqueue(*this);
+//            int queuePosition = flightQueue->getSize();
+//
+//            // Add to BST
+//            Customer* newCustomer = new Customer(*this);
+//            customerBST.insert(newCustomer->getPassport(), newCustomer);
+//
+//            // Save to file
+//            Customer::saveToFile();
+//            Queue::saveToFile();
+//
+//            cout << "\nYou have been added to the waiting queue for Flight " << num << ".\n";
+//            cout << "Your position in queue: " << queuePosition << endl;
+//            cout << "You will be automatically notified if a seat becomes available.\n";
+//
+//            // Check if we can immediately allocate a seat (in case of race condition)
+//            if (flight->getAvailableSeats() > 0) {
+//                cout << "\nSeat became available! Processing your booking...\n";
+//                manageQueue(num);
+//            }
+//        }
+//        else {
+//            cout << "You were not added to the waiting queue.\n";
+//        }
+//    }
+//}
+void Customer::book() {
+    FRS_TIMED(OP_BOOK);
+    if (flist.empty()) {
+        cout << "There are no available flights at the moment.\n";
+        return;
+    }
+
+    cin.clear();
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+    string choice;
+    cout << "Insert y (yes) for a new client or n (no) for an existing client: ";
+    getline(cin, choice);
+
+    // Resident record of a returning customer, updated in place. A new
+    // customer is only registered once they book or join a queue.
+    Customer* record = nullptr;
+
+    if (choice == "y" || choice == "Y") {
+        cout << "Please provide your personal information.\n";
+        inputCustomeralInfo();
+    }
+    else {
+        string temp;
+        cout << "Please provide your passport number: ";
+        getline(cin, temp);
+
+        while (!checkNumber(temp)) {
+            cout << "Please insert a valid passport number!\n";
+            getline(cin, temp);
+        }
+
+        record = customerBST.find(stoi(temp));
+        if (!record) {
+            cout << "Wrong passport number!\n";
+            return;
+        }
+    }
+    const Customer& customer = record ? *record : *this;
+
+    Flight::displaySchedule();
+
+    string temp;
+    int num;
+    do {
+        cout << "\n\nEnter the number of the flight you're interested in: ";
+        getline(cin, temp);
+
+        if (!checkNumber(temp) || !Flight::flightExists(stoi(temp))) {
+            cout << "Please insert a valid Flight No!\n";
+            continue;
+        }
+        num = stoi(temp);
+        break;
+    } while (true);
+
+    Flight* flight = flightBST.find(num);
+    if (!flight) {
+        cout << "Flight not found!\n";
+        return;
+    }
+
+    // Check if any seats are available at all, counting accepted overbooking
+    if (flight->getBookableSeats(true) <= 0 && flight->getBookableSeats(false) <= 0) {
+        cout << "\nThis flight is fully booked (both business and economy classes).\n";
+        cout << "Would you like to join the waiting queue? (y/n): ";
+        getline(cin, choice);
+
+        if (choice == "y" || choice == "Y") {
+            // Find or create queue for this flight
+            Queue* flightQueue = Queue::forFlight(num, true);
+
+            // Add customer to queue
+            flightQueue->enqueue(customer);
+            int queuePosition = flightQueue->getSize();
+
+            if (!record) {
+                Customer::registerRecord(*this);
+            }
+
+            // Save to file
+            Customer::saveToFile();
+            Queue::saveToFile();
+
+            cout << "\nYou have been added to the waiting queue for Flight " << num << ".\n";
+            cout << "Your position in queue: " << queuePosition << endl;
+            cout << "You will be automatically notified if a seat becomes available.\n";
+        }
+        else {
+            cout << "You were not added to the waiting queue.\n";
+        }
+        return;
+    }
+
+    // Rest of the booking logic for when seats are available...
+    // (Existing code for seat selection and booking)
+
+    // Select class
+    string seatClass;
+    bool businessClass = false;
+    int availableSeats = 0;
+
+    do {
+        cout << "\nSelect class:\n";
+        cout << "1. Business Class (2x price, " << flight->getAvailableBusinessSeats() << " available"
+            << (flight->getAvailableBusinessSeats() <= 0 && flight->getBookableSeats(true) > 0 ? ", overbooking open" : "") << ")\n";
+        cout << "2. Economy Class (" << flight->getAvailableEconomySeats() << " available"
+            << (flight->getAvailableEconomySeats() <= 0 && flight->getBookableSeats(false) > 0 ? ", overbooking open" : "") << ")\n";
+        cout << "Enter your choice (1-2): ";
+        getline(cin, seatClass);
+
+        if (seatClass == "1") {
+            businessClass = true;
+            availableSeats = flight->getBookableSeats(true);
+            if (availableSeats <= 0) {
+                cout << "No available business class seats!\n";
+                continue;
+            }
+        }
+        else if (seatClass == "2") {
+            businessClass = false;
+            availableSeats = flight->getBookableSeats(false);
+            if (availableSeats <= 0) {
+                cout << "No available economy class seats!\n";
+                continue;
+            }
+        }
+        else {
+            cout << "Invalid choice!\n";
+            continue;
+        }
+        break;
+    } while (true);
+
+    if (availableSeats > 0) {
+        int discountPercent = customer.getDiscountPercent();
+        Money originalPrice = flight->fare(businessClass, offers::NONE);
+        Money discountedPrice = customer.quote(flight, businessClass);
+
+        cout << "\nFlight Details:\n";
+        cout << "From: " << flight->getDeparture() << " To: " << flight->getDestination() << "\n";
+        cout << "Class: " << (businessClass ? "Business" : "Economy") << "\n";
+        cout << "Departure: " << flight->getLeavingTime().hour << ":"
+            << (flight->getLeavingTime().min < 10 ? "0" : "") << flight->getLeavingTime().min << "\n";
+        cout << "Original Price: $" << originalPrice << "\n";
+
+        if (discountPercent > 0) {
+            cout << "Discount Applied: " << discountPercent << "%\n";
+            cout << "Discounted Price: $" << discountedPrice << "\n";
+        }
+
+        bool overbook = (businessClass ? flight->getAvailableBusinessSeats() : flight->getAvailableEconomySeats()) <= 0;
+        if (overbook) {
+            cout << "This class is full; the booking is accepted as an overbooked seat.\n";
+        }
+
+        long long holdId = SeatHolds::place(num, customer.getPassport(), businessClass, discountedPrice, overbook);
+        if (holdId < 0) {
+            cout << "Sorry, the last seat in this class was just taken.\n";
+            return;
+        }
+        cout << "Your seat is held for " << (SeatHolds::getTtlMs() + 999) / 1000 << " seconds.\n";
+
+        cout << "\nConfirm booking? (y/n): ";
+        getline(cin, choice);
+
+        if (choice == "y" || choice == "Y") {
+            SeatHolds::Hold hold;
+            if (!SeatHolds::take(holdId, hold)) {
+                cout << "Your seat hold expired; please start the booking again.\n";
+                return;
+            }
+            if (!record) {
+                record = Customer::registerRecord(*this);
+            }
+            record->confirmBooking(num, businessClass, hold.price);
+
+            // Save to file
+            Customer::saveToFile();
+            Flight::saveToFile();
+
+            cout << "Your " << (businessClass ? "Business" : "Economy")
+                << " class flight with No: " << num << " was successfully booked.\n";
+            cout << "Total amount paid: $" << hold.price << "\n";
+        }
+        else {
+            SeatHolds::release(holdId);
+            cout << "Booking cancelled.\n";
+        }
+    }
+}
+// Price of one seat on the flight after this customer's discount.
+Money Customer::quote(const Flight* flight, bool businessClass, int date) const {
+    Money fare = flight->fare(businessClass, discount);
+    return date ? PricingEngine::priceForDeparture(fare, date - today()) : fare;
+}
+
+// Records a confirmed booking: adds the flight, takes the seat and charges
+// the customer. Shared by the console flow, the server and the benchmarks;
+// like the other booking cores it only updates memory and leaves saving
+// to the caller.
+void Customer::confirmBooking(int num, bool businessClass, Money price, int date) {
+    // Update the correct seat count
+    Flight::resSeat(num, 1, businessClass, date);
+
+    Booking booking;
+    booking.fare = price;
+    booking.bookedAt = time(nullptr);
+    booking.flightNo = num;
+    booking.date = date;
+    booking.businessClass = businessClass;
+    Flight* flight = flightBST.find(num);
+    booking.seat = static_cast<unsigned short>(flight ? flight->assignSeat(businessClass, date) : 0);
+    bookings.push_back(booking);
+
+    totalSpent += price;
+    publish();
+}
+
+bool Customer::hasFlight(int num, int date) const {
+    for (const Booking& booking : bookings) {
+        if (booking.flightNo == num && booking.date == date) return true;
+    }
+    return false;
+}
+
+// Used when the flight itself goes away, so its seats are not handed back.
+// Bookings without a recorded fare are refunded at the undiscounted fare.
+int Customer::removeFlight(int num, Money& refund) {
+    int removed = 0;
+    Flight* flight = flightBST.find(num);
+    for (int i = 0; i < bookings.getSize();) {
+        const Booking& booking = bookings[i];
+        if (booking.flightNo != num) {
+            i++;
+            continue;
+        }
+        if (booking.fare.getCents() >= 0) refund += booking.fare;
+        else if (flight) refund += flight->fare(booking.businessClass, offers::NONE);
+        bookings.erase(i);
+        removed++;
+    }
+    return removed;
+}
+
+// Removes one booking of flightNum from the stored customer, refunds what
+// was paid for it and either drops the customer from that flight's queue or
+// frees the seat for the next waiting customer. Returns false if there was
+// no such booking.
+bool Customer::cancelBooking(int passport, int flightNum, Money& refundAmount, int date) {
+    refundAmount = Money();
+    Customer* customer = customerBST.find(passport);
+    if (!customer) return false;
+
+    // The latest booking of the flight (on that date) is the one cancelled
+    int index = customer->bookings.getSize() - 1;
+    while (index >= 0 && (customer->bookings[index].flightNo != flightNum || customer->bookings[index].date != date)) {
+        index--;
+    }
+    if (index < 0) return false;
+
+    Booking booking = customer->bookings[index];
+    customer->bookings.erase(index);
+    Flight* flight = flightBST.find(flightNum);
+    if (booking.fare.getCents() >= 0) {
+        refundAmount = booking.fare;
+    }
+    else if (flight) {
+        refundAmount = customer->quote(flight, booking.businessClass);
+    }
+    customer->setTotalSpent(customer->getTotalSpent() - refundAmount);
+
+    // Waitlists are for the undated flight
+    if (date) {
+        if (flight) flight->freeSeat(booking.seat, date);
+        Flight::resSeat(flightNum, -1, booking.businessClass, date);
+        return true;
+    }
+
+    // Check if Customer is in any queue
+    bool isInQueue = false;
+    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+        if (flightNum == qnode->data.getNo() && !qnode->data.isEmpty()) {
+            QueueNode* current = qnode->data.getFront();
+
+            while (current) {
+                if (passport == current->Customer.getPassport()) {
+                    isInQueue = true;
+                    qnode->data.remove(current);
+                    break;
+                }
+                current = current->next;
+            }
+        }
+    }
+
+    if (!isInQueue) {
+        if (flight) flight->freeSeat(booking.seat);
+        Flight::resSeat(flightNum, -1, booking.businessClass);
+        customer->bookFromQueue(flightNum);
+    }
+    return true;
+}
+
+void Customer::bookFromQueue(int num) {
+    Customer queueFront;
+    bool found = false;
+
+    // Find the oldest customer in the queue
+    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+        if (num == qnode->data.getNo() && !qnode->data.isEmpty()) {
+            queueFront = qnode->data.oldest();
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) return;
+
+    // Seats from the queue are economy. Hold one on every flight first, so
+    // the promotion happens whole or not at all and never books past the
+    // cabin's seats (a freed business seat leaves a full economy full).
+    int held = 0;
+    while (held < queueFront.bookings.getSize() && Flight::holdSeat(queueFront.bookings[held].flightNo, false, false)) {
+        held++;
+    }
+    bool allAvailable = held == queueFront.bookings.getSize();
+    if (!allAvailable) {
+        for (int i = 0; i < held; i++) Flight::releaseSeat(queueFront.bookings[i].flightNo, false);
+    }
+    else {
+        // Remove from queues and book flights, each into its held seat
+        for (const Booking& booking : queueFront.bookings) {
+            Flight::releaseSeat(booking.flightNo, false);
+            for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+                if (booking.flightNo == qnode->data.getNo()) {
+                    QueueNode* qfront = qnode->data.getFront();
+                    while (qfront) {
+                        if (queueFront.passportNo == qfront->Customer.passportNo) {
+                            qnode->data.dequeue();
+
+                            // Apply discount
+                            Flight* flight = flightBST.find(booking.flightNo);
+                            Customer* customer = customerBST.find(queueFront.passportNo);
+                            if (flight && customer) {
+                                customer->confirmBooking(booking.flightNo, false, queueFront.quote(flight, false));
+                            }
+                            else {
+                                Flight::resSeat(booking.flightNo, 1, false);
+                            }
+                            break;
+                        }
+                        qfront = qfront->next;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void Customer::cancel() {
+    FRS_TIMED(OP_CANCEL);
+    if (customerBST.empty()) {
+        cout << "There are no registered clients at the moment!\n";
+        return;
+    }
+
+    cin.clear();
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+    string passportStr, flightStr;
+    int passport, flightNum, date;
+    int counter = 1;
+
+    // Get passport number
+    do {
+        cout << "Please provide your passport number: ";
+        getline(cin, passportStr);
+
+        if (!checkNumber(passportStr)) {
+            cout << "Please insert a valid passport number!\n";
+            continue;
+        }
+
+        passport = stoi(passportStr);
+        if (!Customer::displayCustomerInfo(passport)) {
+            if (counter == 5) {
+                cout << "Wrong passport number was given too many times.\n";
+                return;
+            }
+            cout << "Please check your Passport Number.\n";
+            counter++;
+            continue;
+        }
+        break;
+    } while (true);
+
+    // Get flight number to cancel
+    counter = 1;
+    bool flightFound = false;
+    do {
+        cout << "\nWhich flight do you want to cancel (enter the flight number, or number@YYYY-MM-DD for a dated one)? ";
+        getline(cin, flightStr);
+
+        if (!parseFlightRef(flightStr, flightNum, date)) {
+            cout << "Please insert a valid flight number!\n";
+            continue;
+        }
+
+        // Find the flight in Customer's flights
+        Customer* customer = customerBST.find(passport);
+        flightFound = customer && customer->hasFlight(flightNum, date);
+
+        if (counter == 5 && !flightFound) {
+            cout << "Wrong flight number was given too many times.\n";
+            return;
+        }
+        else if (!flightFound) {
+            cout << "Please check your flight number!.\n";
+            counter++;
+            continue;
+        }
+        break;
+    } while (true);
+
+    Money refundAmount;
+    Customer::cancelBooking(passport, flightNum, refundAmount, date);
+    if (Flight::flightExists(flightNum)) {
+        cout << "Refund amount: $" << refundAmount << "\n";
+    }
+
+    // Save changes to files
+    Flight::saveToFile();
+    Customer::saveToFile();
+    Queue::saveToFile();
+
+    cout << "\nYour reservation was successfully removed!\n\n";
+}
+
+bool Customer::displayCustomerInfo(int passport) {
+    Customer* customer = customerBST.find(passport);
+    if (customer) {
+        cout << "\n\t\t\t\t CustomerAL INFO\n\n";
+        cout << left << setw(15) << "NAME" << left << setw(15) << "SURNAME" << left << setw(15) << "PASSPORT_No"
+            << left << setw(15) << "NATIONALITY" << left << setw(15) << "ADDRESS" << left << setw(15) << "TELEPHONE"
+            << left << setw(20) << "DISCOUNT" << left << setw(15) << "TOTAL SPENT" << endl;
+
+        string discountStr;
+        switch (customer->discount) {
+        case offers::STUDENT: discountStr = "Student (15%)"; break;
+        case offers::SENIOR: discountStr = "Senior (20%)"; break;
+        case offers::MILITARY: discountStr = "Military (10%)"; break;
+        case offers::FREQUENT_FLYER: discountStr = "Frequent Flyer (25%)"; break;
+        case offers::NONE: discountStr = "None"; break;
+        }
+
+        cout << left << setw(15) << customer->name << left << setw(15) << customer->surname
+            << left << setw(15) << customer->passportNo << left << setw(15) << customer->nationality
+            << left << setw(15) << customer->address << left << setw(15) << customer->tel
+            << left << setw(20) << discountStr << left << setw(15) << "$" + customer->totalSpent.str() << endl << endl;
+
+        cout << "Your flight(s): ";
+        for (const Booking& booking : customer->bookings) {
+            cout << booking.flightNo << " (";
+            if (booking.date) cout << formatDate(booking.date) << ", ";
+            cout << (booking.businessClass ? "Business" : "Economy");
+            if (booking.seat) cout << ", seat " << booking.seat;
+            if (booking.fare.getCents() >= 0) cout << ", $" << booking.fare;
+            cout << ")  ";
+        }
+        cout << endl;
+        return true;
+    }
+    cout << "Passport number was not found. Check again!\n";
+    return false;
+}
+
+void Customer::displaySearch(const string& query) {
+    const int LIMIT = 10;
+    NameIndex::Match matches[LIMIT];
+    int found = customerNames.search(query, matches, LIMIT);
+    if (found == 0) {
+        cout << "No customer matches '" << query << "'.\n";
+        return;
+    }
+
+    cout << left << setw(15) << "PASSPORT_No" << left << setw(15) << "NAME" << left << setw(15) << "SURNAME"
+        << left << setw(15) << "NATIONALITY" << "MATCH" << endl;
+    for (int i = 0; i < found; i++) {
+        const Customer* customer = customerBST.find(matches[i].passport);
+        if (!customer) continue;
+        cout << left << setw(15) << customer->passportNo << left << setw(15) << customer->name
+            << left << setw(15) << customer->surname << left << setw(15) << customer->nationality
+            << (matches[i].distance == 0 ? "exact" : to_string(matches[i].distance) + " edit(s)") << endl;
+    }
+}
+
+bool Customer::uniquePass(int passport) {
+    return !customerBST.exists(passport);
+}
+
+void Queue::enqueue(const Customer& p, time_t joined) {
+    link(p, joined);
+    depthChanged();
+}
+
+void Queue::link(const Customer& p, time_t joined) {
+    QueueNode* newNode = new QueueNode();
+    newNode->level = newNode->slot = -1;
+    newNode->Customer = p;
+    newNode->next = nullptr;
+    newNode->prev = rear;
+    newNode->owner = this;
+    newNode->joinTime = joined;
+    newNode->aged = WaitlistAging::isAged(joined, time(nullptr));
+    size++;
+    if (newNode->aged) aged++;
+
+    if (!rear) {
+        front = rear = newNode;
+    }
+    else {
+        rear->next = newNode;
+        rear = newNode;
+    }
+    WaitlistAging::track(newNode);
+}
+
+void Queue::dequeue() {
+    if (front) remove(front);
+}
+
+// Unlinks and frees any entry of this queue in O(1).
+void Queue::remove(QueueNode* node) {
+    if (node->prev) node->prev->next = node->next;
+    else front = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else rear = node->prev;
+
+    size--;  // Maintain size
+    if (node->aged) aged--;
+    WaitlistAging::untrack(node);
+    delete node;
+    depthChanged();
+}
+
+void Queue::markAged(QueueNode* node) {
+    if (node->aged) return;
+    node->aged = true;
+    aged++;
+    depthChanged();
+}
+
+void Queue::clear() {
+    freeNodes();
+    depthChanged();
+}
+
+// Releases the nodes without repricing; the destructor runs during global
+// teardown, after the flight index may be gone.
+void Queue::freeNodes() {
+    while (front) {
+        QueueNode* temp = front;
+        front = front->next;
+        WaitlistAging::untrack(temp);
+        delete temp;
+    }
+    rear = nullptr;
+    size = 0;
+    aged = 0;
+}
+
+unsigned long long WaitlistAging::tickAt(time_t when) {
+    return when > 0 ? static_cast<unsigned long long>(when) / TICK_SECONDS : 0;
+}
+
+void WaitlistAging::track(QueueNode* node) {
+    time_t due;
+    if (!node->aged && ageSeconds > 0 && (expireSeconds == 0 || ageSeconds < expireSeconds)) {
+        due = node->joinTime + ageSeconds;
+    }
+    else if (expireSeconds > 0) {
+        due = node->joinTime + expireSeconds;
+    }
+    else {
+        return;
+    }
+
+    // An empty wheel jumps straight to the present without expiring anything
+    if (wheel.size() == 0) wheel.advance(tickAt(time(nullptr)), onExpire, nullptr);
+    wheel.schedule(node, tickAt(due) + 1);  // round up to a whole tick
+}
+
+int WaitlistAging::expire() {
+    int removed = 0;
+    wheel.advance(tickAt(time(nullptr)), onExpire, &removed);
+    return removed;
+}
+
+void WaitlistAging::onExpire(TimerNode* timer, void* context) {
+    QueueNode* node = static_cast<QueueNode*>(timer);
+    if (!isExpired(node->joinTime, time(nullptr)) && !node->aged) {
+        node->owner->markAged(node);
+        track(node);  // now waits for expiry, if that is on
+        return;
+    }
+    if (context) ++*static_cast<int*>(context);
+    node->owner->remove(node);
+}
+
+// Queue of the given flight; optionally creates an empty one when missing.
+Queue* Queue::forFlight(int num, bool create) {
+    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+        if (num == qnode->data.getNo()) {
+            return &qnode->data;
+        }
+    }
+    if (!create) return nullptr;
+
+    return &qlist.emplace_back(num);
+}
+
+Customer Queue::oldest() const {
+    if (front) {
+        return front->Customer;
+    }
+    throw runtime_error("Queue is empty");
+}
+
+int Queue::getPosition(int passport) const {
+    int position = 1;
+    QueueNode* current = front;
+    while (current) {
+        if (current->Customer.getPassport() == passport) {
+            return position;
+        }
+        current = current->next;
+        position++;
+    }
+    return -1; // Not found
+}
+
+void Queue::display(int num) {
+    for (ListNode<Queue>* node = qlist.begin(); node != qlist.end(); node = node->next) {
+        if (num == node->data.getNo()) {
+            QueueNode* current = node->data.getFront();
+
+            if (!current) {
+                cout << "\nEmpty queue.\n";
+            }
+            else {
+                cout << "\nPassengers waiting in queue:\n";
+                cout << left << setw(15) << "Passport" << left << setw(15) << "Name" << left << setw(15) << "Surname"
+                    << left << setw(20) << "Discount" << left << setw(15) << "Wait Time" << endl;
+
+                while (current) {
+                    string discountStr;
+                    switch (current->Customer.getDiscount()) {
+                    case offers::STUDENT: discountStr = "Student (15%)"; break;
+                    case offers::SENIOR: discountStr = "Senior (20%)"; break;
+                    case offers::MILITARY: discountStr = "Military (10%)"; break;
+                    case offers::FREQUENT_FLYER: discountStr = "Frequent Flyer (25%)"; break;
+                    case offers::NONE: discountStr = "None"; break;
+                    }
+
+                    cout << left << setw(15) << current->Customer.getPassport()
+                        << left << setw(15) << current->Customer.getName()
+                        << left << setw(15) << current->Customer.getSurname()
+                        << left << setw(20) << discountStr
+                        << left << setw(15) << difftime(time(nullptr), current->joinTime) / 60 << " mins"
+                        << (current->aged ? " (aged)" : "") << endl;
+                    current = current->next;
+                }
+            }
+            return;
+        }
+    }
+}
+
+void Flight::updateFlight(int flightNo) {
+    string temp;
+    Flight* flight = flightBST.find(flightNo);
+
+    if (!flight) {
+        cout << "Flight with number " << flightNo << " does not exist!\n";
+        return;
+    }
+
+    cout << "Update flight with the following attributes (leave blank to keep current value):\n";
+    cin.clear();
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+    // Departure
+    do {
+        cout << "Current Departure: " << flight->from << "\n";
+        cout << "Departure: ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (temp.length() > 20 || !checkString(temp)) {
+                cout << "Please insert a valid Departure city!\n";
+                continue;
+            }
+            flight->from = temp;
+        }
+        break;
+    } while (true);
+
+    // Destination
+    do {
+        cout << "Current Destination: " << flight->to << "\n";
+        cout << "Destination: ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (temp.length() > 20 || !checkString(temp) || temp == flight->from) {
+                cout << "Please insert a valid Destination city!\n";
+                continue;
+            }
+            flight->to = temp;
+        }
+        break;
+    } while (true);
+
+    // Boarding time
+    do {
+        cout << "Current Boarding time: "
+            << setw(2) << setfill('0') << flight->t_leave.hour << ":"
+            << setw(2) << setfill('0') << flight->t_leave.min << "\n";
+        cout << "Boarding time (e.g. 19:40): ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (!checkTime(temp)) {
+                cout << "Please insert a valid boarding time (e.g. 19:40)!\n";
+                continue;
+            }
+
+            size_t colon = temp.find(':');
+            Time newTime;
+            newTime.hour = stoi(temp.substr(0, colon));
+            newTime.min = stoi(temp.substr(colon + 1));
+
+            if (sameTime(newTime, flight->t_arrive)) {
+                cout << "Boarding time must differ from arrival time!\n";
+                continue;
+            }
+            flight->t_leave = newTime;
+        }
+        break;
+    } while (true);
+
+    // Arrival time
+    do {
+        cout << "Current Arriving time: "
+            << setw(2) << setfill('0') << flight->t_arrive.hour << ":"
+            << setw(2) << setfill('0') << flight->t_arrive.min << "\n";
+        cout << "Arriving time (e.g. 21:40): ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (!checkTime(temp)) {
+                cout << "Please insert a valid arriving time (e.g. 21:40)!\n";
+                continue;
+            }
+
+            size_t colon = temp.find(':');
+            Time newTime;
+            newTime.hour = stoi(temp.substr(0, colon));
+            newTime.min = stoi(temp.substr(colon + 1));
+
+            if (sameTime(flight->t_leave, newTime)) {
+                cout << "Arrival time must differ from departure time!\n";
+                continue;
+            }
+            flight->t_arrive = newTime;
+        }
+        break;
+    } while (true);
+
+    // Ticket price
+    do {
+        cout << "Current Ticket price: " << flight->cost << "\n";
+        cout << "Ticket price: ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (!checkNumber(temp)) {
+                cout << "Please insert a valid ticket price!\n";
+                continue;
+            }
+            flight->cost = stoi(temp);
+        }
+        break;
+    } while (true);
+
+    // Aeroplane type
+    do {
+        cout << "Current Aeroplane type: " << flight->plane_type << "\n";
+        cout << "Aeroplane type: ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (temp.empty()) {
+                cout << "Please insert a valid Aeroplane type!\n";
+                continue;
+            }
+            flight->plane_type = temp;
+        }
+        break;
+    } while (true);
+
+    // Number of seats
+    do {
+        cout << "Current Total number of seats: " << flight->seats << "\n";
+        cout << "Total number of seats: ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (!checkNumber(temp)) {
+                cout << "Please insert a valid number of seats!\n";
+                continue;
+            }
+            int newSeats = stoi(temp);
+            if (newSeats < flight->booked_seats) {
+                cout << "Cannot have fewer seats than currently booked (" << flight->booked_seats << ")!\n";
+                continue;
+            }
+            flight->seats = newSeats;
+        }
+        break;
+    } while (true);
+
+    // Business class seats
+    do {
+        cout << "Current Business class seats: " << flight->businessSeats << "\n";
+        cout << "Business class seats: ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (!checkNumber(temp) || stoi(temp) > flight->seats) {
+                cout << "Please insert a valid number of business class seats!\n";
+                continue;
+            }
+            flight->businessSeats = stoi(temp);
+            flight->economySeats = flight->seats - flight->businessSeats;
+        }
+        break;
+    } while (true);
+
+    // Number of booked business seats
+    do {
+        cout << "Current Booked business class seats: " << flight->bookedBusinessSeats << "\n";
+        cout << "Booked business class seats: ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (!checkNumber(temp) || stoi(temp) > flight->businessSeats) {
+                cout << "Please insert a valid number of booked business class seats!\n";
+                continue;
+            }
+            flight->bookedBusinessSeats = stoi(temp);
+        }
+        break;
+    } while (true);
+
+    // Number of booked economy seats
+    do {
+        cout << "Current Booked economy class seats: " << flight->bookedEconomySeats << "\n";
+        cout << "Booked economy class seats: ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (!checkNumber(temp) || stoi(temp) > flight->economySeats) {
+                cout << "Please insert a valid number of booked economy class seats!\n";
+                continue;
+            }
+            flight->bookedEconomySeats = stoi(temp);
+        }
+        flight->booked_seats = flight->bookedBusinessSeats + flight->bookedEconomySeats;
+        break;
+    } while (true);
+
+    // Weather condition
+    do {
+        cout << "Current Weather condition: " << flight->weather << "\n";
+        cout << "Weather condition (e.g., Sunny, Rainy, Cloudy, etc.): ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (temp.empty()) {
+                cout << "Please enter a valid weather condition!\n";
+                continue;
+            }
+            flight->weather = temp;
+        }
+        break;
+    } while (true);
+
+    // Day of week
+    do {
+        cout << "Current Day of week: " << flight->dayOfWeek << "\n";
+        cout << "Day of week (e.g., Monday, Tuesday, etc.): ";
+        getline(cin, temp);
+
+        if (!temp.empty()) {
+            if (temp.empty()) {
+                cout << "Please enter a valid day of week!\n";
+                continue;
+            }
+            flight->setDayOfWeek(temp);
+        }
+        break;
+    } while (true);
+
+    flight->buildFares();
+    flight->invalidateRow();
+
+    // Save to file
+    Flight::saveToFile();
+    cout << "Flight No: " << flightNo << " was successfully updated!\n";
+}
+
+// ---------------------------------------------------------------------------
+// Batch flight updates
+//
+// Weather and schedule changes for many flights at once, as lines of
+// "<flight> field=value ..." with the fields weather, leave, arrive and cost.
+// The whole batch is validated before anything is written, so a bad line
+// leaves every flight as it was; callers persist once afterwards.
+// ---------------------------------------------------------------------------
+
+// One flight's part of a batch; fields not given keep their current value.
+struct FlightChange {
+    int flightNo;
+    string weather;       // empty keeps the weather
+    Time leave, arrive;
+    bool setLeave, setArrive;
+    int cost;             // negative keeps the price
+};
+
+bool parseChangeTime(const string& value, Time& t) {
+    if (!checkTime(value)) return false;
+    t.hour = stoi(value.substr(0, 2));
+    t.min = stoi(value.substr(3, 2));
+    return true;
+}
+
+bool parseFlightChange(const string& text, FlightChange& change, string& error) {
+    istringstream fields(text);
+    string token;
+    change = FlightChange();
+    change.cost = -1;
+    if (!(fields >> token) || !checkNumber(token) || token.size() > 9) {
+        error = "expected a flight number";
+        return false;
+    }
+    change.flightNo = stoi(token);
+
+    int given = 0;
+    bool more = static_cast<bool>(fields >> token);
+    while (more) {
+        size_t eq = token.find('=');
+        string field = token.substr(0, eq), value = eq == string::npos ? "" : token.substr(eq + 1);
+        // A value runs up to the next field, so "weather=Light rain" keeps both words
+        string word;
+        while ((more = static_cast<bool>(fields >> word)) && word.find('=') == string::npos) {
+            value += value.empty() ? word : " " + word;
+        }
+        token = word;
+        bool valid;
+        if (field == "weather") {
+            valid = checkString(value) && value.length() <= 20;
+            change.weather = value;
+        }
+        else if (field == "leave") {
+            valid = change.setLeave = parseChangeTime(value, change.leave);
+        }
+        else if (field == "arrive") {
+            valid = change.setArrive = parseChangeTime(value, change.arrive);
+        }
+        else if (field == "cost") {
+            valid = checkNumber(value) && value.size() <= 9;
+            if (valid) change.cost = stoi(value);
+        }
+        else {
+            error = "unknown field " + field;
+            return false;
+        }
+        if (!valid) {
+            error = "invalid " + field + " for flight " + to_string(change.flightNo);
+            return false;
+        }
+        given++;
+    }
+    if (!given) {
+        error = "no changes for flight " + to_string(change.flightNo);
+        return false;
+    }
+    return true;
+}
+
+int Flight::applyChanges(const FlightChange* changes, int n, string& error) {
+    FRS_TIMED(OP_UPDATE_FLIGHTS);
+    // Times each flight will have once the changes up to i are applied; a
+    // flight listed twice starts from its earlier change. Sorting the batch
+    // by flight number (a stable sort, so repeats keep their order) pairs
+    // each change with the one before it for the same flight.
+    Flight** targets = new Flight*[n > 0 ? n : 1];
+    Time* leaves = new Time[n > 0 ? n : 1];
+    Time* arrives = new Time[n > 0 ? n : 1];
+    int* earlier = new int[n > 0 ? n : 1];
+    unsigned long long* entries = new unsigned long long[n > 0 ? n : 1];
+    for (int i = 0; i < n; i++) entries[i] = sortEntry(changes[i].flightNo, i);
+    radixSortEntries(entries, n, 1);
+    for (int i = 0; i < n; i++) {
+        bool repeat = i > 0 && entryKey(entries[i]) == entryKey(entries[i - 1]);
+        earlier[entryPosition(entries[i])] = repeat ? entryPosition(entries[i - 1]) : -1;
+    }
+    delete[] entries;
+    bool valid = true;
+    int touched = 0;
+    for (int i = 0; i < n && valid; i++) {
+        const FlightChange& change = changes[i];
+        Flight* flight = targets[i] = flightBST.find(change.flightNo);
+        if (!flight) {
+            error = "unknown flight " + to_string(change.flightNo);
+            valid = false;
+            continue;
+        }
+        leaves[i] = flight->t_leave;
+        arrives[i] = flight->t_arrive;
+        int j = earlier[i];
+        if (j >= 0) {
+            leaves[i] = leaves[j];
+            arrives[i] = arrives[j];
+        }
+        else {
+            touched++;
+        }
+        if (change.setLeave) leaves[i] = change.leave;
+        if (change.setArrive) arrives[i] = change.arrive;
+        if (sameTime(leaves[i], arrives[i])) {
+            error = "flight " + to_string(change.flightNo) + ": arrival time must differ from departure time";
+            valid = false;
+        }
+    }
+
+    if (valid) {
+        for (int i = 0; i < n; i++) {
+            const FlightChange& change = changes[i];
+            Flight* flight = targets[i];
+            if (!change.weather.empty()) flight->weather = change.weather;
+            flight->t_leave = leaves[i];
+            flight->t_arrive = arrives[i];
+            // Only a price change moves the fares; every change shows in the row
+            if (change.cost >= 0 && change.cost != flight->cost) {
+                flight->cost = change.cost;
+                flight->buildFares();
+            }
+            flight->invalidateRow();
+        }
+    }
+    delete[] targets;
+    delete[] leaves;
+    delete[] arrives;
+    delete[] earlier;
+    return valid ? touched : -1;
+}
+
+void Customer::manageQueue(int flightNum) {
+    FRS_TIMED(OP_MANAGE_QUEUE);
+    // Find the flight
+    Flight* flight = flightBST.find(flightNum);
+    if (!flight) {
+        cout << "Flight " << flightNum << " not found!\n";
+        return;
+    }
+
+    // Find the queue for this flight
+    Queue* flightQueue = nullptr;
+    ListNode<Queue>* queueNode = nullptr;
+
+    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+        if (flightNum == qnode->data.getNo()) {
+            flightQueue = &qnode->data;
+            queueNode = qnode;
+            break;
+        }
+    }
+
+    if (!flightQueue || flightQueue->isEmpty()) {
+        cout << "No customers in queue for Flight " << flightNum << ".\n";
+        return;
+    }
+
+    cout << "\nManaging Queue for Flight " << flightNum << ":\n";
+    cout << "Current seats: " << flight->getAvailableSeats() + flight->getBookedSeats() << endl;
+    cout << "Available business seats: " << flight->getAvailableBusinessSeats() << endl;
+    cout << "Available economy seats: " << flight->getAvailableEconomySeats() << endl;
+    cout << "Passengers in queue: " << flightQueue->getSize() << "\n\n";
+
+    while (!flightQueue->isEmpty()) {
+        // Display management options
+        cout << "\n------------------------------------------------\n";
+        cout << "1. Process next customer in queue\n";
+        cout << "2. View queue\n";
+        cout << "3. Exit queue management\n";
+        cout << "Current available business seats: " << flight->getAvailableBusinessSeats() << endl;
+        cout << "Current available economy seats: " << flight->getAvailableEconomySeats() << endl;
+        cout << "Enter your choice (1-3): ";
+
+        string choice;
+        getline(cin, choice);
+
+        if (choice == "1") {
+            // Check if any seats are available
+            if (flight->getAvailableBusinessSeats() <= 0 && flight->getAvailableEconomySeats() <= 0) {
+                cout << "No available seats! Please wait for seats to become available.\n";
+                continue;
+            }
+
+            // Process next customer
+            QueueNode* queueHead = flightQueue->getFront();
+            if (!queueHead) break;
+
+            int passport = queueHead->Customer.getPassport();
+            Customer* customer = customerBST.find(passport);
+
+            if (!customer) {
+                flightQueue->dequeue();
+                cout << "Removed invalid customer (Passport: " << passport << ") from queue.\n";
+                continue;
+            }
+
+            // Display customer info
+            cout << "\nNext customer in queue:\n";
+            cout << "Name: " << customer->getName() << " " << customer->getSurname() << endl;
+            cout << "Passport: " << customer->getPassport() << endl;
+            cout << "Time in queue: " << difftime(time(nullptr), queueHead->joinTime) / 60 << " minutes\n";
+
+            // Select class for allocation
+            string seatClass;
+            bool businessClass = false;
+
+            do {
+                cout << "\nSelect class to allocate:\n";
+                cout << "1. Business Class (2x price, " << flight->getAvailableBusinessSeats() << " available)\n";
+                cout << "2. Economy Class (" << flight->getAvailableEconomySeats() << " available)\n";
+                cout << "Enter your choice (1-2): ";
+                getline(cin, seatClass);
+
+                if (seatClass == "1") {
+                    if (flight->getAvailableBusinessSeats() <= 0) {
+                        cout << "No available business class seats!\n";
+                        continue;
+                    }
+                    businessClass = true;
+                }
+                else if (seatClass == "2") {
+                    if (flight->getAvailableEconomySeats() <= 0) {
+                        cout << "No available economy class seats!\n";
+                        continue;
+                    }
+                    businessClass = false;
+                }
+                else {
+                    cout << "Invalid choice!\n";
+                    continue;
+                }
+                break;
+            } while (true);
+
+            // Calculate price
+            Money discountedPrice = customer->quote(flight, businessClass);
+
+            cout << "Ticket Price: $" << discountedPrice;
+            if (customer->getDiscountPercent() > 0) {
+                cout << " (Discount: " << customer->getDiscountPercent() << "%)";
+            }
+            cout << endl;
+
+            cout << "Confirm allocation? (y/n): ";
+            string confirm;
+            getline(cin, confirm);
+
+            if (confirm == "y" || confirm == "Y") {
+                // Book the flight
+                customer->confirmBooking(flightNum, businessClass, discountedPrice);
+
+                // Remove from queue
+                flightQueue->dequeue();
+
+                cout << "\nSeat allocated successfully to " << customer->getName() << "!\n";
+                cout << "Amount charged: $" << discountedPrice << endl;
+
+                if (flightQueue->isEmpty()) {
+                    cout << "Queue for Flight " << flightNum << " is now empty.\n";
+                }
+            }
+            else {
+                cout << "Allocation cancelled.\n";
+            }
+        }
+        else if (choice == "2") {
+            // View current queue
+            cout << "\nCurrent queue for Flight " << flightNum << ":\n";
+            cout << left << setw(5) << "Pos" << setw(25) << "Name" << setw(15) << "Passport"
+                << setw(15) << "Wait Time" << setw(20) << "Discount" << endl;
+
+            int pos = 1;
+            QueueNode* current = flightQueue->getFront();
+            while (current) {
+                string discountStr;
+                switch (current->Customer.getDiscount()) {
+                case offers::STUDENT: discountStr = "Student (15%)"; break;
+                case offers::SENIOR: discountStr = "Senior (20%)"; break;
+                case offers::MILITARY: discountStr = "Military (10%)"; break;
+                case offers::FREQUENT_FLYER: discountStr = "Frequent Flyer (25%)"; break;
+                case offers::NONE: discountStr = "None"; break;
+                }
+
+                cout << left << setw(5) << pos++
+                    << setw(25) << (current->Customer.getName() + " " + current->Customer.getSurname())
+                    << setw(15) << current->Customer.getPassport()
+                    << setw(15) << difftime(time(nullptr), current->joinTime) / 60 << " mins"
+                    << setw(20) << discountStr << endl;
+                current = current->next;
+            }
+        }
+        else if (choice == "3") {
+            cout << "Exiting queue management.\n";
+            break;
+        }
+        else {
+            cout << "Invalid choice. Please try again.\n";
+        }
+    }
+
+    // If queue is empty after processing, remove it
+    if (flightQueue && flightQueue->isEmpty() && queueNode) {
+        qlist.erase(queueNode);
+        cout << "Queue for Flight " << flightNum << " has been removed as it's now empty.\n";
+    }
+
+    // Save all changes
+    Flight::saveToFile();
+    Customer::saveToFile();
+    Queue::saveToFile();
+
+    cout << "\nQueue management for Flight " << flightNum << " completed.\n";
+}
+
+// Menu member functions implementation
+void Menu::displayMenu() {
+    int selection;
+    string temp;
+
+    Flight::loadFromFile();
+    Customer::loadFromFile();
+    Queue::loadFromFile();
+
+    do {
+        WaitlistAging::expire();
+        cout << "-----------------------------------------------";
+        cout << "\n\t AIRLINE RESERVATION SYSTEM \n\n";
+        cout << "Please select an option from the menu below: \n";
+        cout << "1. Add new flights \n";
+        cout << "2. Delete flights \n";
+        cout << "3. Display flight schedule \n";
+        cout << "4. Display flight details \n";
+        cout << "5. Display passenger Customeral info \n";
+        cout << "6. Book reservation \n";
+        cout << "7. Cancel reservation \n";
+        cout << "8. update flight\n";
+        cout << "9. Manage waiting queue \n";
+        cout << "10. Display statistics \n";
+        cout << "11. Exit \n";
+        cout << "-----------------------------------------------" << endl;
+
+        cout << "Enter your choice (1-11): ";
+        cin >> temp;
+
+        while (!checkNumber(temp) || stoi(temp) < 1 || stoi(temp) > 11) {
+            cout << "Please enter a valid number between 1 and 11!\n";
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cin >> temp;
+        }
+        cout << endl;
+
+        selection = stoi(temp);
+        select(selection);
+    } while (true);
+}
+
+void Menu::select(int selection) {
+    Flight f;
+    Customer p;
+    string temp;
+
+    try {
+        switch (selection) {
+        case 1:
+            f.addFlight();
+            break;
+        case 2:
+            if (!flist.empty()) {
+                cout << "Enter the Flight Number you want to delete: ";
+                cin >> temp;
+                cout << endl;
+
+                while (!checkNumber(temp)) {
+                    cout << "Flight Number must be a number!\n";
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    cin >> temp;
+                    cout << endl;
+                }
+
+                Flight::deleteFlight(stoi(temp));
+            }
+            else {
+                cout << "There are no flights to delete\n";
+            }
+            break;
+        case 3:
+            if (!flist.empty()) {
+                Flight::browseSchedule();
+            }
+            else {
+                cout << "There are no scheduled flights!\n";
+            }
+            break;
+        case 4:
+            if (!flist.empty()) {
+                cout << "Please enter flight number: ";
+                cin >> temp;
+                cout << endl;
+
+                while (!checkNumber(temp)) {
+                    cout << "Flight number must be a number!\n";
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    cin >> temp;
+                    cout << endl;
+                }
+
+                Flight::displayFlightInfo(stoi(temp));
+            }
+            else {
+                cout << "There are no scheduled flights!\n";
+            }
+            break;
+        case 5:
+            if (!customerBST.empty()) {
+                cout << "Please enter passport number (or surname and first name to search): ";
+                cin >> temp;
+
+                if (!checkNumber(temp)) {
+                    string rest;
+                    getline(cin, rest);
+                    Customer::displaySearch(temp + rest);
+                    break;
+                }
+                while (!Customer::displayCustomerInfo(stoi(temp))) {
+                    cout << "Wrong passport number!\n";
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    cin >> temp;
+                    cout << endl;
+                }
+            }
+            else {
+                cout << "There are no registered clients at the moment!\n";
+            }
+            break;
+        case 6:
+            p.book();
+            break;
+        case 7:
+            p.cancel();
+            break;
+        case 8:
+            if (!flist.empty()) {
+                cout << "Enter flight number to update: ";
+                cin >> temp;
+                cout << endl;
+
+                while (!checkNumber(temp)) {
+                    cout << "Flight number must be a number!\n";
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    cin >> temp;
+                    cout << endl;
+                }
+
+                Flight::updateFlight(stoi(temp));
+            }
+            else {
+                cout << "There are no scheduled flights!\n";
+            }
+            break;
+        case 9:
+            if (!flist.empty()) {
+                cout << "Enter flight number to manage queue: ";
+                cin >> temp;
+                cout << endl;
+
+                while (!checkNumber(temp)) {
+                    cout << "Flight number must be a number!\n";
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    cin >> temp;
+                    cout << endl;
+                }
+
+                Customer customer;
+                customer.manageQueue(stoi(temp));
+            }
+            else {
+                cout << "There are no scheduled flights!\n";
+            }
+            break;
+        case 10:
+            Stats::display(cout);
+            break;
+        case 11:
+            Menu::exit_prog();
+            break;
+        default:
+            cout << "Invalid selection \n";
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+}
+
+void Menu::exit_prog() {
+    Flight::saveToFile();
+    Customer::saveToFile();
+    Queue::saveToFile();
+
+#ifndef FRS_NO_STATS
+    if (Stats::enabled) {
+        Stats::display(cout);
+    }
+#endif
+
+    for (Customer* customer : customerBST) {
+        delete customer;
+    }
+
+    cout << "Thank you for using our system! \n";
+    exit(0);
+}
+
+// ---------------------------------------------------------------------------
+// Command line helpers
+// ---------------------------------------------------------------------------
+
+// Returns the value of "--name=value", or nullptr if the option is absent.
+const char* findOption(int argc, char** argv, const char* name) {
+    size_t len = strlen(name);
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (arg[0] == '-' && arg[1] == '-' && strncmp(arg + 2, name, len) == 0 && arg[2 + len] == '=') {
+            return arg + 3 + len;
+        }
+    }
+    return nullptr;
+}
+
+bool hasFlag(int argc, char** argv, const char* flag) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], flag) == 0) return true;
+    }
+    return false;
+}
+
+long long optionInt(int argc, char** argv, const char* name, long long fallback) {
+    const char* value = findOption(argc, argv, name);
+    return value ? atoll(value) : fallback;
+}
+
+double optionDouble(int argc, char** argv, const char* name, double fallback) {
+    const char* value = findOption(argc, argv, name);
+    return value ? atof(value) : fallback;
+}
+
+bool makeDirectory(const string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+unsigned long long nowNanos() {
+    return static_cast<unsigned long long>(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Swallows everything written to it; used to silence console output while
+// benchmarking the interactive code paths.
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+// ---------------------------------------------------------------------------
+// Synthetic data generator
+// ---------------------------------------------------------------------------
+
+// SplitMix64: tiny, fast and fully deterministic for a given seed.
+class FastRng {
+private:
+    unsigned long long state;
+
+public:
+    explicit FastRng(unsigned long long seed) : state(seed) {}
+
+    unsigned long long next() {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform integer in [0, n).
+    unsigned long long below(unsigned long long n) { return n ? next() % n : 0; }
+
+    // Uniform double in [0, 1).
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+// Samples ranks 0..n-1 with probability proportional to 1 / (rank + 1)^s.
+class ZipfSampler {
+private:
+    double* cdf;
+    int n;
+
+public:
+    ZipfSampler(int count, double skew) : cdf(new double[count > 0 ? count : 1]), n(count) {
+        double total = 0.0;
+        for (int i = 0; i < n; i++) {
+            total += 1.0 / pow(i + 1.0, skew);
+            cdf[i] = total;
+        }
+        for (int i = 0; i < n; i++) cdf[i] /= total;
+    }
+    ~ZipfSampler() { delete[] cdf; }
+    ZipfSampler(const ZipfSampler&) = delete;
+    ZipfSampler& operator=(const ZipfSampler&) = delete;
+
+    int sample(FastRng& rng) const {
+        double u = rng.uniform();
+        int lo = 0, hi = n - 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (cdf[mid] < u) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+};
+
+struct GeneratorConfig {
+    int flights;
+    int customers;
+    int bookingsPerCustomer;
+    int waitlistDepth;
+    double zipfSkew;
+    unsigned long long seed;
+};
+
+// Writes flights2.txt, passengers2.txt and queues2.txt into dataDirectory.
+// Bookings follow a Zipf popularity over flights, so popular flights sell
+// out and collect waitlists of up to waitlistDepth passengers.
+void generateDataset(const GeneratorConfig& cfg) {
+    static const char* cities[] = { "Athens", "Rome", "Paris", "Berlin", "Madrid", "Lisbon", "Vienna",
+        "Prague", "Warsaw", "Dublin", "London", "Oslo", "Helsinki", "Zurich", "Istanbul", "Cairo" };
+    static const char* planes[] = { "A320", "A321", "B737", "B787", "E190", "A350" };
+    static const char* weathers[] = { "Sunny", "Rainy", "Cloudy", "Windy", "Snowy" };
+    static const char* days[] = { "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday" };
+    static const char* names[] = { "John", "Maria", "Ahmed", "Elena", "Li", "Sara", "Nikos", "Anna",
+        "Omar", "Julia", "Pedro", "Fatima", "Ivan", "Chloe", "Yusuf", "Mei" };
+    static const char* surnames[] = { "Smith", "Papadopoulos", "Khan", "Rossi", "Garcia", "Muller",
+        "Novak", "Silva", "Chen", "Dubois", "Kowalski", "Nielsen", "Ivanova", "Haddad", "Tanaka", "Brown" };
+    static const char* nationalities[] = { "Greek", "Italian", "French", "German", "Spanish", "British", "Polish" };
+    const int cityCount = sizeof(cities) / sizeof(cities[0]);
+
+    struct GenFlight {
+        int no, cost, seats, businessSeats, bookedBusiness, bookedEconomy;
+        int waiting;
+        int* waitlist;
+    };
+
+    FastRng rng(cfg.seed);
+    int flightCount = cfg.flights > 0 ? cfg.flights : 1;
+    int depth = cfg.waitlistDepth > 0 ? cfg.waitlistDepth : 0;
+    GenFlight* flights = new GenFlight[flightCount];
+    int* waitSlots = new int[static_cast<size_t>(flightCount) * (depth > 0 ? depth : 1)];
+
+    for (int i = 0; i < flightCount; i++) {
+        GenFlight& f = flights[i];
+        f.no = 1000 + i;
+        f.cost = 50 + static_cast<int>(rng.below(750));
+        f.seats = 50 + static_cast<int>(rng.below(250));
+        f.businessSeats = f.seats / 10;
+        f.bookedBusiness = f.bookedEconomy = 0;
+        f.waiting = 0;
+        f.waitlist = waitSlots + static_cast<size_t>(i) * (depth > 0 ? depth : 1);
+    }
+    // Shuffle flight numbers so popularity rank and key order are unrelated
+    for (int i = flightCount - 1; i > 0; i--) {
+        int j = static_cast<int>(rng.below(i + 1));
+        int tmp = flights[i].no; flights[i].no = flights[j].no; flights[j].no = tmp;
+    }
+
+    // Passports are shuffled too, so the customer BST is not built from sorted keys
+    int customerCount = cfg.customers > 0 ? cfg.customers : 0;
+    int* passports = new int[customerCount > 0 ? customerCount : 1];
+    for (int i = 0; i < customerCount; i++) passports[i] = 1000000 + i;
+    for (int i = customerCount - 1; i > 0; i--) {
+        int j = static_cast<int>(rng.below(i + 1));
+        int tmp = passports[i]; passports[i] = passports[j]; passports[j] = tmp;
+    }
+
+    ZipfSampler popularity(flightCount, cfg.zipfSkew);
+
+    // A fixed booking time keeps the output a function of the seed alone
+    const string bookedAt = "1767225600";  // 2026-01-01 00:00 UTC
+    ofstream customersOut(dataFile("passengers2.txt"));
+    for (int c = 0; c < customerCount; c++) {
+        int discount = static_cast<int>(rng.below(5));
+        Money totalSpent;
+        string booked;
+
+        for (int b = 0; b < cfg.bookingsPerCustomer; b++) {
+            GenFlight& f = flights[popularity.sample(rng)];
+            int economySeats = f.seats - f.businessSeats;
+            bool business = rng.below(10) == 0 && f.bookedBusiness < f.businessSeats;
+            if (!business && f.bookedEconomy >= economySeats) {
+                business = f.bookedBusiness < f.businessSeats;
+            }
+
+            if (business || f.bookedEconomy < economySeats) {
+                // Priced as a quote would be, at the cabin's load before the seat
+                Money fare = PricingEngine::price(f.cost, business, static_cast<offers>(discount),
+                    business ? f.bookedBusiness : f.bookedEconomy, business ? f.businessSeats : economySeats,
+                    f.waiting);
+                if (business) f.bookedBusiness++;
+                else f.bookedEconomy++;
+                totalSpent += fare;
+                int seat = business ? f.bookedBusiness : f.businessSeats + f.bookedEconomy;
+                if (!booked.empty()) booked += ";";
+                booked += to_string(f.no) + (business ? ":B:" : ":E:") + fare.str() + ":"
+                    + to_string(seat) + ":" + bookedAt;
+            }
+            else if (f.waiting < depth) {
+                f.waitlist[f.waiting++] = passports[c];
+            }
+        }
+
+        customersOut << passports[c] << ","
+            << names[rng.below(16)] << ","
+            << surnames[rng.below(16)] << ","
+            << nationalities[rng.below(7)] << ","
+            << "Street " << (1 + rng.below(500)) << ","
+            << (2000000 + rng.below(8000000)) << ","
+            << discount << ","
+            << totalSpent;
+        if (!booked.empty()) customersOut << "," << booked;
+        customersOut << "\n";
+    }
+    customersOut.close();
+
+    ofstream flightsOut(dataFile("flights2.txt"));
+    ofstream queuesOut(dataFile("queues2.txt"));
+    for (int i = 0; i < flightCount; i++) {
+        const GenFlight& f = flights[i];
+        int from = static_cast<int>(rng.below(cityCount));
+        int to = (from + 1 + static_cast<int>(rng.below(cityCount - 1))) % cityCount;
+        int leaveHour = static_cast<int>(rng.below(20));
+        int leaveMin = static_cast<int>(rng.below(60));
+        int arriveHour = leaveHour + 1 + static_cast<int>(rng.below(3));
+        int arriveMin = static_cast<int>(rng.below(60));
+
+        flightsOut << f.no << "," << cities[from] << "," << cities[to] << ","
+            << setw(2) << setfill('0') << leaveHour << ":" << setw(2) << setfill('0') << leaveMin << ","
+            << setw(2) << setfill('0') << arriveHour << ":" << setw(2) << setfill('0') << arriveMin << ","
+            << f.cost << "," << planes[rng.below(6)] << ","
+            << f.seats << "," << f.bookedBusiness + f.bookedEconomy << ","
+            << f.businessSeats << "," << f.bookedBusiness << ","
+            << f.seats - f.businessSeats << "," << f.bookedEconomy << ","
+            << weathers[rng.below(5)] << "," << days[rng.below(7)] << "\n";
+
+        queuesOut << f.no << ":";
+        for (int w = 0; w < f.waiting; w++) {
+            if (w) queuesOut << ";";
+            queuesOut << f.waitlist[w];
+        }
+        queuesOut << "\n";
+    }
+
+    delete[] passports;
+    delete[] waitSlots;
+    delete[] flights;
+}
+
+GeneratorConfig generatorConfigFromArgs(int argc, char** argv) {
+    GeneratorConfig cfg;
+    cfg.flights = static_cast<int>(optionInt(argc, argv, "flights", 1000));
+    cfg.customers = static_cast<int>(optionInt(argc, argv, "customers", 10000));
+    cfg.bookingsPerCustomer = static_cast<int>(optionInt(argc, argv, "bookings", 2));
+    cfg.waitlistDepth = static_cast<int>(optionInt(argc, argv, "waitlist", 5));
+    cfg.zipfSkew = optionDouble(argc, argv, "zipf", 1.0);
+    cfg.seed = static_cast<unsigned long long>(optionInt(argc, argv, "seed", 42));
+    return cfg;
+}
+
+int generateMain(int argc, char** argv) {
+    GeneratorConfig cfg = generatorConfigFromArgs(argc, argv);
+    if (!dataDirectory.empty()) makeDirectory(dataDirectory);
+    // Bookings are priced with the directory's fare curves, if it has them
+    PricingEngine::loadConfig(dataFile("pricing.txt"));
+    generateDataset(cfg);
+    cout << "Generated " << cfg.flights << " flights and " << cfg.customers
+        << " customers (seed " << cfg.seed << ") in '" << (dataDirectory.empty() ? "." : dataDirectory) << "'\n";
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// End-to-end benchmark
+// ---------------------------------------------------------------------------
+
+void freeAllCustomers() {
+    for (Customer* customer : customerBST) {
+        delete customer;
+    }
+    customerBST.clear();
+    customerNames.clear();
+}
+
+// Runs every phase at one scale and appends its JSON object to out.
+void benchmarkScale(int scale, const GeneratorConfig& base, int ops, ostream& out) {
+    GeneratorConfig cfg = base;
+    cfg.customers = scale;
+    cfg.flights = scale / 10 > 10 ? scale / 10 : 10;
+
+    unsigned long long t0 = nowNanos();
+    generateDataset(cfg);
+    unsigned long long generateNs = nowNanos() - t0;
+
+    freeAllCustomers();
+    Stats::reset();
+
+    t0 = nowNanos();
+    Flight::loadFromFile();
+    unsigned long long loadFlightsNs = nowNanos() - t0;
+    t0 = nowNanos();
+    Customer::loadFromFile();
+    unsigned long long loadCustomersNs = nowNanos() - t0;
+    t0 = nowNanos();
+    Queue::loadFromFile();
+    unsigned long long loadQueuesNs = nowNanos() - t0;
+
+    t0 = nowNanos();
+    Flight::saveToFile();
+    unsigned long long saveFlightsNs = nowNanos() - t0;
+    t0 = nowNanos();
+    Customer::saveToFile();
+    unsigned long long saveCustomersNs = nowNanos() - t0;
+    t0 = nowNanos();
+    Queue::saveToFile();
+    unsigned long long saveQueuesNs = nowNanos() - t0;
+
+    // Keys to draw from during the lookup and booking phases
+    int flightCount = flist.getSize();
+    int* flightNos = new int[flightCount > 0 ? flightCount : 1];
+    int i = 0;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+        flightNos[i++] = node->data.getFlightNo();
+    }
+    int customerCount = customerBST.size();
+    int* passportNos = new int[customerCount > 0 ? customerCount : 1];
+    i = 0;
+    for (CustomerBST::Iterator it = customerBST.begin(); it != customerBST.end(); ++it) {
+        passportNos[i++] = it.key();
+    }
+
+    FastRng rng(cfg.seed ^ static_cast<unsigned long long>(scale));
+    const int lookups = 100000;
+    unsigned long long found = 0;
+    t0 = nowNanos();
+    for (int n = 0; n < lookups; n++) {
+        if (flightBST.find(flightNos[rng.below(flightCount)])) found++;
+        if (customerCount && customerBST.find(passportNos[rng.below(customerCount)])) found++;
+    }
+    unsigned long long lookupNs = nowNanos() - t0;
+
+    // Book/cancel mix through the same cores (and saves) as the console
+    ZipfSampler popularity(flightCount, cfg.zipfSkew);
+    int bookings = 0, cancellations = 0;
+    t0 = nowNanos();
+    for (int n = 0; n < ops && customerCount; n++) {
+        Customer* customer = customerBST.find(passportNos[rng.below(customerCount)]);
+        if (!customer) continue;
+
+        if (rng.below(2) == 0 && !customer->getBookings().empty()) {
+            Money refund;
+            Customer::cancelBooking(customer->getPassport(), customer->getBookings()[0].flightNo, refund);
+            Flight::saveToFile();
+            Customer::saveToFile();
+            Queue::saveToFile();
+            cancellations++;
+        }
+        else {
+            Flight* flight = flightBST.find(flightNos[popularity.sample(rng)]);
+            if (flight && flight->getAvailableEconomySeats() > 0) {
+                customer->confirmBooking(flight->getFlightNo(), false, customer->quote(flight, false));
+                Customer::saveToFile();
+                Flight::saveToFile();
+                bookings++;
+            }
+        }
+    }
+    unsigned long long mixNs = nowNanos() - t0;
+
+    // Delete flights that have nobody waiting (deletion would otherwise prompt)
+    int deletions = 0;
+    const int maxDeletions = 20;
+    t0 = nowNanos();
+    for (int n = 0; n < flightCount && deletions < maxDeletions; n++) {
+        int num = flightNos[rng.below(flightCount)];
+        if (!Flight::flightExists(num)) continue;
+
+        bool waiting = false;
+        for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+            if (qnode->data.getNo() == num) {
+                waiting = !qnode->data.isEmpty();
+                break;
+            }
+        }
+        if (waiting) continue;
+
+        Flight::deleteFlight(num);
+        deletions++;
+    }
+    unsigned long long deleteNs = nowNanos() - t0;
+
+    delete[] flightNos;
+    delete[] passportNos;
+
+    out << "{\"scale\":" << scale
+        << ",\"flights\":" << cfg.flights
+        << ",\"customers\":" << cfg.customers
+        << ",\"generate_ns\":" << generateNs
+        << ",\"load_ns\":{\"flights\":" << loadFlightsNs << ",\"customers\":" << loadCustomersNs
+        << ",\"queues\":" << loadQueuesNs << "}"
+        << ",\"save_ns\":{\"flights\":" << saveFlightsNs << ",\"customers\":" << saveCustomersNs
+        << ",\"queues\":" << saveQueuesNs << "}"
+        << ",\"lookup\":{\"ops\":" << lookups * 2 << ",\"hits\":" << found
+        << ",\"ns_per_op\":" << (lookupNs / (lookups * 2.0)) << "}"
+        << ",\"book_cancel\":{\"ops\":" << ops << ",\"bookings\":" << bookings
+        << ",\"cancellations\":" << cancellations
+        << ",\"ns_per_op\":" << (ops ? mixNs / static_cast<double>(ops) : 0.0) << "}"
+        << ",\"delete\":{\"ops\":" << deletions
+        << ",\"ns_per_op\":" << (deletions ? deleteNs / static_cast<double>(deletions) : 0.0) << "}"
+        << ",\"stats\":";
+    Stats::displayJson(out);
+    out << "}";
+}
+
+// --bench [--scales=1000,5000,20000] [--ops=200] [--out=file.json] plus the
+// generator options. Data files go to --data-dir (default bench_data/).
+int benchMain(int argc, char** argv) {
+    GeneratorConfig base = generatorConfigFromArgs(argc, argv);
+    int ops = static_cast<int>(optionInt(argc, argv, "ops", 200));
+    const char* scalesArg = findOption(argc, argv, "scales");
+    string scales = scalesArg ? scalesArg : "1000,5000,20000";
+    if (dataDirectory.empty()) dataDirectory = "bench_data/";
+    makeDirectory(dataDirectory);
+
+    ostringstream json;
+    json << "{\"benchmark\":\"end_to_end\",\"seed\":" << base.seed
+        << ",\"bookings_per_customer\":" << base.bookingsPerCustomer
+        << ",\"waitlist_depth\":" << base.waitlistDepth
+        << ",\"zipf\":" << base.zipfSkew << ",\"results\":[";
+
+    NullBuffer nullBuffer;
+    streambuf* console = cout.rdbuf(&nullBuffer);
+    istringstream scaleStream(scales);
+    string token;
+    bool first = true;
+    while (getline(scaleStream, token, ',')) {
+        if (!checkNumber(token)) continue;
+        if (!first) json << ",";
+        benchmarkScale(stoi(token), base, ops, json);
+        first = false;
+    }
+    cout.rdbuf(console);
+    json << "]}";
+
+    const char* outPath = findOption(argc, argv, "out");
+    if (outPath) {
+        ofstream file(outPath);
+        file << json.str() << "\n";
+    }
+    else {
+        cout << json.str() << endl;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Container microbenchmarks
+// ---------------------------------------------------------------------------
+
+// Hardware cache-miss counter for the calling thread; unavailable (and a
+// no-op) when perf events cannot be opened.
+class CacheMissCounter {
+private:
+    int fd;
+
+public:
+    CacheMissCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    unsigned long long stop() {
+        unsigned long long value = 0;
+#ifdef __linux__
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) value = 0;
+#endif
+        return value;
+    }
+};
+
+// Bytes currently allocated from the heap, including blocks large enough
+// to get their own mapping, or 0 when the C library cannot report it.
+unsigned long long heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<unsigned long long>(info.uordblks + info.hblkhd);
+#else
+    return 0;
+#endif
+}
+
+enum class KeyOrder { SEQUENTIAL, RANDOM, ADVERSARIAL };
+
+const char* keyOrderName(KeyOrder order) {
+    switch (order) {
+    case KeyOrder::SEQUENTIAL: return "sequential";
+    case KeyOrder::RANDOM: return "random";
+    case KeyOrder::ADVERSARIAL: return "adversarial";
+    }
+    return "";
+}
+
+// Sequential is 0..n-1, random a shuffle of it, adversarial a zig-zag
+// (0, n-1, 1, n-2, ...) that degenerates unbalanced trees just as badly as
+// sorted input while defeating the prefetcher on lists.
+void fillKeys(int* keys, int n, KeyOrder order, FastRng& rng) {
+    for (int i = 0; i < n; i++) keys[i] = i;
+    if (order == KeyOrder::RANDOM) {
+        for (int i = n - 1; i > 0; i--) {
+            int j = static_cast<int>(rng.below(i + 1));
+            int tmp = keys[i]; keys[i] = keys[j]; keys[j] = tmp;
+        }
+    }
+    else if (order == KeyOrder::ADVERSARIAL) {
+        int lo = 0, hi = n - 1;
+        for (int i = 0; i < n; i++) keys[i] = (i % 2 == 0) ? lo++ : hi--;
+    }
+}
+
+class MicroReport {
+private:
+    ostream& out;
+    CacheMissCounter misses;
+    bool first;
+    unsigned long long startNs;
+    unsigned long long startHeap;
+
+public:
+    explicit MicroReport(ostream& o) : out(o), first(true), startNs(0), startHeap(0) {}
+
+    bool perfAvailable() const { return misses.available(); }
+
+    void begin() {
+        startHeap = heapInUse();
+        misses.start();
+        startNs = nowNanos();
+    }
+
+    // Closes the phase started by begin(); bytesPerElement is reported for
+    // phases that build the structure.
+    void end(const char* structure, const char* op, KeyOrder order, int n, int ops, bool reportMemory) {
+        unsigned long long elapsed = nowNanos() - startNs;
+        unsigned long long missCount = misses.stop();
+        unsigned long long heap = heapInUse();
+
+        row(structure, op, order, n);
+        out << ",\"ops\":" << ops << ",\"ns_per_op\":" << (ops ? elapsed / static_cast<double>(ops) : 0.0)
+            << ",\"cache_misses_per_op\":";
+        if (misses.available()) out << (ops ? missCount / static_cast<double>(ops) : 0.0);
+        else out << "null";
+        if (reportMemory) {
+            out << ",\"bytes_per_element\":";
+            if (heap && n) out << (heap > startHeap ? (heap - startHeap) / static_cast<double>(n) : 0.0);
+            else out << "null";
+        }
+        out << "}";
+    }
+
+    void skipped(const char* structure, const char* op, KeyOrder order, int n, const char* reason) {
+        row(structure, op, order, n);
+        out << ",\"skipped\":\"" << reason << "\"}";
+    }
+
+private:
+    void row(const char* structure, const char* op, KeyOrder order, int n) {
+        if (!first) out << ",";
+        first = false;
+        out << "{\"structure\":\"" << structure << "\",\"op\":\"" << op << "\",\"order\":\""
+            << keyOrderName(order) << "\",\"n\":" << n;
+    }
+};
+
+// Unbalanced trees fed non-random keys cost O(n^2); beyond this size such
+// runs are reported as skipped instead of running for hours.
+const int MICRO_QUADRATIC_LIMIT = 20000;
+// Linear scans (list and queue lookups) are sampled rather than run n times.
+const int MICRO_SCAN_SAMPLES = 1000;
+
+void microbenchList(MicroReport& report, const int* keys, int n, KeyOrder order, FastRng& rng) {
+    DoublyLinkedList<int> list;
+    ListNode<int>** nodes = new ListNode<int>*[n];
+
+    report.begin();
+    for (int i = 0; i < n; i++) {
+        list.push_back(keys[i]);
+        nodes[i] = list.getTail();
+    }
+    report.end("DoublyLinkedList", "insert", order, n, n, true);
+
+    int samples = n < MICRO_SCAN_SAMPLES ? n : MICRO_SCAN_SAMPLES;
+    volatile long long sink = 0;
+    report.begin();
+    for (int s = 0; s < samples; s++) {
+        int target = keys[rng.below(n)];
+        for (ListNode<int>* node = list.begin(); node != list.end(); node = node->next) {
+            if (node->data == target) { sink = sink + node->data; break; }
+        }
+    }
+    report.end("DoublyLinkedList", "find", order, n, samples, false);
+
+    report.begin();
+    for (ListNode<int>* node = list.begin(); node != list.end(); node = node->next) sink = sink + node->data;
+    report.end("DoublyLinkedList", "iterate", order, n, n, false);
+
+    // Erase in random node order to expose pointer chasing across the heap
+    for (int i = n - 1; i > 0; i--) {
+        int j = static_cast<int>(rng.below(i + 1));
+        ListNode<int>* tmp = nodes[i]; nodes[i] = nodes[j]; nodes[j] = tmp;
+    }
+    report.begin();
+    for (int i = 0; i < n; i++) list.erase(nodes[i]);
+    report.end("DoublyLinkedList", "erase", order, n, n, false);
+
+    delete[] nodes;
+}
+
+void microbenchFlightBST(MicroReport& report, const int* keys, int n, KeyOrder order, const int* probes) {
+    if (order != KeyOrder::RANDOM && n > MICRO_QUADRATIC_LIMIT) {
+        report.skipped("FlightBST", "insert", order, n, "quadratic");
+        report.skipped("FlightBST", "find", order, n, "quadratic");
+        return;
+    }
+
+    FlightBST tree;
+    Flight dummy;
+    report.begin();
+    for (int i = 0; i < n; i++) tree.insert(keys[i], &dummy);
+    report.end("FlightBST", "insert", order, n, n, true);
+
+    volatile long long hits = 0;
+    report.begin();
+    for (int i = 0; i < n; i++) hits = hits + (tree.find(probes[i]) != nullptr);
+    report.end("FlightBST", "find", order, n, n, false);
+}
+
+void microbenchCustomerBST(MicroReport& report, const int* keys, int n, KeyOrder order, const int* probes) {
+    if (order != KeyOrder::RANDOM && n > MICRO_QUADRATIC_LIMIT) {
+        const char* ops[] = { "insert", "find", "iterate", "erase" };
+        for (const char* op : ops) report.skipped("CustomerBST", op, order, n, "quadratic");
         return;
     }
 
-    cin.clear();
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    CustomerBST tree;
+    Customer dummy;
+    report.begin();
+    for (int i = 0; i < n; i++) tree.insert(keys[i], &dummy);
+    report.end("CustomerBST", "insert", order, n, n, true);
+
+    volatile long long hits = 0;
+    report.begin();
+    for (int i = 0; i < n; i++) hits = hits + (tree.find(probes[i]) != nullptr);
+    report.end("CustomerBST", "find", order, n, n, false);
+
+    report.begin();
+    for (CustomerBST::Iterator it = tree.begin(); it != tree.end(); ++it) hits = hits + it.key();
+    report.end("CustomerBST", "iterate", order, n, n, false);
+
+    report.begin();
+    for (int i = 0; i < n; i++) tree.erase(probes[i]);
+    report.end("CustomerBST", "erase", order, n, n, false);
+}
+
+void microbenchQueue(MicroReport& report, const int* keys, int n, KeyOrder order, FastRng& rng) {
+    Queue queue(0);
+    Customer passenger;
+
+    report.begin();
+    for (int i = 0; i < n; i++) {
+        passenger.setPassport(keys[i]);
+        queue.enqueue(passenger);
+    }
+    report.end("Queue", "insert", order, n, n, true);
+
+    int samples = n < MICRO_SCAN_SAMPLES ? n : MICRO_SCAN_SAMPLES;
+    volatile long long sink = 0;
+    report.begin();
+    for (int s = 0; s < samples; s++) sink = sink + (queue.getPosition(keys[rng.below(n)]));
+    report.end("Queue", "find", order, n, samples, false);
+
+    report.begin();
+    for (QueueNode* node = queue.getFront(); node; node = node->next) sink = sink + (node->Customer.getPassport());
+    report.end("Queue", "iterate", order, n, n, false);
+
+    report.begin();
+    while (!queue.isEmpty()) queue.dequeue();
+    report.end("Queue", "erase", order, n, n, false);
+}
+
+// --microbench [--sizes=1000,10000,100000,1000000] [--seed=N] [--out=file]
+// Timers with deadlines spread over an hour of 100 ms ticks; "advance"
+// reports the cost per tick while expiring everything still pending.
+void microbenchTimerWheel(MicroReport& report, const int* keys, int n, KeyOrder order) {
+    const unsigned long long HORIZON = 36000;
+    TimerNode* nodes = new TimerNode[n];
+    TimerWheel wheel;
+    unsigned long long expired = 0;
+
+    report.begin();
+    for (int i = 0; i < n; i++) {
+        nodes[i].level = nodes[i].slot = -1;
+        wheel.schedule(&nodes[i], 1 + static_cast<unsigned long long>(keys[i]) % HORIZON);
+    }
+    report.end("TimerWheel", "schedule", order, n, n, true);
+
+    report.begin();
+    for (int i = 0; i < n; i += 2) wheel.cancel(&nodes[i]);
+    report.end("TimerWheel", "cancel", order, n, (n + 1) / 2, false);
+
+    report.begin();
+    wheel.advance(HORIZON + 1, [](TimerNode*, void* context) { ++*static_cast<unsigned long long*>(context); }, &expired);
+    report.end("TimerWheel", "advance", order, n, static_cast<int>(HORIZON), false);
+
+    if (expired != static_cast<unsigned long long>(n / 2)) {
+        cerr << "TimerWheel expired " << expired << " of " << n / 2 << " timers." << endl;
+    }
+    delete[] nodes;
+}
+
+int microbenchMain(int argc, char** argv) {
+    const char* sizesArg = findOption(argc, argv, "sizes");
+    string sizes = sizesArg ? sizesArg : "1000,10000,100000,1000000";
+    FastRng rng(static_cast<unsigned long long>(optionInt(argc, argv, "seed", 42)));
+
+    ostringstream json;
+    MicroReport report(json);
+    json << "{\"benchmark\":\"containers\",\"perf_counters\":" << (report.perfAvailable() ? "true" : "false")
+        << ",\"results\":[";
+
+    const KeyOrder orders[] = { KeyOrder::SEQUENTIAL, KeyOrder::RANDOM, KeyOrder::ADVERSARIAL };
+    istringstream sizeStream(sizes);
+    string token;
+    while (getline(sizeStream, token, ',')) {
+        if (!checkNumber(token) || stoi(token) <= 0) continue;
+        int n = stoi(token);
+        int* keys = new int[n];
+        int* probes = new int[n];
+
+        for (KeyOrder order : orders) {
+            fillKeys(keys, n, order, rng);
+            fillKeys(probes, n, KeyOrder::RANDOM, rng);
+            microbenchList(report, keys, n, order, rng);
+            microbenchFlightBST(report, keys, n, order, probes);
+            microbenchCustomerBST(report, keys, n, order, probes);
+            microbenchQueue(report, keys, n, order, rng);
+            microbenchTimerWheel(report, keys, n, order);
+        }
+
+        delete[] keys;
+        delete[] probes;
+    }
+    json << "]}";
+
+    const char* outPath = findOption(argc, argv, "out");
+    if (outPath) {
+        ofstream file(outPath);
+        file << json.str() << "\n";
+    }
+    else {
+        cout << json.str() << endl;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Memory report
+//
+// The per-pool counters plus the string storage they leave out, measured by
+// walking the flights, customers and waitlist entries. "unindexed_customers"
+// counts Customer objects on the heap that the index does not hold, which
+// is where a leaked copy shows up. "heap_in_use" is what the C library
+// reports for the whole process, for comparison with the tracked total.
+// ---------------------------------------------------------------------------
+
+void writeMemoryReport(ostream& out) {
+    size_t flightStrings = 0, customerStrings = 0, waitlistStrings = 0;
+    long long entries = 0;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+        flightStrings += node->data.stringBytes();
+    }
+    for (Customer* customer : customerBST) customerStrings += customer->stringBytes();
+    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
+        for (QueueNode* entry = qnode->data.getFront(); entry; entry = entry->next) {
+            waitlistStrings += entry->Customer.stringBytes();
+            entries++;
+        }
+    }
+    long long strings = static_cast<long long>(flightStrings + customerStrings + waitlistStrings);
+    long long customerObjects = Memory::getBlocks(Memory::MEM_CUSTOMERS);
+
+    out << "{\"pools\":{";
+    Memory::displayJson(out);
+    out << "},\"strings\":{\"flights\":" << flightStrings << ",\"customers\":" << customerStrings
+        << ",\"waitlists\":" << waitlistStrings << "}"
+        << ",\"records\":{\"flights\":" << flist.getSize() << ",\"customers\":" << customerBST.size()
+        << ",\"waitlist_entries\":" << entries << ",\"dated_flights\":" << DatedFlights::size() << "}"
+        << ",\"unindexed_customers\":" << (customerObjects > customerBST.size() ? customerObjects - customerBST.size() : 0)
+        << ",\"tracked_bytes\":" << Memory::totalBytes() + strings
+        << ",\"heap_in_use\":" << heapInUse() << "}";
+}
+
+// ---------------------------------------------------------------------------
+// Reservation server
+//
+// Line-oriented protocol, one request per line and exactly one response line
+// ("OK ..." or "ERR <reason>") per request:
+//
+//   PING                          -> OK PONG
+//   SCHEDULE                      -> OK <n> <flight>;<flight>;...
+//   FLIGHT <no>                   -> OK <flight>
+//   CUSTOMER <passport>           -> OK passport,name,surname,nationality,discount,spent,b1|b2|...
+//                                    with each booking as flight:cabin(B|E):seat:fare
+//   SEARCH <surname> [first name] -> OK <n> passport,name,surname,edits;...   (best 10)
+//   CUSTOMERS <from> <to>         -> OK <n> passport,name,surname;...   (passports
+//                                    from..to in order, first 100)
+//   BOOK <passport> <flight> B|E [OVERBOOK]  -> OK <price>
+//   HOLD <passport> <flight> B|E [OVERBOOK]  -> OK <hold> <price> <ttl_ms>
+//                                 (BOOK, HOLD and CANCEL take <flight>@YYYY-MM-DD
+//                                 for one dated departure of a scheduled flight;
+//                                 BOOK and HOLD refuse dates before today, UTC)
+//                                 (OVERBOOK may go past the seats, up to the
+//                                 flight's limit from overbook.txt)
+//   CONFIRM <hold>                -> OK <price>   (books the held seat)
+//   RELEASE <hold>                -> OK
+//   CANCEL <passport> <flight>    -> OK <refund>
+//   DEPARTURES <YYYY-MM-DD>       -> OK <n> flight,from,to,leave,arrive[+1],business_free,economy_free;...
+//   UPDATE <flight> field=value ...[;<flight> field=value ...]  -> OK <flights>
+//                                 (fields weather, leave, arrive, cost; all
+//                                 flights change or none does)
+//   WAITLIST JOIN <passport> <flight>  -> OK <position>
+//   WAITLIST SHOW <flight>        -> OK <n> p1|p2|...
+//   WAITLIST POSITION <passport> <flight> -> OK <position>
+//   STATS                         -> OK <json>
+//   MEMSTATS                      -> OK <json>   (heap use by subsystem)
+//   QUIT                          -> OK BYE (then the connection is closed)
+//
+// where <flight> is no,from,to,leave,arrive,cost,freeBusiness,freeEconomy,weather,day.
+// The engine is single threaded: one epoll loop owns every connection and
+// runs the requests in arrival order. Handlers only touch memory and report
+// which data files they dirtied; a response is sent once those files are
+// persisted (see the coroutine pipeline below).
+//
+// With --readers=N (C++20 builds) SCHEDULE, FLIGHT, CUSTOMER, CUSTOMERS and
+// SEARCH are answered on N reader threads from the published versions of the
+// records (see "Snapshot reads"), so a long listing or a fuzzy search never
+// stalls the bookings behind it. The loop still runs a connection's requests
+// one at a time, so a client reads its own bookings. Serving adds and removes
+// no flights or customers, which is what lets readers walk the indexes.
+// ---------------------------------------------------------------------------
+
+// Data files a request has modified.
+enum PersistMask {
+    PERSIST_FLIGHTS = 1,
+    PERSIST_CUSTOMERS = 2,
+    PERSIST_QUEUES = 4
+};
 
-    string choice;
-    cout << "Insert y (yes) for a new client or n (no) for an existing client: ";
-    getline(cin, choice);
+void persistFiles(unsigned mask) {
+    if (mask & PERSIST_FLIGHTS) Flight::saveToFile();
+    if (mask & PERSIST_CUSTOMERS) Customer::saveToFile();
+    if (mask & PERSIST_QUEUES) Queue::saveToFile();
+}
 
-    if (choice == "y" || choice == "Y") {
-        cout << "Please provide your personal information.\n";
-        inputCustomeralInfo();
+string formatTime(Time t) {
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%02d:%02d", t.hour, t.min);
+    return buf;
+}
+
+// ---------------------------------------------------------------------------
+// Asynchronous persistence
+//
+// SnapshotWriter writes serialized data files on a background thread, one
+// batch at a time. GroupCommit (loop thread only) collects every request
+// waiting for durability, serializes the union of their dirty files once
+// and hands that batch to the writer; when the batch is on disk all of its
+// waiters resume together. With C++20 coroutines the request handlers
+// co_await this instead of blocking a thread on saveToFile().
+// ---------------------------------------------------------------------------
+
+class SnapshotWriter {
+public:
+    typedef void (*Notify)(void* context);
+
+    SnapshotWriter(Notify n, void* c) : notify(n), context(c), stopping(false), pending(false), mask(0),
+        worker(&SnapshotWriter::run, this) {
     }
-    else {
-        string temp;
-        cout << "Please provide your passport number: ";
-        getline(cin, temp);
 
-        while (!checkNumber(temp)) {
-            cout << "Please insert a valid passport number!\n";
-            getline(cin, temp);
+    ~SnapshotWriter() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
         }
+        wake.notify_one();
+        worker.join();
+    }
 
-        int passport = stoi(temp);
-        if (!Customer::uniquePass(passport)) {
-            copyFromExisting(passport);
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Takes over the snapshots (indexed flights, customers, queues) of the
+    // files set in fileMask. The previous batch must have been notified.
+    void submit(unsigned fileMask, string* snapshots) {
+        {
+            lock_guard<mutex> guard(lock);
+            for (int i = 0; i < 3; i++) files[i].swap(snapshots[i]);
+            mask = fileMask;
+            pending = true;
         }
-        else {
-            cout << "Wrong passport number!\n";
-            return;
+        wake.notify_one();
+    }
+
+private:
+    void run() {
+        static const char* names[3] = { "flights2.txt", "passengers2.txt", "queues2.txt" };
+        string batch[3];
+        while (true) {
+            unsigned batchMask;
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [this] { return pending || stopping; });
+                if (!pending) return;
+                for (int i = 0; i < 3; i++) batch[i].swap(files[i]);
+                batchMask = mask;
+                pending = false;
+            }
+
+            // One batch, so io_uring submits every file's writes together
+            FileWrite writes[3];
+            int count = 0;
+            for (int i = 0; i < 3; i++) {
+                if (!(batchMask & (1u << i))) continue;
+                writes[count].path = dataFile(names[i]);
+                writes[count].data = &batch[i];
+                count++;
+            }
+            if (!FileIO::writeFiles(writes, count)) {
+                cerr << "Error: Could not write the data files." << endl;
+            }
+            for (int i = 0; i < 3; i++) batch[i].clear();
+            notify(context);
         }
     }
 
-    Flight::displaySchedule();
+    Notify notify;
+    void* context;
+    mutex lock;
+    condition_variable wake;
+    bool stopping, pending;
+    unsigned mask;
+    string files[3];
+    thread worker;
+};
 
-    string temp;
-    int num;
-    do {
-        cout << "\n\nEnter the number of the flight you're interested in: ";
-        getline(cin, temp);
+#ifdef FRS_HAVE_COROUTINES
 
-        if (!checkNumber(temp) || !Flight::flightExists(stoi(temp))) {
-            cout << "Please insert a valid Flight No!\n";
-            continue;
+// Coroutine that starts eagerly and frees itself when it finishes.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return DetachedTask(); }
+        suspend_never initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+};
+
+class GroupCommit {
+public:
+    struct Waiter {
+        coroutine_handle<> handle;
+        Waiter* next;
+    };
+
+    GroupCommit(SnapshotWriter::Notify notify, void* context)
+        : pendingHead(nullptr), pendingTail(nullptr), inflight(nullptr), pendingMask(0), batches(0),
+        writer(notify, context) {
+    }
+
+    void add(Waiter* waiter, unsigned mask) {
+        waiter->next = nullptr;
+        if (pendingTail) pendingTail->next = waiter;
+        else pendingHead = waiter;
+        pendingTail = waiter;
+        pendingMask |= mask;
+    }
+
+    // Starts the next batch if the writer is free and anyone is waiting.
+    void pump() {
+        if (inflight || !pendingHead) return;
+
+        string snapshots[3];
+        if (pendingMask & PERSIST_FLIGHTS) snapshots[0] = serialize(Flight::writeRecords);
+        if (pendingMask & PERSIST_CUSTOMERS) snapshots[1] = serialize(Customer::writeRecords);
+        if (pendingMask & PERSIST_QUEUES) snapshots[2] = serialize(Queue::writeRecords);
+        for (int i = 0; i < 3; i++) FRS_COUNT(BYTES_WRITTEN, snapshots[i].size());
+
+        inflight = pendingHead;
+        pendingHead = pendingTail = nullptr;
+        writer.submit(pendingMask, snapshots);
+        pendingMask = 0;
+        batches++;
+    }
+
+    // Called on the loop thread once the writer has notified completion.
+    void completed() {
+        Waiter* waiter = inflight;
+        inflight = nullptr;
+        while (waiter) {
+            Waiter* next = waiter->next;  // resuming may free the waiter
+            waiter->handle.resume();
+            waiter = next;
         }
-        num = stoi(temp);
-        break;
-    } while (true);
+        pump();
+    }
+
+    bool idle() const { return !inflight && !pendingHead; }
+    bool writing() const { return inflight != nullptr; }
+    unsigned long long batchCount() const { return batches; }
+
+private:
+    static string serialize(void (*writeRecords)(ostream&)) {
+        ostringstream out;
+        writeRecords(out);
+        return out.str();
+    }
+
+    Waiter* pendingHead;
+    Waiter* pendingTail;
+    Waiter* inflight;
+    unsigned pendingMask;
+    unsigned long long batches;
+    SnapshotWriter writer;
+};
+
+// co_await PersistAwaiter(commit, mask): resumes once the files in mask have
+// been written; completes immediately when mask is empty.
+class PersistAwaiter {
+public:
+    PersistAwaiter(GroupCommit& c, unsigned m) : commit(c), mask(m), suspended(false) {}
+
+    bool await_ready() const noexcept { return mask == 0; }
+    void await_suspend(coroutine_handle<> handle) {
+        suspended = true;
+        waiter.handle = handle;
+        commit.add(&waiter, mask);
+    }
+    void await_resume() const noexcept {}
+
+    bool wasSuspended() const { return suspended; }
+
+private:
+    GroupCommit& commit;
+    unsigned mask;
+    bool suspended;
+    GroupCommit::Waiter waiter;
+};
+
+// Threads that answer read requests from snapshots (see the server notes).
+// Jobs are queued and resumed on the loop thread; each reader holds a
+// ReadGuard while it answers and records no stats.
+class ReaderPool {
+public:
+    struct Job {
+        coroutine_handle<> handle;
+        const string* request;
+        string* response;
+        Job* next;
+    };
+
+    ReaderPool(int threads, SnapshotWriter::Notify n, void* c)
+        : notify(n), context(c), queueHead(nullptr), queueTail(nullptr), done(nullptr), stopping(false),
+        outstanding(0), count(threads), workers(new thread[threads]) {
+        for (int t = 0; t < count; t++) workers[t] = thread(&ReaderPool::run, this);
+    }
+
+    ~ReaderPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (int t = 0; t < count; t++) workers[t].join();
+        delete[] workers;
+    }
+
+    ReaderPool(const ReaderPool&) = delete;
+    ReaderPool& operator=(const ReaderPool&) = delete;
+
+    void submit(Job* job) {
+        job->next = nullptr;
+        {
+            lock_guard<mutex> guard(lock);
+            if (queueTail) queueTail->next = job;
+            else queueHead = job;
+            queueTail = job;
+        }
+        outstanding++;
+        wake.notify_one();
+    }
+
+    // Called on the loop thread once a reader has notified.
+    void completed() {
+        Job* job;
+        {
+            lock_guard<mutex> guard(lock);
+            job = done;
+            done = nullptr;
+        }
+        while (job) {
+            Job* next = job->next;  // resuming frees the job
+            outstanding--;
+            job->handle.resume();
+            job = next;
+        }
+    }
+
+    bool idle() const { return outstanding == 0; }
+
+private:
+    void run();
+
+    SnapshotWriter::Notify notify;
+    void* context;
+    mutex lock;
+    condition_variable wake;
+    Job* queueHead;
+    Job* queueTail;
+    Job* done;
+    bool stopping;
+    int outstanding;  // loop thread only
+    int count;
+    thread* workers;
+};
+
+// co_await ReadAwaiter(pool, request, response): resumes once a reader has
+// written the response.
+class ReadAwaiter {
+public:
+    ReadAwaiter(ReaderPool& p, const string& request, string& response) : pool(p) {
+        job.request = &request;
+        job.response = &response;
+    }
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(coroutine_handle<> handle) {
+        job.handle = handle;
+        pool.submit(&job);
+    }
+    void await_resume() const noexcept {}
+
+private:
+    ReaderPool& pool;
+    ReaderPool::Job job;
+};
+
+#endif
+
+class ReservationServer {
+public:
+    static const int MAX_READERS = 32;
+
+    static int run(const string& socketPath, int port, int readers);
+    static void handle(const string& request, string& response, bool& closeAfter, unsigned& dirty);
+    // SCHEDULE, FLIGHT, CUSTOMER and SEARCH: requests that change nothing.
+    static bool isRead(const string& request);
+    // Answers a read request; on a reader thread only inside a ReadGuard.
+    static void read(const string& command, istringstream& args, string& response);
+
+private:
+    // The record as a read request sees it: the published version once
+    // Snapshots::enabled, else copied from the live record.
+    static const FlightView* viewOf(const Flight* flight, FlightView& copy);
+    static const CustomerView* viewOf(const Customer* customer, CustomerView& copy);
+    static void appendFlight(const FlightView& flight, string& out);
+    static void book(istringstream& args, string& response, unsigned& dirty);
+    static void cancel(istringstream& args, string& response, unsigned& dirty);
+    static void customerInfo(istringstream& args, string& response);
+    static void customerRange(istringstream& args, string& response);
+    static void search(istringstream& args, string& response);
+    static void waitlist(istringstream& args, string& response, unsigned& dirty);
+    static void hold(istringstream& args, string& response);
+    static void confirm(istringstream& args, string& response, unsigned& dirty);
+    static void departures(istringstream& args, string& response);
+    static void update(istringstream& args, string& response, unsigned& dirty);
+};
+
+const FlightView* ReservationServer::viewOf(const Flight* flight, FlightView& copy) {
+    if (Snapshots::enabled) return flight->snapshot();
+    flight->capture(copy);
+    return &copy;
+}
+
+const CustomerView* ReservationServer::viewOf(const Customer* customer, CustomerView& copy) {
+    if (Snapshots::enabled) return customer->snapshot();
+    customer->capture(copy);
+    return &copy;
+}
+
+void ReservationServer::appendFlight(const FlightView& flight, string& out) {
+    out += to_string(flight.flightNo);
+    out += ',';
+    out += flight.from;
+    out += ',';
+    out += flight.to;
+    out += ',';
+    out += formatTime(flight.leave);
+    out += ',';
+    out += formatTime(flight.arrive);
+    out += ',';
+    out += to_string(flight.cost);
+    out += ',';
+    out += to_string(flight.businessSeats - flight.bookedBusinessSeats - flight.heldBusinessSeats);
+    out += ',';
+    out += to_string(flight.economySeats - flight.bookedEconomySeats - flight.heldEconomySeats);
+    out += ',';
+    out += flight.weather;
+    out += ',';
+    out += flight.dayOfWeek;
+}
+
+void ReservationServer::book(istringstream& args, string& response, unsigned& dirty) {
+    int passport, num, date;
+    string flightRef, cabin, mode;
+    if (!(args >> passport >> flightRef >> cabin) || !parseFlightRef(flightRef, num, date)
+        || (cabin != "B" && cabin != "E") || ((args >> mode) && mode != "OVERBOOK")) {
+        response = "ERR usage: BOOK <passport> <flight>[@YYYY-MM-DD] B|E [OVERBOOK]";
+        return;
+    }
 
+    Customer* customer = customerBST.find(passport);
     Flight* flight = flightBST.find(num);
-    if (!flight) {
-        cout << "Flight not found!\n";
+    if (!customer) { response = "ERR unknown passport"; return; }
+    if (!flight) { response = "ERR unknown flight"; return; }
+    if (date && date < today()) { response = "ERR departure date has passed"; return; }
+    if (date && !flight->operatesOn(date)) { response = "ERR no departure on that date"; return; }
+
+    bool businessClass = cabin == "B";
+    if (flight->seatsLeft(businessClass, !mode.empty(), date) <= 0) {
+        response = "ERR cabin full";
         return;
     }
 
-    // Check if any seats are available at all
-    if (flight->getAvailableBusinessSeats() <= 0 && flight->getAvailableEconomySeats() <= 0) {
-        cout << "\nThis flight is fully booked (both business and economy classes).\n";
-        cout << "Would you like to join the waiting queue? (y/n): ";
-        getline(cin, choice);
+    Money price = customer->quote(flight, businessClass, date);
+    customer->confirmBooking(num, businessClass, price, date);
+    dirty |= PERSIST_FLIGHTS | PERSIST_CUSTOMERS;
+    response = "OK " + price.str();
+}
 
-        if (choice == "y" || choice == "Y") {
-            // Find or create queue for this flight
-            Queue* flightQueue = nullptr;
-            for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-                if (num == qnode->data.getNo()) {
-                    flightQueue = &qnode->data;
-                    break;
-                }
-            }
+void ReservationServer::cancel(istringstream& args, string& response, unsigned& dirty) {
+    int passport, num, date;
+    string flightRef;
+    if (!(args >> passport >> flightRef) || !parseFlightRef(flightRef, num, date)) {
+        response = "ERR usage: CANCEL <passport> <flight>[@YYYY-MM-DD]";
+        return;
+    }
 
-            if (!flightQueue) {
-                // Create new queue if it doesn't exist
-                Queue newQueue(num);
-                qlist.push_back(newQueue);
-                flightQueue = &qlist.getTail()->data;
-            }
+    Money refund;
+    if (!Customer::cancelBooking(passport, num, refund, date)) {
+        response = "ERR no such booking";
+        return;
+    }
+    dirty |= PERSIST_FLIGHTS | PERSIST_CUSTOMERS | PERSIST_QUEUES;
+    response = "OK " + refund.str();
+}
 
-            // Add customer to queue
-            flightQueue->enqueue(*this);
-            int queuePosition = flightQueue->getSize();
+void ReservationServer::search(istringstream& args, string& response) {
+    // A search marks its matches in the index, so readers take turns
+    static mutex searchLock;
+    const int LIMIT = 10;
+    string query;
+    getline(args, query);
+    if (NameIndex::normalize(query).empty()) {
+        response = "ERR usage: SEARCH <surname> [first name]";
+        return;
+    }
+    NameIndex::Match matches[LIMIT];
+    int found;
+    {
+        lock_guard<mutex> guard(searchLock);
+        found = customerNames.search(query, matches, LIMIT);
+    }
 
-            // Add to BST
-            Customer* newCustomer = new Customer(*this);
-            customerBST.insert(newCustomer->getPassport(), newCustomer);
+    response = "OK " + to_string(found) + " ";
+    for (int i = 0; i < found; i++) {
+        const Customer* customer = customerBST.find(matches[i].passport);
+        CustomerView copy;
+        const CustomerView* view = customer ? viewOf(customer, copy) : nullptr;
+        if (i > 0) response += ';';
+        response += to_string(matches[i].passport) + "," + (view ? view->name : "") + ","
+            + (view ? view->surname : "") + "," + to_string(matches[i].distance);
+    }
+}
 
-            // Save to file
-            Customer::saveToFile();
-            Queue::saveToFile();
+void ReservationServer::customerInfo(istringstream& args, string& response) {
+    int passport;
+    if (!(args >> passport)) {
+        response = "ERR usage: CUSTOMER <passport>";
+        return;
+    }
+    Customer* customer = customerBST.find(passport);
+    CustomerView copy;
+    const CustomerView* view = customer ? viewOf(customer, copy) : nullptr;
+    if (!view) {
+        response = "ERR unknown passport";
+        return;
+    }
 
-            cout << "\nYou have been added to the waiting queue for Flight " << num << ".\n";
-            cout << "Your position in queue: " << queuePosition << endl;
-            cout << "You will be automatically notified if a seat becomes available.\n";
-        }
-        else {
-            cout << "You were not added to the waiting queue.\n";
+    response = "OK " + to_string(view->passport) + "," + view->name + "," + view->surname + ","
+        + view->nationality + "," + to_string(static_cast<int>(view->discount)) + ","
+        + view->totalSpent.str() + ",";
+    bool first = true;
+    for (const Booking& booking : view->bookings) {
+        if (!first) response += '|';
+        response += to_string(booking.flightNo);
+        if (booking.date) response += '@' + formatDate(booking.date);
+        response += string(":") + (booking.businessClass ? 'B' : 'E') + ':'
+            + to_string(booking.seat) + ':' + (booking.fare.getCents() >= 0 ? booking.fare.str() : "-");
+        first = false;
+    }
+}
+
+void ReservationServer::customerRange(istringstream& args, string& response) {
+    const int LIMIT = 100;
+    int from, to;
+    if (!(args >> from >> to)) {
+        response = "ERR usage: CUSTOMERS <from> <to>";
+        return;
+    }
+
+    int found = 0;
+    string list;
+    for (Customer* customer : customerBST.range(from, to)) {
+        CustomerView copy;
+        const CustomerView* view = viewOf(customer, copy);
+        if (!view) continue;
+        if (found++) list += ';';
+        list += to_string(view->passport) + "," + view->name + "," + view->surname;
+        if (found == LIMIT) break;
+    }
+    response = "OK " + to_string(found) + " " + list;
+}
+
+void ReservationServer::waitlist(istringstream& args, string& response, unsigned& dirty) {
+    string action;
+    args >> action;
+
+    if (action == "JOIN") {
+        int passport, num;
+        if (!(args >> passport >> num)) { response = "ERR usage: WAITLIST JOIN <passport> <flight>"; return; }
+        Customer* customer = customerBST.find(passport);
+        if (!customer) { response = "ERR unknown passport"; return; }
+        if (!Flight::flightExists(num)) { response = "ERR unknown flight"; return; }
+
+        Queue* flightQueue = Queue::forFlight(num, true);
+        flightQueue->enqueue(*customer);
+        dirty |= PERSIST_QUEUES;
+        response = "OK " + to_string(flightQueue->getSize());
+    }
+    else if (action == "SHOW") {
+        int num;
+        if (!(args >> num)) { response = "ERR usage: WAITLIST SHOW <flight>"; return; }
+        Queue* flightQueue = Queue::forFlight(num, false);
+        if (!flightQueue) { response = "OK 0 "; return; }
+
+        response = "OK " + to_string(flightQueue->getSize()) + " ";
+        for (QueueNode* node = flightQueue->getFront(); node; node = node->next) {
+            if (node != flightQueue->getFront()) response += '|';
+            response += to_string(node->Customer.getPassport());
         }
+    }
+    else if (action == "POSITION") {
+        int passport, num;
+        if (!(args >> passport >> num)) { response = "ERR usage: WAITLIST POSITION <passport> <flight>"; return; }
+        Queue* flightQueue = Queue::forFlight(num, false);
+        int position = flightQueue ? flightQueue->getPosition(passport) : -1;
+        if (position < 0) { response = "ERR not waiting"; return; }
+        response = "OK " + to_string(position);
+    }
+    else {
+        response = "ERR unknown WAITLIST action";
+    }
+}
+
+void ReservationServer::hold(istringstream& args, string& response) {
+    int passport, num, date;
+    string flightRef, cabin, mode;
+    if (!(args >> passport >> flightRef >> cabin) || !parseFlightRef(flightRef, num, date)
+        || (cabin != "B" && cabin != "E") || ((args >> mode) && mode != "OVERBOOK")) {
+        response = "ERR usage: HOLD <passport> <flight>[@YYYY-MM-DD] B|E [OVERBOOK]";
+        return;
+    }
+    Customer* customer = customerBST.find(passport);
+    if (!customer) { response = "ERR unknown passport"; return; }
+    Flight* flight = flightBST.find(num);
+    if (!flight) { response = "ERR unknown flight"; return; }
+    if (date && date < today()) { response = "ERR departure date has passed"; return; }
+    if (date && !flight->operatesOn(date)) { response = "ERR no departure on that date"; return; }
+
+    bool businessClass = cabin == "B";
+    Money price = customer->quote(flight, businessClass, date);
+    long long id = SeatHolds::place(num, passport, businessClass, price, !mode.empty(), date);
+    if (id < 0) {
+        response = "ERR cabin full";
         return;
     }
+    response = "OK " + to_string(id) + " " + price.str() + " " + to_string(SeatHolds::getTtlMs());
+}
 
-    // Rest of the booking logic for when seats are available...
-    // (Existing code for seat selection and booking)
+void ReservationServer::confirm(istringstream& args, string& response, unsigned& dirty) {
+    long long id;
+    if (!(args >> id)) {
+        response = "ERR usage: CONFIRM <hold>";
+        return;
+    }
+    SeatHolds::Hold held;
+    if (!SeatHolds::take(id, held)) {
+        response = "ERR no such hold";
+        return;
+    }
+    Customer* customer = customerBST.find(held.passport);
+    if (!customer || !Flight::flightExists(held.flightNo)) {
+        response = "ERR booking no longer possible";
+        return;
+    }
+    customer->confirmBooking(held.flightNo, held.businessClass, held.price, held.date);
+    dirty |= PERSIST_FLIGHTS | PERSIST_CUSTOMERS;
+    response = "OK " + held.price.str();
+}
 
-    // Select class
-    string seatClass;
-    bool businessClass = false;
-    int availableSeats = 0;
-    int priceMultiplier = 1;
+// Looks dates up without materializing them: dates nobody booked report the
+// template's full cabins.
+void ReservationServer::departures(istringstream& args, string& response) {
+    string text;
+    int date;
+    if (!(args >> text) || !parseDate(text, date)) {
+        response = "ERR usage: DEPARTURES <YYYY-MM-DD>";
+        return;
+    }
+    int found = 0;
+    string list;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+        const Flight& flight = node->data;
+        if (!flight.operatesOn(date)) continue;
+        if (found++) list += ';';
+        list += to_string(flight.getFlightNo()) + ',' + flight.getDeparture() + ',' + flight.getDestination() + ','
+            + formatTime(flight.getLeavingTime()) + ',' + formatTime(flight.getArrivingTime())
+            + (flight.arrivesNextDay() ? "+1" : "") + ','
+            + to_string(flight.seatsLeft(true, false, date)) + ',' + to_string(flight.seatsLeft(false, false, date));
+    }
+    response = "OK " + to_string(found) + " " + list;
+}
 
-    do {
-        cout << "\nSelect class:\n";
-        cout << "1. Business Class (2x price, " << flight->getAvailableBusinessSeats() << " available)\n";
-        cout << "2. Economy Class (" << flight->getAvailableEconomySeats() << " available)\n";
-        cout << "Enter your choice (1-2): ";
-        getline(cin, seatClass);
+// Every flight in the request changes, or none does; one persist covers them.
+void ReservationServer::update(istringstream& args, string& response, unsigned& dirty) {
+    string rest, text, error;
+    getline(args, rest);
+    istringstream parts(rest);
+    int segments = 1;
+    for (char c : rest) segments += c == ';';
+    FlightChange* changes = new FlightChange[segments];
+    int n = 0;
+    while (getline(parts, text, ';') && parseFlightChange(text, changes[n], error)) n++;
+    int touched = -1;
+    if (!error.empty()) {
+        response = "ERR " + error;
+    }
+    else if (!n) {
+        response = "ERR usage: UPDATE <flight> field=value ...[;<flight> field=value ...]";
+    }
+    else if ((touched = Flight::applyChanges(changes, n, error)) < 0) {
+        response = "ERR " + error;
+    }
+    delete[] changes;
+    if (touched < 0) return;
+    dirty |= PERSIST_FLIGHTS;
+    response = "OK " + to_string(touched);
+}
 
-        if (seatClass == "1") {
-            businessClass = true;
-            availableSeats = flight->getAvailableBusinessSeats();
-            priceMultiplier = 2;
-            if (availableSeats <= 0) {
-                cout << "No available business class seats!\n";
-                continue;
-            }
+bool ReservationServer::isRead(const string& request) {
+    size_t end = request.find(' ');
+    string command = request.substr(0, end);
+    return command == "SCHEDULE" || command == "FLIGHT" || command == "CUSTOMER" || command == "CUSTOMERS"
+        || command == "SEARCH";
+}
+
+void ReservationServer::read(const string& command, istringstream& args, string& response) {
+    if (command == "SCHEDULE") {
+        int found = 0;
+        string list;
+        for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+            FlightView copy;
+            const FlightView* view = viewOf(&node->data, copy);
+            if (!view) continue;
+            if (found++) list += ';';
+            appendFlight(*view, list);
+        }
+        response = "OK " + to_string(found) + " " + list;
+    }
+    else if (command == "FLIGHT") {
+        int num;
+        Flight* flight = (args >> num) ? flightBST.find(num) : nullptr;
+        FlightView copy;
+        const FlightView* view = flight ? viewOf(flight, copy) : nullptr;
+        if (view) {
+            response = "OK ";
+            appendFlight(*view, response);
+        }
+        else {
+            response = "ERR unknown flight";
+        }
+    }
+    else if (command == "CUSTOMER") {
+        customerInfo(args, response);
+    }
+    else if (command == "CUSTOMERS") {
+        customerRange(args, response);
+    }
+    else if (command == "SEARCH") {
+        search(args, response);
+    }
+}
+
+void ReservationServer::handle(const string& request, string& response, bool& closeAfter, unsigned& dirty) {
+    istringstream args(request);
+    string command;
+    args >> command;
+    closeAfter = false;
+    dirty = 0;
+
+    if (command == "PING") {
+        response = "OK PONG";
+    }
+    else if (isRead(command)) {
+        read(command, args, response);
+    }
+    else if (command == "BOOK") {
+        book(args, response, dirty);
+    }
+    else if (command == "CANCEL") {
+        cancel(args, response, dirty);
+    }
+    else if (command == "WAITLIST") {
+        waitlist(args, response, dirty);
+    }
+    else if (command == "HOLD") {
+        hold(args, response);
+    }
+    else if (command == "DEPARTURES") {
+        departures(args, response);
+    }
+    else if (command == "UPDATE") {
+        update(args, response, dirty);
+    }
+    else if (command == "CONFIRM") {
+        confirm(args, response, dirty);
+    }
+    else if (command == "RELEASE") {
+        long long id;
+        response = (args >> id) && SeatHolds::release(id) ? "OK" : "ERR no such hold";
+    }
+    else if (command == "STATS") {
+        ostringstream json;
+        Stats::displayJson(json);
+        response = "OK " + json.str();
+    }
+    else if (command == "MEMSTATS") {
+        ostringstream json;
+        writeMemoryReport(json);
+        response = "OK " + json.str();
+    }
+    else if (command == "QUIT") {
+        response = "OK BYE";
+        closeAfter = true;
+    }
+    else {
+        response = "ERR unknown command";
+    }
+}
+
+#ifdef __linux__
+
+#ifdef FRS_HAVE_COROUTINES
+
+void ReaderPool::run() {
+    Stats::muted = true;
+    while (true) {
+        Job* job;
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this] { return queueHead || stopping; });
+            if (!queueHead) return;
+            job = queueHead;
+            queueHead = job->next;
+            if (!queueHead) queueTail = nullptr;
         }
-        else if (seatClass == "2") {
-            businessClass = false;
-            availableSeats = flight->getAvailableEconomySeats();
-            priceMultiplier = 1;
-            if (availableSeats <= 0) {
-                cout << "No available economy class seats!\n";
-                continue;
-            }
+        {
+            Snapshots::ReadGuard guard;
+            istringstream args(*job->request);
+            string command;
+            args >> command;
+            ReservationServer::read(command, args, *job->response);
         }
-        else {
-            cout << "Invalid choice!\n";
-            continue;
+        {
+            lock_guard<mutex> guard(lock);
+            job->next = done;
+            done = job;
         }
-        break;
-    } while (true);
+        notify(context);
+    }
+}
 
-    if (availableSeats > 0) {
-        float discountRate = getDiscountRate();
-        int originalPrice = flight->getCost() * priceMultiplier;
-        int discountedPrice = originalPrice * (1 - discountRate);
+#endif
 
-        cout << "\nFlight Details:\n";
-        cout << "From: " << flight->getDeparture() << " To: " << flight->getDestination() << "\n";
-        cout << "Class: " << (businessClass ? "Business" : "Economy") << "\n";
-        cout << "Departure: " << flight->getLeavingTime().hour << ":"
-            << (flight->getLeavingTime().min < 10 ? "0" : "") << flight->getLeavingTime().min << "\n";
-        cout << "Original Price: $" << originalPrice << "\n";
+namespace {
 
-        if (discountRate > 0) {
-            cout << "Discount Applied: " << (discountRate * 100) << "%\n";
-            cout << "Discounted Price: $" << discountedPrice << "\n";
-        }
+volatile sig_atomic_t serverStopRequested = 0;
 
-        cout << "\nConfirm booking? (y/n): ";
-        getline(cin, choice);
+void requestServerStop(int) {
+    serverStopRequested = 1;
+}
 
-        if (choice == "y" || choice == "Y") {
-            flights.push_back(num);
+// Most a connection buffers unread: a longer line is refused, and a client
+// pipelining behind a request in flight is not read until it finishes.
+const size_t MAX_INPUT_BYTES = 64 * 1024;
+
+struct Connection {
+    int fd;
+    string input;
+    string output;
+    size_t outputSent;
+    bool closing;
+    bool busy;  // a request is waiting for persistence
+    bool dead;  // peer gone while busy; freed when the request finishes
+};
 
-            // Update the correct seat count
-            Flight::resSeat(num, 1, businessClass);
+struct ServerContext {
+    int epfd;
+#ifdef FRS_HAVE_COROUTINES
+    GroupCommit* commit;
+    ReaderPool* readers;  // null without --readers
+#endif
+};
 
-            totalSpent += discountedPrice;
+// Distinguishes the persistence wake-up descriptor from connections.
+char writerWakeTag;
 
-            // Add to BST
-            Customer* newCustomer = new Customer(*this);
-            customerBST.insert(newCustomer->getPassport(), newCustomer);
+#ifdef FRS_HAVE_COROUTINES
+// Likewise for the snapshot readers' descriptor.
+char readerWakeTag;
 
-            // Save to file
-            Customer::saveToFile();
-            Flight::saveToFile();
+void notifyEventFd(void* context) {
+    uint64_t one = 1;
+    if (write(*static_cast<int*>(context), &one, sizeof(one)) < 0) {
+        cerr << "Error: could not signal the event loop." << endl;
+    }
+}
+#endif
 
-            cout << "Your " << (businessClass ? "Business" : "Economy")
-                << " class flight with No: " << num << " was successfully booked.\n";
-            cout << "Total amount paid: $" << discountedPrice << "\n";
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// Opens the listening socket: a Unix domain socket at path, or 127.0.0.1:port
+// when port is non-zero. Returns -1 on failure.
+int openListener(const string& path, int port) {
+    int fd;
+    if (port > 0) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) { close(fd); return -1; }
+    }
+    else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) { close(fd); return -1; }
+        strcpy(addr.sun_path, path.c_str());
+        // Only a socket left behind by an earlier run is replaced: any
+        // other file, or a socket a live server still accepts on, is kept
+        struct stat existing;
+        if (lstat(path.c_str(), &existing) == 0) {
+            if (!S_ISSOCK(existing.st_mode)) {
+                close(fd);
+                errno = EEXIST;
+                return -1;
+            }
+            int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+            bool live = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+            if (probe >= 0) close(probe);
+            if (live) {
+                close(fd);
+                errno = EADDRINUSE;
+                return -1;
+            }
+            unlink(path.c_str());
+        }
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) { close(fd); return -1; }
+    }
+    if (listen(fd, 512) != 0 || !setNonBlocking(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Connects a blocking client socket; used by the load generator.
+int connectTo(const string& path, int port) {
+    int fd;
+    if (port > 0) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) { close(fd); return -1; }
+    }
+    else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) { close(fd); return -1; }
+        strcpy(addr.sun_path, path.c_str());
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) { close(fd); return -1; }
+    }
+    return fd;
+}
+
+// Writes as much pending output as the socket takes; false on a hard error.
+bool flushConnection(Connection* conn) {
+    while (conn->outputSent < conn->output.size()) {
+        ssize_t n = send(conn->fd, conn->output.data() + conn->outputSent,
+            conn->output.size() - conn->outputSent, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->outputSent += static_cast<size_t>(n);
+        }
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        else if (n < 0 && errno == EINTR) {
+            continue;
         }
         else {
-            cout << "Booking cancelled.\n";
+            return false;
         }
     }
+    conn->output.clear();
+    conn->outputSent = 0;
+    return true;
 }
-void Customer::bookFromQueue(int num) {
-    Customer queueFront;
-    bool found = false;
 
-    // Find the oldest customer in the queue
-    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-        if (num == qnode->data.getNo() && !qnode->data.isEmpty()) {
-            queueFront = qnode->data.oldest();
-            found = true;
-            break;
-        }
+void closeConnection(ServerContext* ctx, Connection* conn) {
+    epoll_ctl(ctx->epfd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    close(conn->fd);
+    if (conn->busy) {
+        conn->dead = true;
     }
+    else {
+        delete conn;
+    }
+}
 
-    if (!found) return;
+void processInput(ServerContext* ctx, Connection* conn);
 
-    // Check if all flights have available seats
-    bool allAvailable = true;
-    for (ListNode<int>* node = queueFront.flights.begin(); node != queueFront.flights.end(); node = node->next) {
-        if (!Flight::checkForSeats(node->data)) {
-            allAvailable = false;
-            break;
-        }
+// Flushes output and re-arms (or closes) the connection after progress.
+void settleConnection(ServerContext* ctx, Connection* conn, bool alive) {
+    if (!flushConnection(conn)) alive = false;
+    bool pending = !conn->output.empty();
+    if (!alive || (conn->closing && !pending && !conn->busy)) {
+        closeConnection(ctx, conn);
+        return;
     }
 
-    if (allAvailable) {
-        // Remove from queues and book flights
-        for (ListNode<int>* node = queueFront.flights.begin(); node != queueFront.flights.end(); node = node->next) {
-            for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-                if (node->data == qnode->data.getNo()) {
-                    QueueNode* qfront = qnode->data.getFront();
-                    while (qfront) {
-                        if (queueFront.passportNo == qfront->Customer.passportNo) {
-                            qnode->data.dequeue();
+    // A full input buffer is not read until a request drains it
+    uint32_t reading = conn->input.size() < MAX_INPUT_BYTES ? static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP) : 0u;
+    epoll_event mod;
+    memset(&mod, 0, sizeof(mod));
+    mod.events = reading | (pending ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    mod.data.ptr = conn;
+    epoll_ctl(ctx->epfd, EPOLL_CTL_MOD, conn->fd, &mod);
+}
 
-                            // Apply discount
-                            Flight* flight = flightBST.find(node->data);
-                            if (flight) {
-                                float discountRate = queueFront.getDiscountRate();
-                                int originalPrice = flight->getCost();
-                                int discountedPrice = originalPrice * (1 - discountRate);
-
-                                // Update Customer's total spent
-                                Customer* customer = customerBST.find(queueFront.passportNo);
-                                if (customer) {
-                                    customer->setTotalSpent(customer->getTotalSpent() + discountedPrice);
-                                }
-                            }
+#ifdef FRS_HAVE_COROUTINES
+// One request: run the handler, wait for its files to be persisted, answer.
+// Requests on one connection run one at a time so responses stay in order.
+DetachedTask serveRequest(ServerContext* ctx, Connection* conn, string request) {
+    string response;
+    bool closeAfter = false;
+    unsigned dirty = 0;
+    bool suspended = false;
+    if (ctx->readers && ReservationServer::isRead(request)) {
+        ReadAwaiter answered(*ctx->readers, request, response);
+        co_await answered;
+        suspended = true;
+    }
+    else {
+        ReservationServer::handle(request, response, closeAfter, dirty);
+    }
 
-                            Flight::resSeat(node->data, 1, false); // Default to economy when booking from queue
-                            break;
-                        }
-                        qfront = qfront->next;
-                    }
-                    break;
-                }
-            }
-        }
+    PersistAwaiter persisted(*ctx->commit, dirty);
+    co_await persisted;
 
-        // Save changes to files
-        Customer::saveToFile();
-        Queue::saveToFile();
+    conn->busy = false;
+    if (conn->dead) {
+        delete conn;
+        co_return;
+    }
+    conn->output += response;
+    conn->output += '\n';
+    conn->closing = closeAfter;
+
+    // Resumed by a reader or the group commit: pick up whatever arrived meanwhile
+    if (suspended || persisted.wasSuspended()) {
+        processInput(ctx, conn);
+        settleConnection(ctx, conn, true);
     }
 }
+#endif
+
+// Runs the complete lines buffered on the connection, one at a time.
+void processInput(ServerContext* ctx, Connection* conn) {
+    size_t newline;
+    while (!conn->closing && !conn->busy && (newline = conn->input.find('\n')) != string::npos) {
+        string request = conn->input.substr(0, newline);
+        conn->input.erase(0, newline + 1);
+        if (!request.empty() && request.back() == '\r') request.pop_back();
+        if (request.empty()) continue;
+
+#ifdef FRS_HAVE_COROUTINES
+        conn->busy = true;
+        serveRequest(ctx, conn, request);
+#else
+        (void)ctx;
+        string response;
+        bool closeAfter;
+        unsigned dirty;
+        ReservationServer::handle(request, response, closeAfter, dirty);
+        persistFiles(dirty);
+        conn->output += response;
+        conn->output += '\n';
+        conn->closing = closeAfter;
+#endif
+    }
 
-void Customer::cancel() {
-    if (customerBST.getAllCustomers().empty()) {
-        cout << "There are no registered clients at the moment!\n";
-        return;
+    // Every complete line is gone, so a full buffer is one endless line
+    if (!conn->closing && !conn->busy && conn->input.size() >= MAX_INPUT_BYTES) {
+        conn->input.clear();
+        conn->output += "ERR request too long\n";
+        conn->closing = true;
     }
+}
 
-    cin.clear();
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+} // namespace
 
-    string passportStr, flightStr;
-    int passport, flightNum;
-    int counter = 1;
+int ReservationServer::run(const string& socketPath, int port, int readers) {
+    int listener = openListener(socketPath, port);
+    if (listener < 0) {
+        cerr << "Error: could not listen on " << (port > 0 ? "port " + to_string(port) : socketPath)
+            << ": " << strerror(errno) << endl;
+        return 1;
+    }
 
-    // Get passport number
-    do {
-        cout << "Please provide your passport number: ";
-        getline(cin, passportStr);
+    ServerContext ctx;
+    ctx.epfd = epoll_create1(0);
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;  // nullptr marks the listener
+    epoll_ctl(ctx.epfd, EPOLL_CTL_ADD, listener, &ev);
+
+    int wakeFd = eventfd(0, EFD_NONBLOCK);
+    ev.data.ptr = &writerWakeTag;
+    epoll_ctl(ctx.epfd, EPOLL_CTL_ADD, wakeFd, &ev);
+#ifdef FRS_HAVE_COROUTINES
+    GroupCommit commit(notifyEventFd, &wakeFd);
+    ctx.commit = &commit;
+
+    // Readers see only published versions, so publishing starts first
+    int readerWakeFd = eventfd(0, EFD_NONBLOCK);
+    ev.data.ptr = &readerWakeTag;
+    epoll_ctl(ctx.epfd, EPOLL_CTL_ADD, readerWakeFd, &ev);
+    if (readers > 0) Snapshots::enable();
+    ReaderPool* pool = readers > 0 ? new ReaderPool(readers, notifyEventFd, &readerWakeFd) : nullptr;
+    ctx.readers = pool;
+#else
+    if (readers > 0) cerr << "Note: --readers needs a C++20 build; every request runs on the loop." << endl;
+#endif
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = requestServerStop;
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    cout << "Serving " << flist.getSize() << " flights and " << customerBST.size() << " customers on "
+        << (port > 0 ? "127.0.0.1:" + to_string(port) : socketPath);
+#ifdef FRS_HAVE_COROUTINES
+    if (pool) cout << " with " << readers << " snapshot readers";
+#endif
+    cout << endl;
 
-        if (!checkNumber(passportStr)) {
-            cout << "Please insert a valid passport number!\n";
-            continue;
+    const int MAX_EVENTS = 256;
+    epoll_event events[MAX_EVENTS];
+    char buffer[16384];
+
+    while (!serverStopRequested) {
+        // Tick often enough to return seats from expired holds on time
+        SeatHolds::expire();
+        WaitlistAging::expire();
+        int timeout = SeatHolds::active() ? static_cast<int>(SeatHolds::HOLD_TICK_MS) : 1000;
+        int ready = epoll_wait(ctx.epfd, events, MAX_EVENTS, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
         }
 
-        passport = stoi(passportStr);
-        if (!Customer::displayCustomerInfo(passport)) {
-            if (counter == 5) {
-                cout << "Wrong passport number was given too many times.\n";
-                return;
+        for (int i = 0; i < ready; i++) {
+            if (events[i].data.ptr == &writerWakeTag) {
+                uint64_t count;
+                if (::read(wakeFd, &count, sizeof(count)) > 0) {
+#ifdef FRS_HAVE_COROUTINES
+                    commit.completed();
+#endif
+                }
+                continue;
             }
-            cout << "Please check your Passport Number.\n";
-            counter++;
-            continue;
-        }
-        break;
-    } while (true);
-
-    // Get flight number to cancel
-    counter = 1;
-    bool flightFound = false;
-    do {
-        cout << "\nWhich flight do you want to cancel (enter the flight number)? ";
-        getline(cin, flightStr);
-
-        if (!checkNumber(flightStr)) {
-            cout << "Please insert a valid flight number!\n";
-            continue;
-        }
-        flightNum = stoi(flightStr);
-
-        // Find the Customer
-        Customer* customer = customerBST.find(passport);
-        if (customer) {
-            // Find the flight in Customer's flights
-            for (ListNode<int>* fnode = customer->flights.begin(); fnode != customer->flights.end(); fnode = fnode->next) {
-                if (flightNum == fnode->data) {
-                    // Calculate refund with discount
-                    Flight* flight = flightBST.find(flightNum);
-                    if (flight) {
-                        float discountRate = customer->getDiscountRate();
-                        int originalPrice = flight->getCost();
-                        int refundAmount = originalPrice * (1 - discountRate);
-
-                        customer->setTotalSpent(customer->getTotalSpent() - refundAmount);
-                        cout << "Refund amount: $" << refundAmount << "\n";
-                    }
-
-                    customer->flights.erase(fnode);
-                    flightFound = true;
-                    break;
+#ifdef FRS_HAVE_COROUTINES
+            if (events[i].data.ptr == &readerWakeTag) {
+                uint64_t count;
+                if (::read(readerWakeFd, &count, sizeof(count)) > 0) pool->completed();
+                continue;
+            }
+#endif
+
+            Connection* conn = static_cast<Connection*>(events[i].data.ptr);
+            if (!conn) {
+                int client;
+                while ((client = accept(listener, nullptr, nullptr)) >= 0) {
+                    setNonBlocking(client);
+                    Connection* accepted = new Connection{ client, string(), string(), 0, false, false, false };
+                    epoll_event cev;
+                    memset(&cev, 0, sizeof(cev));
+                    cev.events = EPOLLIN | EPOLLRDHUP;
+                    cev.data.ptr = accepted;
+                    epoll_ctl(ctx.epfd, EPOLL_CTL_ADD, client, &cev);
                 }
+                continue;
             }
-        }
-
-        if (counter == 5) {
-            cout << "Wrong flight number was given too many times.\n";
-            return;
-        }
-        else if (!flightFound) {
-            cout << "Please check your flight number!.\n";
-            counter++;
-            continue;
-        }
-        break;
-    } while (true);
-
-    // Check if Customer is in any queue
-    bool isInQueue = false;
-    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-        if (flightNum == qnode->data.getNo() && !qnode->data.isEmpty()) {
-            QueueNode* prev = nullptr;
-            QueueNode* current = qnode->data.getFront();
-
-            while (current) {
-                if (passport == current->Customer.getPassport()) {
-                    isInQueue = true;
 
-                    if (current == qnode->data.getFront()) {
-                        qnode->data.setFront(current->next);
-                        if (!qnode->data.getFront()) {
-                            qnode->data.setRear(nullptr);
-                        }
+            bool alive = true;
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                while (conn->input.size() < MAX_INPUT_BYTES) {
+                    ssize_t n = recv(conn->fd, buffer, sizeof(buffer), 0);
+                    if (n > 0) {
+                        conn->input.append(buffer, static_cast<size_t>(n));
+                    }
+                    else if (n == 0) {
+                        alive = false;
+                        break;
                     }
-                    else if (current == qnode->data.getRear()) {
-                        prev->next = nullptr;
-                        qnode->data.setRear(prev);
+                    else if (errno == EINTR) {
+                        continue;
                     }
                     else {
-                        prev->next = current->next;
+                        if (errno != EAGAIN && errno != EWOULDBLOCK) alive = false;
+                        break;
                     }
-
-                    delete current;
-                    qnode->data.setSize(qnode->data.getSize() - 1);
-                    break;
                 }
-                prev = current;
-                current = current->next;
+                processInput(&ctx, conn);
             }
+            settleConnection(&ctx, conn, alive);
         }
+
+#ifdef FRS_HAVE_COROUTINES
+        // Everything that queued up during this round shares one batch
+        commit.pump();
+#endif
     }
 
-    if (!isInQueue) {
-        // Default to economy class when canceling (since we don't track class in queue)
-        Flight::resSeat(flightNum, -1, false);
-        bookFromQueue(flightNum);
+#ifdef FRS_HAVE_COROUTINES
+    // Let requests already waiting for a reader or persistence finish
+    while (!commit.idle() || (pool && !pool->idle())) {
+        commit.pump();
+        pollfd pfds[2] = { { wakeFd, POLLIN, 0 }, { readerWakeFd, POLLIN, 0 } };
+        poll(pfds, 2, 1000);
+        uint64_t count;
+        if (::read(wakeFd, &count, sizeof(count)) > 0) commit.completed();
+        if (::read(readerWakeFd, &count, sizeof(count)) > 0) pool->completed();
     }
+    delete pool;
+    close(readerWakeFd);
+#endif
 
-    // Save changes to files
+    close(listener);
+    close(wakeFd);
+    close(ctx.epfd);
+    if (port <= 0) unlink(socketPath.c_str());
+
+    Flight::saveToFile();
     Customer::saveToFile();
     Queue::saveToFile();
+    cout << "Server stopped." << endl;
+    return 0;
+}
 
-    cout << "\nYour reservation was successfully removed!\n\n";
+// ---------------------------------------------------------------------------
+// Load generator
+// ---------------------------------------------------------------------------
+
+struct LoadgenResult {
+    LatencyHistogram latency;
+    unsigned long long requests;
+    unsigned long long errors;
+    unsigned long long failedConnects;
+};
+
+// Sends one request and waits for its response line; false on I/O failure.
+bool roundTrip(int fd, const string& request, string& pending, string& response) {
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+
+    char buffer[16384];
+    size_t newline;
+    while ((newline = pending.find('\n')) == string::npos) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            return false;
+        }
+        pending.append(buffer, static_cast<size_t>(n));
+    }
+    response.assign(pending, 0, newline);
+    pending.erase(0, newline + 1);
+    return true;
 }
 
-bool Customer::displayCustomerInfo(int passport) {
-    Customer* customer = customerBST.find(passport);
-    if (customer) {
-        cout << "\n\t\t\t\t CustomerAL INFO\n\n";
-        cout << left << setw(15) << "NAME" << left << setw(15) << "SURNAME" << left << setw(15) << "PASSPORT_No"
-            << left << setw(15) << "NATIONALITY" << left << setw(15) << "ADDRESS" << left << setw(15) << "TELEPHONE"
-            << left << setw(20) << "DISCOUNT" << left << setw(15) << "TOTAL SPENT" << endl;
+// One closed-loop client: a mix of flight and customer queries, bookings
+// (each followed later by its cancellation) and waitlist reads.
+void loadgenClient(const string& path, int port, int requests, const int* flights, int flightCount,
+    int passportBase, int customers, unsigned long long seed, LoadgenResult* result) {
+    int fd = connectTo(path, port);
+    if (fd < 0) {
+        result->failedConnects++;
+        return;
+    }
 
-        string discountStr;
-        switch (customer->discount) {
-        case offers::STUDENT: discountStr = "Student (15%)"; break;
-        case offers::SENIOR: discountStr = "Senior (20%)"; break;
-        case offers::MILITARY: discountStr = "Military (10%)"; break;
-        case offers::FREQUENT_FLYER: discountStr = "Frequent Flyer (25%)"; break;
-        case offers::NONE: discountStr = "None"; break;
+    FastRng rng(seed);
+    string pending, response;
+    int heldPassport = -1, heldFlight = -1;
+
+    for (int i = 0; i < requests; i++) {
+        int passport = passportBase + static_cast<int>(rng.below(customers));
+        int flight = flights[rng.below(flightCount)];
+        unsigned long long pick = rng.below(100);
+        string request;
+
+        if (heldPassport >= 0 && pick < 10) {
+            request = "CANCEL " + to_string(heldPassport) + " " + to_string(heldFlight) + "\n";
+            heldPassport = -1;
+        }
+        else if (pick < 50) {
+            request = "FLIGHT " + to_string(flight) + "\n";
+        }
+        else if (pick < 70) {
+            request = "CUSTOMER " + to_string(passport) + "\n";
+        }
+        else if (pick < 90) {
+            request = "BOOK " + to_string(passport) + " " + to_string(flight) + (rng.below(10) ? " E\n" : " B\n");
+        }
+        else {
+            request = "WAITLIST SHOW " + to_string(flight) + "\n";
         }
 
-        cout << left << setw(15) << customer->name << left << setw(15) << customer->surname
-            << left << setw(15) << customer->passportNo << left << setw(15) << customer->nationality
-            << left << setw(15) << customer->address << left << setw(15) << customer->tel
-            << left << setw(20) << discountStr << left << setw(15) << "$" + to_string(customer->totalSpent) << endl << endl;
+        unsigned long long start = nowNanos();
+        if (!roundTrip(fd, request, pending, response)) {
+            result->errors++;
+            break;
+        }
+        result->latency.record(nowNanos() - start);
+        result->requests++;
 
-        cout << "Your flight(s): ";
-        for (ListNode<int>* fnode = customer->flights.begin(); fnode != customer->flights.end(); fnode = fnode->next) {
-            cout << fnode->data << "  ";
+        if (response.compare(0, 3, "ERR") == 0) {
+            result->errors++;
+        }
+        else if (request.compare(0, 4, "BOOK") == 0 && heldPassport < 0) {
+            heldPassport = passport;
+            heldFlight = flight;
         }
-        cout << endl;
-        return true;
     }
-    cout << "Passport number was not found. Check again!\n";
-    return false;
+
+    roundTrip(fd, "QUIT\n", pending, response);
+    close(fd);
 }
 
-bool Customer::uniquePass(int passport) {
-    return !customerBST.exists(passport);
+// --loadgen [--socket=PATH | --port=N] [--clients=8] [--requests=2000]
+//           [--customers=N] [--passport-base=1000000]
+// Passports are assumed to follow the generator's numbering.
+int loadgenMain(int argc, char** argv) {
+    const char* socketArg = findOption(argc, argv, "socket");
+    string path = socketArg ? socketArg : "frs.sock";
+    int port = static_cast<int>(optionInt(argc, argv, "port", 0));
+    int clients = static_cast<int>(optionInt(argc, argv, "clients", 8));
+    int requests = static_cast<int>(optionInt(argc, argv, "requests", 2000));
+    int customers = static_cast<int>(optionInt(argc, argv, "customers", 10000));
+    int passportBase = static_cast<int>(optionInt(argc, argv, "passport-base", 1000000));
+    unsigned long long seed = static_cast<unsigned long long>(optionInt(argc, argv, "seed", 42));
+    if (clients < 1) clients = 1;
+    if (customers < 1) customers = 1;
+
+    // Learn the flight numbers from the server itself
+    int fd = connectTo(path, port);
+    if (fd < 0) {
+        cerr << "Error: could not connect to the server: " << strerror(errno) << endl;
+        return 1;
+    }
+    string pending, schedule;
+    bool ok = roundTrip(fd, "SCHEDULE\n", pending, schedule);
+    string bye;
+    roundTrip(fd, "QUIT\n", pending, bye);
+    close(fd);
+    if (!ok || schedule.compare(0, 3, "OK ") != 0) {
+        cerr << "Error: could not read the schedule." << endl;
+        return 1;
+    }
+
+    istringstream scheduleStream(schedule.substr(3));
+    int flightCount = 0;
+    scheduleStream >> flightCount;
+    if (flightCount <= 0) {
+        cerr << "Error: the server has no flights." << endl;
+        return 1;
+    }
+    int* flights = new int[flightCount];
+    string entry;
+    scheduleStream.get();
+    for (int i = 0; i < flightCount && getline(scheduleStream, entry, ';'); i++) {
+        flights[i] = atoi(entry.c_str());
+    }
+
+    LoadgenResult* results = new LoadgenResult[clients];
+    thread* workers = new thread[clients];
+    unsigned long long start = nowNanos();
+    for (int c = 0; c < clients; c++) {
+        results[c].requests = results[c].errors = results[c].failedConnects = 0;
+        workers[c] = thread(loadgenClient, path, port, requests, flights, flightCount,
+            passportBase, customers, seed + static_cast<unsigned long long>(c) * 7919, &results[c]);
+    }
+    for (int c = 0; c < clients; c++) workers[c].join();
+    unsigned long long elapsed = nowNanos() - start;
+
+    LoadgenResult total;
+    total.requests = total.errors = total.failedConnects = 0;
+    for (int c = 0; c < clients; c++) {
+        total.latency.merge(results[c].latency);
+        total.requests += results[c].requests;
+        total.errors += results[c].errors;
+        total.failedConnects += results[c].failedConnects;
+    }
+
+    cout << "{\"benchmark\":\"loadgen\",\"clients\":" << clients
+        << ",\"requests\":" << total.requests
+        << ",\"error_responses\":" << total.errors
+        << ",\"failed_connects\":" << total.failedConnects
+        << ",\"seconds\":" << elapsed / 1e9
+        << ",\"qps\":" << (elapsed ? total.requests * 1e9 / elapsed : 0.0)
+        << ",\"latency_us\":{\"mean\":" << total.latency.mean() / 1000.0
+        << ",\"p50\":" << total.latency.percentile(0.50) / 1000.0
+        << ",\"p90\":" << total.latency.percentile(0.90) / 1000.0
+        << ",\"p99\":" << total.latency.percentile(0.99) / 1000.0
+        << ",\"p999\":" << total.latency.percentile(0.999) / 1000.0
+        << ",\"max\":" << total.latency.max() / 1000.0 << "}}" << endl;
+
+    delete[] workers;
+    delete[] results;
+    delete[] flights;
+    return 0;
 }
 
-void Queue::enqueue(const Customer& p) {
-    QueueNode* newNode = new QueueNode{ p, nullptr, time(nullptr) };
-    size++;
+#else
+
+int ReservationServer::run(const string&, int, int) {
+    cerr << "Server mode is only available on Linux." << endl;
+    return 1;
+}
+
+int loadgenMain(int, char**) {
+    cerr << "The load generator is only available on Linux." << endl;
+    return 1;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Persistence pipeline benchmark
+//
+// Replays one mixed request stream two ways: a thread per request that saves
+// its dirty files before answering (the old server behaviour), and request
+// coroutines that share group commits on the writer thread.
+// ---------------------------------------------------------------------------
+
+struct AsyncBenchResult {
+    LatencyHistogram latency;
+    unsigned long long elapsedNs;
+    unsigned long long persists;
+};
+
+// Loads the generated dataset and builds count requests against it.
+string* buildAsyncRequests(const GeneratorConfig& cfg, int count) {
+    generateDataset(cfg);
+    freeAllCustomers();
+    Flight::loadFromFile();
+    Customer::loadFromFile();
+    Queue::loadFromFile();
 
-    if (!rear) {
-        front = rear = newNode;
+    int flightCount = flist.getSize();
+    int customerCount = customerBST.size();
+    int* flightNos = new int[flightCount > 0 ? flightCount : 1];
+    int* passports = new int[customerCount > 0 ? customerCount : 1];
+    int i = 0;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+        flightNos[i++] = node->data.getFlightNo();
     }
-    else {
-        rear->next = newNode;
-        rear = newNode;
+    i = 0;
+    for (CustomerBST::Iterator it = customerBST.begin(); it != customerBST.end(); ++it) {
+        passports[i++] = it.key();
     }
-}
 
-void Queue::dequeue() {
-    if (!front) return;
+    FastRng rng(cfg.seed + 1);
+    string* requests = new string[count];
+    int heldPassport = -1, heldFlight = -1;
+    for (int r = 0; r < count; r++) {
+        int passport = passports[rng.below(customerCount)];
+        int flight = flightNos[rng.below(flightCount)];
+        unsigned long long pick = rng.below(100);
+
+        if (heldPassport >= 0 && pick < 10) {
+            requests[r] = "CANCEL " + to_string(heldPassport) + " " + to_string(heldFlight);
+            heldPassport = -1;
+        }
+        else if (pick < 40) {
+            requests[r] = "BOOK " + to_string(passport) + " " + to_string(flight) + " E";
+            heldPassport = passport;
+            heldFlight = flight;
+        }
+        else if (pick < 50) {
+            requests[r] = "WAITLIST JOIN " + to_string(passport) + " " + to_string(flight);
+        }
+        else if (pick < 75) {
+            requests[r] = "FLIGHT " + to_string(flight);
+        }
+        else {
+            requests[r] = "CUSTOMER " + to_string(passport);
+        }
+    }
 
-    QueueNode* temp = front;
-    front = front->next;
-    size--;  // Maintain size
+    delete[] flightNos;
+    delete[] passports;
+    return requests;
+}
 
-    if (!front) {
-        rear = nullptr;
+void benchBlockingPersist(const string* requests, int count, int concurrency, AsyncBenchResult& result) {
+    mutex engine;
+    LatencyHistogram* latencies = new LatencyHistogram[concurrency];
+    thread* workers = new thread[concurrency];
+    unsigned long long persists = 0;
+
+    unsigned long long start = nowNanos();
+    for (int wave = 0; wave < count; wave += concurrency) {
+        int width = count - wave < concurrency ? count - wave : concurrency;
+        for (int w = 0; w < width; w++) {
+            workers[w] = thread([&, w, wave] {
+                unsigned long long begin = nowNanos();
+                string response;
+                bool closeAfter;
+                unsigned dirty;
+                lock_guard<mutex> guard(engine);
+                ReservationServer::handle(requests[wave + w], response, closeAfter, dirty);
+                persistFiles(dirty);
+                if (dirty) persists++;
+                latencies[w].record(nowNanos() - begin);
+            });
+        }
+        for (int w = 0; w < width; w++) workers[w].join();
     }
+    result.elapsedNs = nowNanos() - start;
 
-    delete temp;
+    for (int w = 0; w < concurrency; w++) result.latency.merge(latencies[w]);
+    result.persists = persists;
+    delete[] workers;
+    delete[] latencies;
 }
 
-void Queue::clear() {
-    while (front) {
-        QueueNode* temp = front;
-        front = front->next;
-        delete temp;
+#ifdef FRS_HAVE_COROUTINES
+
+struct AsyncBenchDriver {
+    mutex lock;
+    condition_variable wake;
+    bool written;
+    int inflight;
+    int finished;
+    LatencyHistogram latency;
+};
+
+void notifyAsyncBench(void* context) {
+    AsyncBenchDriver* driver = static_cast<AsyncBenchDriver*>(context);
+    {
+        lock_guard<mutex> guard(driver->lock);
+        driver->written = true;
     }
-    rear = nullptr;
-    size = 0;
+    driver->wake.notify_one();
 }
 
-Customer Queue::oldest() const {
-    if (front) {
-        return front->Customer;
-    }
-    throw runtime_error("Queue is empty");
+DetachedTask benchRequest(AsyncBenchDriver& driver, GroupCommit& commit, const string& request) {
+    unsigned long long begin = nowNanos();
+    string response;
+    bool closeAfter;
+    unsigned dirty;
+    ReservationServer::handle(request, response, closeAfter, dirty);
+    co_await PersistAwaiter(commit, dirty);
+    driver.latency.record(nowNanos() - begin);
+    driver.inflight--;
+    driver.finished++;
 }
 
-int Queue::getPosition(int passport) const {
-    int position = 1;
-    QueueNode* current = front;
-    while (current) {
-        if (current->Customer.getPassport() == passport) {
-            return position;
+void benchGroupCommit(const string* requests, int count, int concurrency, AsyncBenchResult& result) {
+    AsyncBenchDriver driver;
+    driver.written = false;
+    driver.inflight = 0;
+    driver.finished = 0;
+    GroupCommit commit(notifyAsyncBench, &driver);
+
+    unsigned long long start = nowNanos();
+    int next = 0;
+    while (driver.finished < count) {
+        while (next < count && driver.inflight < concurrency) {
+            driver.inflight++;
+            benchRequest(driver, commit, requests[next++]);
+        }
+        commit.pump();
+        if (commit.writing()) {
+            unique_lock<mutex> guard(driver.lock);
+            driver.wake.wait(guard, [&driver] { return driver.written; });
+            driver.written = false;
+            guard.unlock();
+            commit.completed();
         }
-        current = current->next;
-        position++;
     }
-    return -1; // Not found
+    result.elapsedNs = nowNanos() - start;
+    result.latency.merge(driver.latency);
+    result.persists = commit.batchCount();
 }
 
-void Queue::display(int num) {
-    for (ListNode<Queue>* node = qlist.begin(); node != qlist.end(); node = node->next) {
-        if (num == node->data.getNo()) {
-            QueueNode* current = node->data.getFront();
-
-            if (!current) {
-                cout << "\nEmpty queue.\n";
-            }
-            else {
-                cout << "\nPassengers waiting in queue:\n";
-                cout << left << setw(15) << "Passport" << left << setw(15) << "Name" << left << setw(15) << "Surname"
-                    << left << setw(20) << "Discount" << left << setw(15) << "Wait Time" << endl;
+#endif
 
-                while (current) {
-                    string discountStr;
-                    switch (current->Customer.getDiscount()) {
-                    case offers::STUDENT: discountStr = "Student (15%)"; break;
-                    case offers::SENIOR: discountStr = "Senior (20%)"; break;
-                    case offers::MILITARY: discountStr = "Military (10%)"; break;
-                    case offers::FREQUENT_FLYER: discountStr = "Frequent Flyer (25%)"; break;
-                    case offers::NONE: discountStr = "None"; break;
-                    }
+void writeAsyncBenchResult(ostream& out, const char* variant, int count, const AsyncBenchResult& result) {
+    double seconds = result.elapsedNs / 1e9;
+    out << "{\"variant\":\"" << variant << "\",\"seconds\":" << seconds
+        << ",\"rps\":" << (seconds > 0 ? count / seconds : 0.0)
+        << ",\"persist_batches\":" << result.persists
+        << ",\"latency_us\":{\"p50\":" << result.latency.percentile(0.50) / 1000.0
+        << ",\"p99\":" << result.latency.percentile(0.99) / 1000.0
+        << ",\"max\":" << result.latency.max() / 1000.0 << "}}";
+}
 
-                    cout << left << setw(15) << current->Customer.getPassport()
-                        << left << setw(15) << current->Customer.getName()
-                        << left << setw(15) << current->Customer.getSurname()
-                        << left << setw(20) << discountStr
-                        << left << setw(15) << difftime(time(nullptr), current->joinTime) / 60 << " mins" << endl;
-                    current = current->next;
-                }
-            }
-            return;
-        }
-    }
+// --bench-async [--requests=5000] [--concurrency=64] [generator options]
+int benchAsyncMain(int argc, char** argv) {
+#ifdef FRS_HAVE_COROUTINES
+    GeneratorConfig cfg = generatorConfigFromArgs(argc, argv);
+    int count = static_cast<int>(optionInt(argc, argv, "requests", 5000));
+    int concurrency = static_cast<int>(optionInt(argc, argv, "concurrency", 64));
+    if (count < 1) count = 1;
+    if (concurrency < 1) concurrency = 1;
+    if (dataDirectory.empty()) dataDirectory = "bench_data/";
+    makeDirectory(dataDirectory);
+
+    NullBuffer nullBuffer;
+    streambuf* console = cout.rdbuf(&nullBuffer);
+
+    // Each variant starts from the same freshly generated files
+    AsyncBenchResult blocking;
+    string* requests = buildAsyncRequests(cfg, count);
+    benchBlockingPersist(requests, count, concurrency, blocking);
+    delete[] requests;
+
+    AsyncBenchResult grouped;
+    requests = buildAsyncRequests(cfg, count);
+    benchGroupCommit(requests, count, concurrency, grouped);
+    delete[] requests;
+
+    cout.rdbuf(console);
+    cout << "{\"benchmark\":\"async_pipeline\",\"requests\":" << count << ",\"concurrency\":" << concurrency
+        << ",\"flights\":" << cfg.flights << ",\"customers\":" << cfg.customers << ",\"results\":[";
+    writeAsyncBenchResult(cout, "thread_per_request", count, blocking);
+    cout << ",";
+    writeAsyncBenchResult(cout, "coroutine_group_commit", count, grouped);
+    cout << "]}" << endl;
+    return 0;
+#else
+    (void)argc;
+    (void)argv;
+    cerr << "The async pipeline needs C++20 coroutines; rebuild with -std=c++20." << endl;
+    return 1;
+#endif
 }
 
-void Flight::updateFlight(int flightNo) {
-    string temp;
-    Flight* flight = flightBST.find(flightNo);
+// ---------------------------------------------------------------------------
+// File I/O benchmark
+// ---------------------------------------------------------------------------
 
-    if (!flight) {
-        cout << "Flight with number " << flightNo << " does not exist!\n";
+void benchIoBackend(IoBackend backend, const FileWrite* snapshots, unsigned long long bytes, int rounds,
+    ostream& out) {
+    IoBackend previous = FileIO::backend();
+    out << "{\"backend\":\"" << (backend == IO_URING ? "io_uring" : "posix") << "\"";
+    if (!FileIO::select(backend)) {
+        out << ",\"available\":false}";
         return;
     }
 
-    cout << "Update flight with the following attributes (leave blank to keep current value):\n";
-    cin.clear();
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-
-    // Departure
-    do {
-        cout << "Current Departure: " << flight->from << "\n";
-        cout << "Departure: ";
-        getline(cin, temp);
+    unsigned long long t0 = nowNanos();
+    bool ok = true;
+    for (int r = 0; r < rounds; r++) ok = FileIO::writeFiles(snapshots, 3) && ok;
+    unsigned long long writeNs = nowNanos() - t0;
 
-        if (!temp.empty()) {
-            if (temp.length() > 20 || !checkString(temp)) {
-                cout << "Please insert a valid Departure city!\n";
-                continue;
-            }
-            flight->from = temp;
+    string contents;
+    t0 = nowNanos();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < 3; i++) {
+            ok = FileIO::readFile(snapshots[i].path, contents) && contents == *snapshots[i].data && ok;
         }
-        break;
-    } while (true);
+    }
+    unsigned long long readNs = nowNanos() - t0;
 
-    // Destination
-    do {
-        cout << "Current Destination: " << flight->to << "\n";
-        cout << "Destination: ";
-        getline(cin, temp);
+    // The real load and save paths, including parsing and serialization
+    freeAllCustomers();
+    t0 = nowNanos();
+    Flight::loadFromFile();
+    Customer::loadFromFile();
+    Queue::loadFromFile();
+    unsigned long long loadNs = nowNanos() - t0;
+    t0 = nowNanos();
+    Flight::saveToFile();
+    Customer::saveToFile();
+    Queue::saveToFile();
+    unsigned long long saveNs = nowNanos() - t0;
+
+    double megabytes = static_cast<double>(bytes) * rounds / (1024.0 * 1024.0);
+    out << ",\"available\":true,\"verified\":" << (ok ? "true" : "false")
+        << ",\"write_mb_s\":" << (writeNs ? megabytes / (writeNs / 1e9) : 0.0)
+        << ",\"read_mb_s\":" << (readNs ? megabytes / (readNs / 1e9) : 0.0)
+        << ",\"load_ms\":" << loadNs / 1e6
+        << ",\"save_ms\":" << saveNs / 1e6 << "}";
+    FileIO::select(previous);
+}
 
-        if (!temp.empty()) {
-            if (temp.length() > 20 || !checkString(temp) || temp == flight->from) {
-                cout << "Please insert a valid Destination city!\n";
-                continue;
-            }
-            flight->to = temp;
-        }
-        break;
-    } while (true);
+// --bench-io [--rounds=5] [generator options]
+// Writes and reads the three data files with each backend (every write is
+// fsynced), then times the full load and save paths.
+int benchIoMain(int argc, char** argv) {
+    GeneratorConfig cfg = generatorConfigFromArgs(argc, argv);
+    int rounds = static_cast<int>(optionInt(argc, argv, "rounds", 5));
+    if (rounds < 1) rounds = 1;
+    if (dataDirectory.empty()) dataDirectory = "bench_data/";
+    makeDirectory(dataDirectory);
+
+    NullBuffer nullBuffer;
+    streambuf* console = cout.rdbuf(&nullBuffer);
+    generateDataset(cfg);
+
+    static const char* names[3] = { "flights2.txt", "passengers2.txt", "queues2.txt" };
+    string data[3];
+    FileWrite snapshots[3];
+    unsigned long long bytes = 0;
+    for (int i = 0; i < 3; i++) {
+        snapshots[i].path = dataFile(names[i]);
+        FileIO::readFile(snapshots[i].path, data[i]);
+        snapshots[i].data = &data[i];
+        bytes += data[i].size();
+    }
 
-    // Boarding time
-    do {
-        cout << "Current Boarding time: "
-            << setw(2) << setfill('0') << flight->t_leave.hour << ":"
-            << setw(2) << setfill('0') << flight->t_leave.min << "\n";
-        cout << "Boarding time (e.g. 19:40): ";
-        getline(cin, temp);
+    ostringstream json;
+    json << "{\"benchmark\":\"file_io\",\"flights\":" << cfg.flights << ",\"customers\":" << cfg.customers
+        << ",\"bytes\":" << bytes << ",\"rounds\":" << rounds << ",\"results\":[";
+    benchIoBackend(IO_POSIX, snapshots, bytes, rounds, json);
+    json << ",";
+    benchIoBackend(IO_URING, snapshots, bytes, rounds, json);
+    json << "]}";
 
-        if (!temp.empty()) {
-            if (!checkTime(temp)) {
-                cout << "Please insert a valid boarding time (e.g. 19:40)!\n";
-                continue;
-            }
+    cout.rdbuf(console);
+    cout << json.str() << endl;
+    return 0;
+}
 
-            size_t colon = temp.find(':');
-            Time newTime;
-            newTime.hour = stoi(temp.substr(0, colon));
-            newTime.min = stoi(temp.substr(colon + 1));
+// --schedule [--format=table|csv|jsonl] [--page=N --page-size=ROWS]
+// Prints the schedule (or one page of it) and exits.
+int scheduleMain(int argc, char** argv) {
+    const char* formatArg = findOption(argc, argv, "format");
+    string formatName = formatArg ? formatArg : "table";
+    RenderFormat format;
+    if (formatName == "table") format = RENDER_TABLE;
+    else if (formatName == "csv") format = RENDER_CSV;
+    else if (formatName == "jsonl") format = RENDER_JSONL;
+    else {
+        cerr << "Unknown format '" << formatName << "'; use table, csv or jsonl." << endl;
+        return 1;
+    }
+    int pageSize = static_cast<int>(optionInt(argc, argv, "page-size", 0));
+    int page = static_cast<int>(optionInt(argc, argv, "page", 1));
 
-            if (checkTime2(newTime,flight->t_arrive)) {
-                cout << "Boarding time must be before arrival time!\n";
-                continue;
-            }
-            flight->t_leave = newTime;
+    Flight::loadFromFile();
+    ListNode<Flight>* node = flist.begin();
+    if (pageSize > 0) {
+        for (long long skip = static_cast<long long>(page - 1) * pageSize; skip > 0 && node != flist.end(); skip--) {
+            node = node->next;
         }
-        break;
-    } while (true);
-
-    // Arrival time
-    do {
-        cout << "Current Arriving time: "
-            << setw(2) << setfill('0') << flight->t_arrive.hour << ":"
-            << setw(2) << setfill('0') << flight->t_arrive.min << "\n";
-        cout << "Arriving time (e.g. 21:40): ";
-        getline(cin, temp);
-
-        if (!temp.empty()) {
-            if (!checkTime(temp)) {
-                cout << "Please insert a valid arriving time (e.g. 21:40)!\n";
-                continue;
-            }
+    }
+    ScheduleRenderer::render(cout, format, node, pageSize);
+    cout.flush();
+    return 0;
+}
 
-            size_t colon = temp.find(':');
-            Time newTime;
-            newTime.hour = stoi(temp.substr(0, colon));
-            newTime.min = stoi(temp.substr(colon + 1));
+// ---------------------------------------------------------------------------
+// Pricing benchmark
+//
+// Quote threads price random flights while one thread keeps booking and
+// cancelling under the engine lock. "cached" reads the per-flight fare
+// table without locking; "recompute" prices from the curves on every
+// quote, under the lock, as pricing did before the table existed.
+// ---------------------------------------------------------------------------
+
+struct PricingBenchShared {
+    mutex engine;
+    atomic<bool> stop;
+    Flight** flights;
+    int flightCount;
+    int* passports;
+    int customerCount;
+};
 
-            if (checkTime2(flight->t_leave, newTime)) {
-                cout << "Arrival time must be after departure time!\n";
-                continue;
-            }
-            flight->t_arrive = newTime;
+void pricingBooker(PricingBenchShared* shared, unsigned long long seed, unsigned long long* bookings) {
+    FastRng rng(seed);
+    unsigned long long done = 0;
+    while (!shared->stop.load(memory_order_relaxed)) {
+        lock_guard<mutex> guard(shared->engine);
+        Customer* customer = customerBST.find(shared->passports[rng.below(shared->customerCount)]);
+        Flight* flight = shared->flights[rng.below(shared->flightCount)];
+        if (!customer) continue;
+
+        bool business = rng.below(5) == 0;
+        int available = business ? flight->getAvailableBusinessSeats() : flight->getAvailableEconomySeats();
+        if (available > 0) {
+            customer->confirmBooking(flight->getFlightNo(), business, customer->quote(flight, business));
         }
-        break;
-    } while (true);
-
-    // Ticket price
-    do {
-        cout << "Current Ticket price: " << flight->cost << "\n";
-        cout << "Ticket price: ";
-        getline(cin, temp);
+        else if (!customer->getBookings().empty()) {
+            Money refund;
+            Customer::cancelBooking(customer->getPassport(), customer->getBookings()[0].flightNo, refund);
+        }
+        done++;
+    }
+    *bookings = done;
+}
 
-        if (!temp.empty()) {
-            if (!checkNumber(temp)) {
-                cout << "Please insert a valid ticket price!\n";
-                continue;
-            }
-            flight->cost = stoi(temp);
+void pricingQuoter(PricingBenchShared* shared, bool cached, int quotes, unsigned long long seed, long long* sink) {
+    FastRng rng(seed);
+    long long total = 0;
+    for (int q = 0; q < quotes; q++) {
+        const Flight* flight = shared->flights[rng.below(shared->flightCount)];
+        bool business = rng.below(5) == 0;
+        offers discount = static_cast<offers>(rng.below(OFFER_COUNT));
+        if (cached) {
+            total += flight->fare(business, discount).getCents();
         }
-        break;
-    } while (true);
+        else {
+            lock_guard<mutex> guard(shared->engine);
+            int booked = business ? flight->getBookedBusinessSeats() : flight->getBookedEconomySeats();
+            int seats = business ? flight->getBusinessSeats() : flight->getEconomySeats();
+            total += PricingEngine::price(flight->getCost(), business, discount, booked, seats,
+                flight->getWaitlistDepth()).getCents();
+        }
+    }
+    *sink = total;
+}
 
-    // Aeroplane type
-    do {
-        cout << "Current Aeroplane type: " << flight->plane_type << "\n";
-        cout << "Aeroplane type: ";
-        getline(cin, temp);
+void benchPricingVariant(PricingBenchShared& shared, bool cached, int threads, int quotes, ostream& out) {
+    shared.stop.store(false);
+    unsigned long long bookings = 0;
+    thread booker(pricingBooker, &shared, 7ULL, &bookings);
 
-        if (!temp.empty()) {
-            if (temp.empty()) {
-                cout << "Please insert a valid Aeroplane type!\n";
-                continue;
-            }
-            flight->plane_type = temp;
-        }
-        break;
-    } while (true);
+    thread* quoters = new thread[threads];
+    long long* sinks = new long long[threads];
+    unsigned long long start = nowNanos();
+    for (int t = 0; t < threads; t++) {
+        quoters[t] = thread(pricingQuoter, &shared, cached, quotes, 100ULL + t, &sinks[t]);
+    }
+    for (int t = 0; t < threads; t++) quoters[t].join();
+    unsigned long long elapsed = nowNanos() - start;
+    shared.stop.store(true);
+    booker.join();
+
+    double seconds = elapsed / 1e9;
+    out << "{\"variant\":\"" << (cached ? "cached" : "recompute") << "\",\"seconds\":" << seconds
+        << ",\"quotes_per_s\":" << (seconds > 0 ? static_cast<double>(quotes) * threads / seconds : 0.0)
+        << ",\"bookings_per_s\":" << (seconds > 0 ? bookings / seconds : 0.0) << "}";
+    delete[] quoters;
+    delete[] sinks;
+}
 
-    // Number of seats
-    do {
-        cout << "Current Total number of seats: " << flight->seats << "\n";
-        cout << "Total number of seats: ";
-        getline(cin, temp);
+// --bench-pricing [--threads=4] [--quotes=1000000] [generator options]
+int benchPricingMain(int argc, char** argv) {
+    GeneratorConfig cfg = generatorConfigFromArgs(argc, argv);
+    int threads = static_cast<int>(optionInt(argc, argv, "threads", 4));
+    int quotes = static_cast<int>(optionInt(argc, argv, "quotes", 1000000));
+    if (threads < 1) threads = 1;
+    if (dataDirectory.empty()) dataDirectory = "bench_data/";
+    makeDirectory(dataDirectory);
+
+    NullBuffer nullBuffer;
+    streambuf* console = cout.rdbuf(&nullBuffer);
+    generateDataset(cfg);
+    freeAllCustomers();
+    Flight::loadFromFile();
+    Customer::loadFromFile();
+    Queue::loadFromFile();
+    cout.rdbuf(console);
+
+    // Demand curves, so every booking really moves the fares
+    PricingEngine::useDemandCurves();
+    PricingBenchShared shared;
+    shared.flightCount = flist.getSize();
+    shared.customerCount = customerBST.size();
+    if (shared.flightCount == 0 || shared.customerCount == 0) {
+        cerr << "Error: the generated dataset is empty." << endl;
+        return 1;
+    }
+    shared.flights = new Flight*[shared.flightCount];
+    shared.passports = new int[shared.customerCount];
+    int i = 0;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+        node->data.buildFares();
+        shared.flights[i++] = &node->data;
+    }
+    i = 0;
+    for (CustomerBST::Iterator it = customerBST.begin(); it != customerBST.end(); ++it) {
+        shared.passports[i++] = it.key();
+    }
 
-        if (!temp.empty()) {
-            if (!checkNumber(temp)) {
-                cout << "Please insert a valid number of seats!\n";
-                continue;
-            }
-            int newSeats = stoi(temp);
-            if (newSeats < flight->booked_seats) {
-                cout << "Cannot have fewer seats than currently booked (" << flight->booked_seats << ")!\n";
-                continue;
-            }
-            flight->seats = newSeats;
-        }
-        break;
-    } while (true);
+    // The shared counters are not thread-safe
+    bool statsWereEnabled = Stats::enabled;
+    Stats::enabled = false;
 
-    // Business class seats
-    do {
-        cout << "Current Business class seats: " << flight->businessSeats << "\n";
-        cout << "Business class seats: ";
-        getline(cin, temp);
+    cout << "{\"benchmark\":\"pricing\",\"threads\":" << threads << ",\"quotes_per_thread\":" << quotes
+        << ",\"flights\":" << shared.flightCount << ",\"results\":[";
+    benchPricingVariant(shared, true, threads, quotes, cout);
+    cout << ",";
+    benchPricingVariant(shared, false, threads, quotes, cout);
+    cout << "]}" << endl;
 
-        if (!temp.empty()) {
-            if (!checkNumber(temp) || stoi(temp) > flight->seats) {
-                cout << "Please insert a valid number of business class seats!\n";
-                continue;
-            }
-            flight->businessSeats = stoi(temp);
-            flight->economySeats = flight->seats - flight->businessSeats;
-        }
-        break;
-    } while (true);
+    Stats::enabled = statsWereEnabled;
+    delete[] shared.flights;
+    delete[] shared.passports;
+    return 0;
+}
 
-    // Number of booked business seats
-    do {
-        cout << "Current Booked business class seats: " << flight->bookedBusinessSeats << "\n";
-        cout << "Booked business class seats: ";
-        getline(cin, temp);
+// ---------------------------------------------------------------------------
+// Overbooking analysis
+//
+// For every flight, simulates how many booked passengers turn up and finds
+// the most extra bookings per cabin that keep the chance of denying anyone
+// boarding at or under the risk target. A passenger's absence rate (no-show
+// or late cancellation) comes from their offer type plus the other flights
+// they hold. Threads claim flights one at a time from a shared cursor, so a
+// thread done with a small flight moves straight on to the next unclaimed
+// one. --apply writes the limits to overbook.txt for bookings to honour.
+// ---------------------------------------------------------------------------
+
+// Absence rate in basis points by offer (none, student, senior, military,
+// frequent flyer), and the extra per other flight held, up to a cap.
+const int OVERBOOK_ABSENCE_BP[OFFER_COUNT] = { 800, 1200, 500, 600, 1000 };
+const int OVERBOOK_PER_FLIGHT_BP = 150;
+const int OVERBOOK_PER_FLIGHT_CAP_BP = 600;
+// Largest overbooking tried, as a percentage of the cabin's seats.
+const int OVERBOOK_MAX_PERCENT = 20;
+
+// Eight xorshift64* generators stepped side by side. Each lane only depends
+// on itself, so the loop over lanes compiles to vector instructions.
+class LaneRng {
+public:
+    static const int LANES = 8;
 
-        if (!temp.empty()) {
-            if (!checkNumber(temp) || stoi(temp) > flight->businessSeats) {
-                cout << "Please insert a valid number of booked business class seats!\n";
-                continue;
-            }
-            flight->bookedBusinessSeats = stoi(temp);
+    explicit LaneRng(unsigned long long seed) {
+        FastRng seeder(seed);
+        for (int i = 0; i < LANES; i++) state[i] = seeder.next() | 1;
+    }
+
+    // Writes LANES uniform 32-bit values to out.
+    void next(unsigned* out) {
+        for (int i = 0; i < LANES; i++) {
+            unsigned long long x = state[i];
+            x ^= x >> 12;
+            x ^= x << 25;
+            x ^= x >> 27;
+            state[i] = x;
+            out[i] = static_cast<unsigned>((x * 0x2545F4914F6CDD1DULL) >> 32);
         }
-        break;
-    } while (true);
+    }
 
-    // Number of booked economy seats
-    do {
-        cout << "Current Booked economy class seats: " << flight->bookedEconomySeats << "\n";
-        cout << "Booked economy class seats: ";
-        getline(cin, temp);
+private:
+    unsigned long long state[LANES];
+};
 
-        if (!temp.empty()) {
-            if (!checkNumber(temp) || stoi(temp) > flight->economySeats) {
-                cout << "Please insert a valid number of booked economy class seats!\n";
-                continue;
-            }
-            flight->bookedEconomySeats = stoi(temp);
-        }
-        flight->booked_seats = flight->bookedBusinessSeats + flight->bookedEconomySeats;
-        break;
-    } while (true);
+struct OverbookCabin {
+    int seats, booked, limit;
+    double absence;         // mean absence rate of the simulated bookings
+    double deniedRisk;      // chance that anyone is denied boarding at the limit
+    double expectedDenied;  // passengers denied boarding per departure at the limit
+};
 
-    // Weather condition
-    do {
-        cout << "Current Weather condition: " << flight->weather << "\n";
-        cout << "Weather condition (e.g., Sunny, Rainy, Cloudy, etc.): ";
-        getline(cin, temp);
+struct OverbookFlight {
+    const Flight* flight;
+    // Each cabin's passengers in OverbookJob::showThreshold (0 economy, 1 business)
+    int first[2], count[2];
+    OverbookCabin cabins[2];
+};
 
-        if (!temp.empty()) {
-            if (temp.empty()) {
-                cout << "Please enter a valid weather condition!\n";
-                continue;
-            }
-            flight->weather = temp;
-        }
-        break;
-    } while (true);
+struct OverbookJob {
+    OverbookFlight* flights;
+    int flightCount;
+    // Per booked passenger: they show up when a uniform 32-bit draw is below it.
+    unsigned* showThreshold;
+    int trials;
+    double risk;
+    unsigned long long seed;
+    atomic<int> nextFlight;
+};
 
-    // Day of week
-    do {
-        cout << "Current Day of week: " << flight->dayOfWeek << "\n";
-        cout << "Day of week (e.g., Monday, Tuesday, etc.): ";
-        getline(cin, temp);
+unsigned overbookShowThreshold(int absenceBp) {
+    return static_cast<unsigned>((10000ULL - absenceBp) * 4294967295ULL / 10000);
+}
 
-        if (!temp.empty()) {
-            if (temp.empty()) {
-                cout << "Please enter a valid day of week!\n";
-                continue;
+// Bookings past the flight's own passengers (the extra ones being sold, or
+// cabins with no known passengers) use the plain no-offer rate.
+void simulateOverbookCabin(const OverbookJob& job, OverbookFlight& f, bool businessClass, LaneRng& rng) {
+    OverbookCabin& cabin = f.cabins[businessClass];
+    cabin.seats = businessClass ? f.flight->getBusinessSeats() : f.flight->getEconomySeats();
+    cabin.booked = businessClass ? f.flight->getBookedBusinessSeats() : f.flight->getBookedEconomySeats();
+    cabin.limit = 0;
+    cabin.absence = cabin.deniedRisk = cabin.expectedDenied = 0.0;
+    if (cabin.seats <= 0) return;
+
+    int extra = cabin.seats * OVERBOOK_MAX_PERCENT / 100;
+    int total = cabin.seats + extra;
+    int padded = (total + LaneRng::LANES - 1) / LaneRng::LANES * LaneRng::LANES;
+    unsigned* threshold = new unsigned[padded];
+    unsigned* draws = new unsigned[padded];
+    long long* deniedTrials = new long long[extra + 1]();
+    long long* deniedTotal = new long long[extra + 1]();
+
+    unsigned fallback = overbookShowThreshold(OVERBOOK_ABSENCE_BP[static_cast<int>(offers::NONE)]);
+    double absence = 0.0;
+    for (int i = 0; i < total; i++) {
+        int known = f.count[businessClass];
+        threshold[i] = i < cabin.booked && known ? job.showThreshold[f.first[businessClass] + i % known] : fallback;
+        absence += 1.0 - threshold[i] / 4294967296.0;
+    }
+    for (int i = total; i < padded; i++) threshold[i] = 0;
+    cabin.absence = absence / total;
+
+    // One pass per trial scores every candidate limit: the first seats+L
+    // bookings are the cabin sold L over
+    for (int t = 0; t < job.trials; t++) {
+        for (int i = 0; i < padded; i += LaneRng::LANES) rng.next(draws + i);
+        int shows = 0;
+        for (int i = 0; i < cabin.seats; i++) shows += draws[i] < threshold[i];
+        for (int l = 0; l <= extra; l++) {
+            if (l > 0) shows += draws[cabin.seats + l - 1] < threshold[cabin.seats + l - 1];
+            if (shows > cabin.seats) {
+                deniedTrials[l]++;
+                deniedTotal[l] += shows - cabin.seats;
             }
-            flight->dayOfWeek = temp;
         }
-        break;
-    } while (true);
+    }
 
-    // Save to file
-    Flight::saveToFile();
-    cout << "Flight No: " << flightNo << " was successfully updated!\n";
+    for (int l = 0; l <= extra; l++) {
+        if (deniedTrials[l] > job.risk * job.trials) break;
+        cabin.limit = l;
+    }
+    cabin.deniedRisk = deniedTrials[cabin.limit] / static_cast<double>(job.trials);
+    cabin.expectedDenied = deniedTotal[cabin.limit] / static_cast<double>(job.trials);
+
+    delete[] threshold;
+    delete[] draws;
+    delete[] deniedTrials;
+    delete[] deniedTotal;
 }
 
-void Customer::manageQueue(int flightNum) {
-    // Find the flight
-    Flight* flight = flightBST.find(flightNum);
-    if (!flight) {
-        cout << "Flight " << flightNum << " not found!\n";
-        return;
+void overbookWorker(OverbookJob* job) {
+    while (true) {
+        int i = job->nextFlight.fetch_add(1);
+        if (i >= job->flightCount) return;
+        OverbookFlight& f = job->flights[i];
+        // Seeded per flight, so results do not depend on the thread count
+        LaneRng rng(job->seed ^ (static_cast<unsigned long long>(f.flight->getFlightNo()) * 0x9E3779B97F4A7C15ULL));
+        simulateOverbookCabin(*job, f, true, rng);
+        simulateOverbookCabin(*job, f, false, rng);
     }
+}
 
-    // Find the queue for this flight
-    Queue* flightQueue = nullptr;
-    ListNode<Queue>* queueNode = nullptr;
+// Gathers every flight's booked passengers into one array, in flight and
+// then cabin order.
+void collectOverbookPassengers(OverbookJob& job) {
+    // Flight number -> index, open addressing
+    int buckets = 16;
+    while (buckets < job.flightCount * 2) buckets *= 2;
+    int* index = new int[buckets];
+    for (int b = 0; b < buckets; b++) index[b] = -1;
+    for (int i = 0; i < job.flightCount; i++) {
+        unsigned b = static_cast<unsigned>(job.flights[i].flight->getFlightNo()) * 2654435761u & (buckets - 1);
+        while (index[b] >= 0) b = (b + 1) & (buckets - 1);
+        index[b] = i;
+    }
+    auto lookup = [&](int num) {
+        unsigned b = static_cast<unsigned>(num) * 2654435761u & (buckets - 1);
+        while (index[b] >= 0) {
+            if (job.flights[index[b]].flight->getFlightNo() == num) return index[b];
+            b = (b + 1) & (buckets - 1);
+        }
+        return -1;
+    };
 
-    for (ListNode<Queue>* qnode = qlist.begin(); qnode != qlist.end(); qnode = qnode->next) {
-        if (flightNum == qnode->data.getNo()) {
-            flightQueue = &qnode->data;
-            queueNode = qnode;
-            break;
+    int passengers = 0;
+    for (CustomerBST::Iterator it = customerBST.begin(); it != customerBST.end(); ++it) {
+        for (const Booking& booking : (*it)->getBookings()) {
+            int i = booking.date ? -1 : lookup(booking.flightNo);
+            if (i >= 0) {
+                job.flights[i].count[booking.businessClass]++;
+                passengers++;
+            }
         }
     }
-
-    if (!flightQueue || flightQueue->isEmpty()) {
-        cout << "No customers in queue for Flight " << flightNum << ".\n";
-        return;
+    for (int i = 0, first = 0; i < job.flightCount; i++) {
+        for (int c = 0; c < 2; c++) {
+            job.flights[i].first[c] = first;
+            first += job.flights[i].count[c];
+            job.flights[i].count[c] = 0;
+        }
     }
 
-    cout << "\nManaging Queue for Flight " << flightNum << ":\n";
-    cout << "Current seats: " << flight->getAvailableSeats() + flight->getBookedSeats() << endl;
-    cout << "Available business seats: " << flight->getAvailableBusinessSeats() << endl;
-    cout << "Available economy seats: " << flight->getAvailableEconomySeats() << endl;
-    cout << "Passengers in queue: " << flightQueue->getSize() << "\n\n";
+    job.showThreshold = new unsigned[passengers > 0 ? passengers : 1];
+    for (CustomerBST::Iterator it = customerBST.begin(); it != customerBST.end(); ++it) {
+        const Customer* customer = *it;
+        const SmallVector<Booking, INLINE_BOOKINGS>& bookings = customer->getBookings();
+        int others = bookings.getSize() - 1;
+        int absence = OVERBOOK_ABSENCE_BP[static_cast<int>(customer->getDiscount())]
+            + min(others * OVERBOOK_PER_FLIGHT_BP, OVERBOOK_PER_FLIGHT_CAP_BP);
+        unsigned threshold = overbookShowThreshold(absence);
+        for (const Booking& booking : bookings) {
+            int i = booking.date ? -1 : lookup(booking.flightNo);
+            if (i >= 0) {
+                OverbookFlight& f = job.flights[i];
+                job.showThreshold[f.first[booking.businessClass] + f.count[booking.businessClass]++] = threshold;
+            }
+        }
+    }
+    delete[] index;
+}
 
-    while (!flightQueue->isEmpty()) {
-        // Display management options
-        cout << "\n------------------------------------------------\n";
-        cout << "1. Process next customer in queue\n";
-        cout << "2. View queue\n";
-        cout << "3. Exit queue management\n";
-        cout << "Current available business seats: " << flight->getAvailableBusinessSeats() << endl;
-        cout << "Current available economy seats: " << flight->getAvailableEconomySeats() << endl;
-        cout << "Enter your choice (1-3): ";
+bool writeOverbookLimits(const OverbookJob& job) {
+    ostringstream file;
+    file << "# flight business economy  (extra bookings accepted per cabin)\n";
+    for (int i = 0; i < job.flightCount; i++) {
+        const OverbookFlight& f = job.flights[i];
+        file << f.flight->getFlightNo() << " " << f.cabins[1].limit << " " << f.cabins[0].limit << "\n";
+    }
+    if (!FileIO::writeFile(dataFile("overbook.txt"), file.str())) {
+        cerr << "Error: Could not save the overbooking limits." << endl;
+        return false;
+    }
+    return true;
+}
 
-        string choice;
-        getline(cin, choice);
+// --overbook [--trials=20000] [--risk=0.05] [--threads=N] [--seed=42] [--apply]
+int overbookMain(int argc, char** argv) {
+    int trials = static_cast<int>(optionInt(argc, argv, "trials", 20000));
+    double risk = optionDouble(argc, argv, "risk", 0.05);
+    int threads = static_cast<int>(optionInt(argc, argv, "threads", thread::hardware_concurrency()));
+    if (trials < 1) trials = 1;
+    if (threads < 1) threads = 1;
 
-        if (choice == "1") {
-            // Check if any seats are available
-            if (flight->getAvailableBusinessSeats() <= 0 && flight->getAvailableEconomySeats() <= 0) {
-                cout << "No available seats! Please wait for seats to become available.\n";
-                continue;
-            }
+    Flight::loadFromFile();
+    Customer::loadFromFile();
 
-            // Process next customer
-            QueueNode* queueHead = flightQueue->getFront();
-            if (!queueHead) break;
+    OverbookJob job;
+    job.flightCount = flist.getSize();
+    job.flights = new OverbookFlight[job.flightCount > 0 ? job.flightCount : 1];
+    int i = 0;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next, i++) {
+        job.flights[i].flight = &node->data;
+        job.flights[i].first[0] = job.flights[i].first[1] = 0;
+        job.flights[i].count[0] = job.flights[i].count[1] = 0;
+    }
+    job.trials = trials;
+    job.risk = risk;
+    job.seed = static_cast<unsigned long long>(optionInt(argc, argv, "seed", 42));
+    job.nextFlight.store(0);
+    collectOverbookPassengers(job);
+
+    unsigned long long start = nowNanos();
+    thread* workers = new thread[threads];
+    for (int t = 0; t < threads; t++) workers[t] = thread(overbookWorker, &job);
+    for (int t = 0; t < threads; t++) workers[t].join();
+    double seconds = (nowNanos() - start) / 1e9;
+    delete[] workers;
+
+    cout << "{\"analysis\":\"overbook\",\"flights\":" << job.flightCount << ",\"trials\":" << trials
+        << ",\"risk\":" << risk << ",\"threads\":" << threads << ",\"seconds\":" << seconds << ",\"results\":[";
+    static const char* cabinNames[2] = { "E", "B" };
+    for (i = 0; i < job.flightCount; i++) {
+        const OverbookFlight& f = job.flights[i];
+        for (int c = 1; c >= 0; c--) {
+            const OverbookCabin& cabin = f.cabins[c];
+            if (i > 0 || c < 1) cout << ",";
+            cout << "{\"flight\":" << f.flight->getFlightNo() << ",\"cabin\":\"" << cabinNames[c]
+                << "\",\"seats\":" << cabin.seats << ",\"booked\":" << cabin.booked
+                << ",\"absence_rate\":" << cabin.absence << ",\"limit\":" << cabin.limit
+                << ",\"denied_risk\":" << cabin.deniedRisk << ",\"expected_denied\":" << cabin.expectedDenied << "}";
+        }
+    }
+    cout << "]}" << endl;
 
-            int passport = queueHead->Customer.getPassport();
-            Customer* customer = customerBST.find(passport);
+    bool ok = !hasFlag(argc, argv, "--apply") || writeOverbookLimits(job);
+    delete[] job.flights;
+    delete[] job.showThreshold;
+    return ok ? 0 : 1;
+}
 
-            if (!customer) {
-                flightQueue->dequeue();
-                cout << "Removed invalid customer (Passport: " << passport << ") from queue.\n";
-                continue;
-            }
+// ---------------------------------------------------------------------------
+// Name search benchmark
+// ---------------------------------------------------------------------------
 
-            // Display customer info
-            cout << "\nNext customer in queue:\n";
-            cout << "Name: " << customer->getName() << " " << customer->getSurname() << endl;
-            cout << "Passport: " << customer->getPassport() << endl;
-            cout << "Time in queue: " << difftime(time(nullptr), queueHead->joinTime) / 60 << " minutes\n";
+// Name made of 2..maxSyllables syllables, e.g. "belkaros".
+string syntheticName(FastRng& rng, int maxSyllables) {
+    static const char* syllables[32] = {
+        "ka", "lo", "mi", "ren", "sa", "to", "vi", "an", "bel", "cor", "dan", "el", "fi", "gar", "hol", "is",
+        "jo", "kin", "lu", "mar", "nor", "ol", "pe", "quin", "ros", "sch", "tan", "ul", "ven", "wil", "xan", "yor"
+    };
+    string name;
+    int count = 2 + static_cast<int>(rng.below(maxSyllables - 1));
+    for (int i = 0; i < count; i++) name += syllables[rng.below(32)];
+    name[0] = static_cast<char>(toupper(static_cast<unsigned char>(name[0])));
+    return name;
+}
 
-            // Select class for allocation
-            string seatClass;
-            bool businessClass = false;
-            int priceMultiplier = 1;
+// Queries of one kind against the index; appends a JSON object to out.
+void benchSearchKind(const char* kind, const string* queries, int count, ostream& out) {
+    LatencyHistogram latency;
+    NameIndex::Match matches[10];
+    long long found = 0;
+    for (int i = 0; i < count; i++) {
+        unsigned long long start = nowNanos();
+        found += customerNames.search(queries[i], matches, 10);
+        latency.record(nowNanos() - start);
+    }
+    out << "{\"kind\":\"" << kind << "\",\"queries\":" << count
+        << ",\"matches_per_query\":" << (count ? static_cast<double>(found) / count : 0.0)
+        << ",\"p50_us\":" << latency.percentile(0.50) / 1000.0
+        << ",\"p99_us\":" << latency.percentile(0.99) / 1000.0
+        << ",\"max_us\":" << latency.max() / 1000.0 << "}";
+}
 
-            do {
-                cout << "\nSelect class to allocate:\n";
-                cout << "1. Business Class (2x price, " << flight->getAvailableBusinessSeats() << " available)\n";
-                cout << "2. Economy Class (" << flight->getAvailableEconomySeats() << " available)\n";
-                cout << "Enter your choice (1-2): ";
-                getline(cin, seatClass);
+// --bench-search [--customers=1000000] [--queries=2000] [--seed=42]
+// Indexes synthetic names (Zipf-distributed surnames and first names) and
+// times exact, prefix and misspelt queries.
+int benchSearchMain(int argc, char** argv) {
+    int customers = static_cast<int>(optionInt(argc, argv, "customers", 1000000));
+    int queries = static_cast<int>(optionInt(argc, argv, "queries", 2000));
+    FastRng rng(static_cast<unsigned long long>(optionInt(argc, argv, "seed", 42)));
+    if (customers < 1) customers = 1;
+    if (queries < 1) queries = 1;
+
+    int surnameCount = customers / 20 > 1000 ? customers / 20 : 1000;
+    if (surnameCount > 500000) surnameCount = 500000;
+    const int FIRST_NAMES = 5000;
+    string* surnames = new string[surnameCount];
+    string* firstNames = new string[FIRST_NAMES];
+    for (int i = 0; i < surnameCount; i++) surnames[i] = syntheticName(rng, 4);
+    for (int i = 0; i < FIRST_NAMES; i++) firstNames[i] = syntheticName(rng, 3);
+    ZipfSampler surnameRank(surnameCount, 1.0), firstRank(FIRST_NAMES, 1.0);
+
+    bool statsWereEnabled = Stats::enabled;
+    Stats::enabled = false;
+    customerNames.clear();
+    unsigned long long heapBefore = heapInUse();
+    unsigned long long start = nowNanos();
+    int* pickedSurname = new int[customers];
+    int* pickedFirst = new int[customers];
+    for (int i = 0; i < customers; i++) {
+        pickedSurname[i] = surnameRank.sample(rng);
+        pickedFirst[i] = firstRank.sample(rng);
+        customerNames.insert(1000000 + i, firstNames[pickedFirst[i]], surnames[pickedSurname[i]]);
+    }
+    double buildSeconds = (nowNanos() - start) / 1e9;
+    unsigned long long heapAfter = heapInUse();
+
+    string* exact = new string[queries];
+    string* prefix = new string[queries];
+    string* typo = new string[queries];
+    for (int q = 0; q < queries; q++) {
+        int c = static_cast<int>(rng.below(customers));
+        const string& last = surnames[pickedSurname[c]];
+        const string& first = firstNames[pickedFirst[c]];
+        exact[q] = last + " " + first;
+        prefix[q] = last.substr(0, 3 + rng.below(3)) + " " + first.substr(0, 2);
+        string misspelt = last;
+        misspelt[1 + rng.below(misspelt.size() - 1)] = static_cast<char>('a' + rng.below(26));
+        typo[q] = misspelt + " " + first;
+    }
 
-                if (seatClass == "1") {
-                    if (flight->getAvailableBusinessSeats() <= 0) {
-                        cout << "No available business class seats!\n";
-                        continue;
-                    }
-                    businessClass = true;
-                    priceMultiplier = 2;
-                }
-                else if (seatClass == "2") {
-                    if (flight->getAvailableEconomySeats() <= 0) {
-                        cout << "No available economy class seats!\n";
-                        continue;
-                    }
-                    businessClass = false;
-                    priceMultiplier = 1;
-                }
-                else {
-                    cout << "Invalid choice!\n";
-                    continue;
-                }
-                break;
-            } while (true);
+    cout << "{\"benchmark\":\"name_search\",\"customers\":" << customers << ",\"surnames\":" << surnameCount
+        << ",\"first_names\":" << FIRST_NAMES << ",\"build_s\":" << buildSeconds << ",\"bytes_per_customer\":";
+    if (heapAfter) cout << (heapAfter > heapBefore ? (heapAfter - heapBefore) / static_cast<double>(customers) : 0.0);
+    else cout << "null";
+    cout << ",\"results\":[";
+    benchSearchKind("exact", exact, queries, cout);
+    cout << ",";
+    benchSearchKind("prefix", prefix, queries, cout);
+    cout << ",";
+    benchSearchKind("typo", typo, queries, cout);
+    cout << "]}" << endl;
+
+    customerNames.clear();
+    Stats::enabled = statsWereEnabled;
+    delete[] surnames;
+    delete[] firstNames;
+    delete[] pickedSurname;
+    delete[] pickedFirst;
+    delete[] exact;
+    delete[] prefix;
+    delete[] typo;
+    return 0;
+}
 
-            // Calculate price
-            float discountRate = customer->getDiscountRate();
-            int originalPrice = flight->getCost() * priceMultiplier;
-            int discountedPrice = originalPrice * (1 - discountRate);
+// --search="<surname> [first name]" [--limit=10]
+int searchMain(int argc, char** argv) {
+    const char* query = findOption(argc, argv, "search");
+    int limit = static_cast<int>(optionInt(argc, argv, "limit", 10));
+    if (!query || !*query || limit < 1) {
+        cerr << "Usage: --search=\"<surname> [first name]\" [--limit=10]" << endl;
+        return 1;
+    }
 
-            cout << "Ticket Price: $" << discountedPrice;
-            if (discountRate > 0) {
-                cout << " (Discount: " << (discountRate * 100) << "%)";
-            }
-            cout << endl;
+    Customer::loadFromFile();
+    NameIndex::Match* matches = new NameIndex::Match[limit];
+    int found = customerNames.search(query, matches, limit);
+    for (int i = 0; i < found; i++) {
+        const Customer* customer = customerBST.find(matches[i].passport);
+        if (!customer) continue;
+        cout << matches[i].passport << "," << customer->getName() << "," << customer->getSurname()
+            << "," << matches[i].distance << "\n";
+    }
+    delete[] matches;
+    return 0;
+}
 
-            cout << "Confirm allocation? (y/n): ";
-            string confirm;
-            getline(cin, confirm);
+// ---------------------------------------------------------------------------
+// Bulk import
+//
+// CSV files in the flights2.txt / passengers2.txt layouts are validated line
+// by line as they are read, then merged with the loaded records through the
+// same sort-and-build indexing as a normal load.
+// ---------------------------------------------------------------------------
 
-            if (confirm == "y" || confirm == "Y") {
-                // Book the flight
-                customer->flights.push_back(flightNum);
-                if (businessClass) {
-                    flight->setBookedBusinessSeats(flight->getBookedBusinessSeats() + 1);
-                }
-                else {
-                    flight->setBookedEconomySeats(flight->getBookedEconomySeats() + 1);
-                }
-                flight->setBookedSeats(flight->getBookedSeats() + 1);
-                customer->setTotalSpent(customer->getTotalSpent() + discountedPrice);
+struct ImportCounts {
+    int read, imported, rejected;
+};
 
-                // Remove from queue
-                flightQueue->dequeue();
+bool importFlights(const string& path, ImportCounts& counts) {
+    string contents;
+    if (!FileIO::readFile(path, contents)) {
+        cerr << "Error: cannot read " << path << "." << endl;
+        return false;
+    }
+    istringstream file(contents);
+    int before = flist.getSize();
+    DoublyLinkedList<Flight> accepted;
 
-                cout << "\nSeat allocated successfully to " << customer->getName() << "!\n";
-                cout << "Amount charged: $" << discountedPrice << endl;
+    string line;
+    int lineNo = 0;
+    while (getline(file, line)) {
+        lineNo++;
+        if (line.empty() || line[0] == '#') continue;
+        counts.read++;
 
-                if (flightQueue->isEmpty()) {
-                    cout << "Queue for Flight " << flightNum << " is now empty.\n";
-                }
-            }
-            else {
-                cout << "Allocation cancelled.\n";
-            }
+        Flight& f = accepted.emplace_back();
+        bool valid = false;
+        try {
+            valid = Flight::parseRecord(line, f)
+                && f.getBusinessSeats() + f.getEconomySeats() == f.getSeats()
+                && f.getBookedBusinessSeats() + f.getBookedEconomySeats() == f.getBookedSeats();
         }
-        else if (choice == "2") {
-            // View current queue
-            cout << "\nCurrent queue for Flight " << flightNum << ":\n";
-            cout << left << setw(5) << "Pos" << setw(25) << "Name" << setw(15) << "Passport"
-                << setw(15) << "Wait Time" << setw(20) << "Discount" << endl;
+        catch (const exception&) {
+        }
+        if (!valid) {
+            cerr << path << ":" << lineNo << ": invalid flight record" << endl;
+            accepted.erase(accepted.getTail());
+            counts.rejected++;
+            continue;
+        }
+        f.buildFares();
+    }
 
-            int pos = 1;
-            QueueNode* current = flightQueue->getFront();
-            while (current) {
-                string discountStr;
-                switch (current->Customer.getDiscount()) {
-                case offers::STUDENT: discountStr = "Student (15%)"; break;
-                case offers::SENIOR: discountStr = "Senior (20%)"; break;
-                case offers::MILITARY: discountStr = "Military (10%)"; break;
-                case offers::FREQUENT_FLYER: discountStr = "Frequent Flyer (25%)"; break;
-                case offers::NONE: discountStr = "None"; break;
-                }
+    // Loaded flights come first, so a repeated number keeps the loaded one
+    flist.splice(accepted);
+    counts.rejected += Flight::indexFlights();
+    counts.imported = flist.getSize() - before;
+    return true;
+}
 
-                cout << left << setw(5) << pos++
-                    << setw(25) << (current->Customer.getName() + " " + current->Customer.getSurname())
-                    << setw(15) << current->Customer.getPassport()
-                    << setw(15) << difftime(time(nullptr), current->joinTime) / 60 << " mins"
-                    << setw(20) << discountStr << endl;
-                current = current->next;
-            }
-        }
-        else if (choice == "3") {
-            cout << "Exiting queue management.\n";
-            break;
+bool importCustomers(const string& path, ImportCounts& counts) {
+    string contents;
+    if (!FileIO::readFile(path, contents)) {
+        cerr << "Error: cannot read " << path << "." << endl;
+        return false;
+    }
+    istringstream file(contents);
+
+    SmallVector<Customer*, 1> all;
+    SmallVector<int, 1> lineOf;  // file line of each new record
+    size_t lines = 0;
+    for (char c : contents) lines += c == '\n';
+    all.reserve(customerBST.size() + static_cast<int>(lines + 1));
+    lineOf.reserve(static_cast<int>(lines + 1));
+    for (Customer* customer : customerBST) all.push_back(customer);
+    int firstNew = all.getSize();
+
+    time_t now = time(nullptr);
+    string line;
+    int lineNo = 0;
+    while (getline(file, line)) {
+        lineNo++;
+        if (line.empty() || line[0] == '#') continue;
+        counts.read++;
+
+        Customer* customer = nullptr;
+        try {
+            customer = Customer::parseRecord(line, now);
         }
-        else {
-            cout << "Invalid choice. Please try again.\n";
+        catch (const exception&) {
+        }
+        if (!customer || customer->getPassport() <= 0) {
+            cerr << path << ":" << lineNo << ": invalid customer record" << endl;
+            delete customer;
+            counts.rejected++;
+            continue;
         }
+        all.push_back(customer);
+        lineOf.push_back(lineNo);
     }
 
-    // If queue is empty after processing, remove it
-    if (flightQueue && flightQueue->isEmpty() && queueNode) {
-        qlist.erase(queueNode);
-        cout << "Queue for Flight " << flightNum << " has been removed as it's now empty.\n";
+    // Records are taken in file order, so each one's bookings are checked
+    // against the seats the records before it took
+    counts.rejected += Customer::indexCustomers(all.begin(), all.getSize());
+    for (int i = firstNew; i < all.getSize(); i++) {
+        Customer* customer = all[i];
+        if (!customer) continue;
+        string error;
+        if (!customer->bookingsFit(error)) {
+            cerr << path << ":" << lineOf[i - firstNew] << ": " << error << endl;
+            customerBST.erase(customer->getPassport());
+            delete customer;
+            counts.rejected++;
+            continue;
+        }
+        customer->claimBookings();
+        customer->publish();
+        customerNames.insert(customer->getPassport(), customer->getName(), customer->getSurname());
+        // Dated bookings were counted when claimed; undated ones count on the flight
+        for (const Booking& booking : customer->getBookings()) {
+            if (!booking.date) Flight::resSeat(booking.flightNo, 1, booking.businessClass);
+        }
+        counts.imported++;
     }
+    return true;
+}
 
-    // Save all changes
-    Flight::saveToFile();
-    Customer::saveToFile();
-    Queue::saveToFile();
-
-    cout << "\nQueue management for Flight " << flightNum << " completed.\n";
+void appendImportCounts(ostream& out, const char* name, const ImportCounts& counts) {
+    out << "\"" << name << "\":{\"read\":" << counts.read << ",\"imported\":" << counts.imported
+        << ",\"rejected\":" << counts.rejected << "}";
 }
 
-// Menu member functions implementation
-void Menu::displayMenu() {
-    int selection;
-    string temp;
+// --import-flights=FILE and/or --import-customers=FILE
+int importMain(int argc, char** argv) {
+    const char* flightsPath = findOption(argc, argv, "import-flights");
+    const char* customersPath = findOption(argc, argv, "import-customers");
+    if ((!flightsPath || !*flightsPath) && (!customersPath || !*customersPath)) {
+        cerr << "Usage: --import-flights=FILE and/or --import-customers=FILE" << endl;
+        return 1;
+    }
 
     Flight::loadFromFile();
     Customer::loadFromFile();
     Queue::loadFromFile();
 
-    do {
-        cout << "-----------------------------------------------";
-        cout << "\n\t AIRLINE RESERVATION SYSTEM \n\n";
-        cout << "Please select an option from the menu below: \n";
-        cout << "1. Add new flights \n";
-        cout << "2. Delete flights \n";
-        cout << "3. Display flight schedule \n";
-        cout << "4. Display flight details \n";
-        cout << "5. Display passenger Customeral info \n";
-        cout << "6. Book reservation \n";
-        cout << "7. Cancel reservation \n";
-        cout << "8. update flight\n";
-        cout << "9. Manage waiting queue \n";
-        cout << "10. Exit \n";
-        cout << "-----------------------------------------------" << endl;
+    unsigned long long start = nowNanos();
+    ImportCounts flights = {}, customers = {};
+    // Flights first, so imported bookings can refer to imported flights
+    if (flightsPath && *flightsPath && !importFlights(flightsPath, flights)) return 1;
+    if (customersPath && *customersPath && !importCustomers(customersPath, customers)) return 1;
+    double importSeconds = (nowNanos() - start) / 1e9;
 
-        cout << "Enter your choice (1-10): ";
-        cin >> temp;
+    Flight::saveToFile();
+    Customer::saveToFile();
+    Queue::saveToFile();
 
-        while (!checkNumber(temp) || stoi(temp) < 1 || stoi(temp) > 10) {
-            cout << "Please enter a valid number between 1 and 10!\n";
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            cin >> temp;
+    cout << "{\"import\":\"csv\",";
+    appendImportCounts(cout, "flights", flights);
+    cout << ",";
+    appendImportCounts(cout, "customers", customers);
+    cout << ",\"seconds\":" << importSeconds << ",\"memory\":";
+    writeMemoryReport(cout);
+    cout << "}" << endl;
+    return 0;
+}
+
+// Average nanoseconds per lookup of the given passports.
+double timeCustomerLookups(const CustomerBST& tree, const int* probes, int count) {
+    unsigned long long start = nowNanos();
+    int found = 0;
+    for (int i = 0; i < count; i++) found += tree.exists(probes[i]);
+    double ns = static_cast<double>(nowNanos() - start) / count;
+    if (found != count) cerr << "Error: " << count - found << " lookups missed." << endl;
+    return ns;
+}
+
+// --bench-import [--records=N --threads=N --seed=N]: builds the customer
+// index from N shuffled passports by one-by-one insertion and by radix sort
+// plus bottom-up build.
+int benchImportMain(int argc, char** argv) {
+    int records = static_cast<int>(optionInt(argc, argv, "records", 1000000));
+    int threads = static_cast<int>(optionInt(argc, argv, "threads", thread::hardware_concurrency()));
+    FastRng rng(static_cast<unsigned long long>(optionInt(argc, argv, "seed", 42)));
+    if (records < 1) records = 1;
+    if (threads < 1) threads = 1;
+
+    int* passports = new int[records];
+    for (int i = 0; i < records; i++) passports[i] = 1000000 + i;
+    for (int i = records - 1; i > 0; i--) {
+        int j = static_cast<int>(rng.below(i + 1));
+        int tmp = passports[i]; passports[i] = passports[j]; passports[j] = tmp;
+    }
+    int probeCount = records < 1000000 ? records : 1000000;
+    int* probes = new int[probeCount];
+    for (int i = 0; i < probeCount; i++) probes[i] = passports[rng.below(records)];
+
+    bool statsWereEnabled = Stats::enabled;
+    Stats::enabled = false;
+
+    double insertSeconds, incrementalLookupNs;
+    {
+        CustomerBST tree;
+        unsigned long long start = nowNanos();
+        for (int i = 0; i < records; i++) tree.insert(passports[i], nullptr);
+        insertSeconds = (nowNanos() - start) / 1e9;
+        incrementalLookupNs = timeCustomerLookups(tree, probes, probeCount);
+    }
+
+    double sortSeconds, buildSeconds, bulkLookupNs;
+    {
+        CustomerBST tree;
+        unsigned long long start = nowNanos();
+        unsigned long long* entries = new unsigned long long[records];
+        for (int i = 0; i < records; i++) entries[i] = sortEntry(passports[i], i);
+        radixSortEntries(entries, records, threads);
+        sortSeconds = (nowNanos() - start) / 1e9;
+
+        start = nowNanos();
+        int* keys = new int[records];
+        Customer** customers = new Customer*[records];
+        for (int i = 0; i < records; i++) {
+            keys[i] = entryKey(entries[i]);
+            customers[i] = nullptr;
         }
-        cout << endl;
+        tree.build(keys, customers, records);
+        buildSeconds = (nowNanos() - start) / 1e9;
+        bulkLookupNs = timeCustomerLookups(tree, probes, probeCount);
+        delete[] entries;
+        delete[] keys;
+        delete[] customers;
+    }
+    Stats::enabled = statsWereEnabled;
 
-        selection = stoi(temp);
-        select(selection);
-    } while (true);
+    cout << "{\"benchmark\":\"import\",\"records\":" << records << ",\"threads\":" << threads
+        << ",\"incremental\":{\"insert_s\":" << insertSeconds << ",\"lookup_ns\":" << incrementalLookupNs << "}"
+        << ",\"bulk\":{\"sort_s\":" << sortSeconds << ",\"build_s\":" << buildSeconds
+        << ",\"lookup_ns\":" << bulkLookupNs << "}"
+        << ",\"speedup\":" << insertSeconds / (sortSeconds + buildSeconds) << "}" << endl;
+
+    delete[] passports;
+    delete[] probes;
+    return 0;
 }
 
-void Menu::select(int selection) {
-    Flight f;
-    Customer p;
-    string temp;
+struct SchemaTimings {
+    double csvWriteNs, csvParseNs, binaryWriteNs, binaryReadNs;
+    size_t csvBytes, binaryBytes;
+    bool roundTrip;
+};
 
-    try {
-        switch (selection) {
-        case 1:
-            f.addFlight();
-            break;
-        case 2:
-            if (!flist.empty()) {
-                cout << "Enter the Flight Number you want to delete: ";
-                cin >> temp;
-                cout << endl;
+// Times the schema's four paths over n records (ns per record) and checks
+// that the binary copy reads back to the same CSV text.
+template <typename Schema, typename Record>
+SchemaTimings timeSchema(const Record* const* records, int n) {
+    SchemaTimings t;
+    double perRecord = n > 0 ? n : 1;
+    time_t now = time(nullptr);
+
+    string csv;
+    unsigned long long start = nowNanos();
+    for (int i = 0; i < n; i++) {
+        Schema::write(csv, *records[i]);
+        csv += '\n';
+    }
+    t.csvWriteNs = (nowNanos() - start) / perRecord;
+
+    start = nowNanos();
+    int parsed = 0;
+    for (const char* p = csv.data(), *end = p + csv.size(); p < end;) {
+        const char* stop = static_cast<const char*>(memchr(p, '\n', end - p));
+        Record record;
+        parsed += Schema::parse(p, stop, record, now);
+        p = stop + 1;
+    }
+    t.csvParseNs = (nowNanos() - start) / perRecord;
+
+    string binary;
+    start = nowNanos();
+    for (int i = 0; i < n; i++) Schema::writeBinary(binary, *records[i]);
+    t.binaryWriteNs = (nowNanos() - start) / perRecord;
+
+    BinaryReader in = { binary.data(), binary.data() + binary.size() };
+    start = nowNanos();
+    while (in.p < in.end) {
+        Record record;
+        if (!Schema::readBinary(in, record)) break;
+    }
+    t.binaryReadNs = (nowNanos() - start) / perRecord;
+
+    string echo;
+    int read = 0;
+    in.p = binary.data();
+    while (in.p < in.end) {
+        Record record;
+        if (!Schema::readBinary(in, record)) break;
+        read++;
+        Schema::write(echo, record);
+        echo += '\n';
+    }
 
-                while (!checkNumber(temp)) {
-                    cout << "Flight Number must be a number!\n";
-                    cin.clear();
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                    cin >> temp;
-                    cout << endl;
-                }
+    t.csvBytes = csv.size();
+    t.binaryBytes = binary.size();
+    t.roundTrip = parsed == n && read == n && echo == csv;
+    return t;
+}
 
-                Flight::deleteFlight(stoi(temp));
-            }
-            else {
-                cout << "There are no flights to delete\n";
-            }
-            break;
-        case 3:
-            if (!flist.empty()) {
-                Flight::displaySchedule();
-            }
-            else {
-                cout << "There are no scheduled flights!\n";
-            }
-            break;
-        case 4:
-            if (!flist.empty()) {
-                cout << "Please enter flight number: ";
-                cin >> temp;
-                cout << endl;
+void appendSchemaTimings(ostream& out, const char* name, int n, const SchemaTimings& t) {
+    out << "\"" << name << "\":{\"records\":" << n
+        << ",\"csv\":{\"write_ns\":" << t.csvWriteNs << ",\"parse_ns\":" << t.csvParseNs
+        << ",\"bytes\":" << t.csvBytes << "}"
+        << ",\"binary\":{\"write_ns\":" << t.binaryWriteNs << ",\"read_ns\":" << t.binaryReadNs
+        << ",\"bytes\":" << t.binaryBytes << "}"
+        << ",\"round_trip\":" << (t.roundTrip ? "true" : "false") << "}";
+}
 
-                while (!checkNumber(temp)) {
-                    cout << "Flight number must be a number!\n";
-                    cin.clear();
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                    cin >> temp;
-                    cout << endl;
-                }
+// --bench-schema [--records=N] plus the generator options: per-record cost
+// of the flight and customer schemas in CSV and binary form, on a generated
+// data set of N customers (default 200000) in --data-dir (default bench_data/).
+int benchSchemaMain(int argc, char** argv) {
+    GeneratorConfig cfg = generatorConfigFromArgs(argc, argv);
+    cfg.customers = static_cast<int>(optionInt(argc, argv, "records", 200000));
+    if (cfg.customers < 1) cfg.customers = 1;
+    cfg.flights = cfg.customers / 10 > 10 ? cfg.customers / 10 : 10;
+    if (dataDirectory.empty()) dataDirectory = "bench_data/";
+    makeDirectory(dataDirectory);
+
+    NullBuffer nullBuffer;
+    streambuf* console = cout.rdbuf(&nullBuffer);
+    generateDataset(cfg);
+    cout.rdbuf(console);
+    Flight::loadFromFile();
+    Customer::loadFromFile();
 
-                Flight::displayFlightInfo(stoi(temp));
-            }
-            else {
-                cout << "There are no scheduled flights!\n";
-            }
-            break;
-        case 5:
-            if (!customerBST.getAllCustomers().empty()) {
-                cout << "Please enter passport number: ";
-                cin >> temp;
+    int flightCount = flist.getSize(), customerCount = customerBST.size();
+    const Flight** flights = new const Flight*[flightCount > 0 ? flightCount : 1];
+    const Customer** customers = new const Customer*[customerCount > 0 ? customerCount : 1];
+    int i = 0;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) flights[i++] = &node->data;
+    i = 0;
+    for (Customer* customer : customerBST) customers[i++] = customer;
+
+    SchemaTimings flightTimes = timeSchema<FlightSchema>(flights, flightCount);
+    SchemaTimings customerTimes = timeSchema<CustomerSchema>(customers, customerCount);
+
+    cout << "{\"benchmark\":\"schema\",";
+    appendSchemaTimings(cout, "flights", flightCount, flightTimes);
+    cout << ",";
+    appendSchemaTimings(cout, "customers", customerCount, customerTimes);
+    cout << "}" << endl;
+
+    delete[] flights;
+    delete[] customers;
+    return 0;
+}
 
-                while (!Customer::displayCustomerInfo(stoi(temp))) {
-                    cout << "Wrong passport number!\n";
-                    cin.clear();
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                    cin >> temp;
-                    cout << endl;
-                }
-            }
-            else {
-                cout << "There are no registered clients at the moment!\n";
-            }
-            break;
-        case 6:
-            p.book();
-            break;
-        case 7:
-            p.cancel();
-            break;
-        case 8:
-            if (!flist.empty()) {
-                cout << "Enter flight number to update: ";
-                cin >> temp;
-                cout << endl;
+// ---------------------------------------------------------------------------
+// Snapshot stress test
+//
+// One writer books and cancels on the engine thread with no lock at all
+// while reader threads scan flight and customer snapshots. Every version a
+// reader sees must be internally consistent: a flight's booked total moves
+// with its cabin counts, and a customer's total spent moves with the fares
+// of their bookings. Each record is compared against the difference it had
+// before the run, so older files with unknown fares still pass.
+// ---------------------------------------------------------------------------
+
+struct MvccStressShared {
+    atomic<bool> stop;
+    Flight** flights;
+    int* flightSkew;     // booked - business - economy before the run
+    int flightCount;
+    Customer** customers;
+    long long* spentSkew;  // total spent - known fares, in cents
+    int customerCount;
+};
 
-                while (!checkNumber(temp)) {
-                    cout << "Flight number must be a number!\n";
-                    cin.clear();
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                    cin >> temp;
-                    cout << endl;
-                }
+long long knownFareCents(const SmallVector<Booking, INLINE_BOOKINGS>& bookings) {
+    long long cents = 0;
+    for (const Booking& booking : bookings) {
+        if (booking.fare.getCents() >= 0) cents += booking.fare.getCents();
+    }
+    return cents;
+}
 
-                Flight::updateFlight(stoi(temp));
+// Scans a run of flights and customers per read; counts inconsistent versions.
+void mvccReader(MvccStressShared* shared, unsigned long long seed, unsigned long long* reads, unsigned long long* violations) {
+    const int RUN = 64;
+    FastRng rng(seed);
+    unsigned long long done = 0, bad = 0;
+    while (!shared->stop.load(memory_order_relaxed)) {
+        Snapshots::ReadGuard guard;
+        int first = static_cast<int>(rng.below(shared->flightCount));
+        for (int i = 0; i < RUN; i++) {
+            int at = (first + i) % shared->flightCount;
+            const FlightView* v = shared->flights[at]->snapshot();
+            if (!v || v->bookedSeats - v->bookedBusinessSeats - v->bookedEconomySeats != shared->flightSkew[at]
+                || v->heldBusinessSeats < 0 || v->heldEconomySeats < 0) {
+                bad++;
             }
-            else {
-                cout << "There are no scheduled flights!\n";
+        }
+        first = static_cast<int>(rng.below(shared->customerCount));
+        for (int i = 0; i < RUN; i++) {
+            int at = (first + i) % shared->customerCount;
+            const CustomerView* v = shared->customers[at]->snapshot();
+            if (!v || v->passport != shared->customers[at]->getPassport()
+                || v->totalSpent.getCents() - knownFareCents(v->bookings) != shared->spentSkew[at]) {
+                bad++;
             }
-            break;
-        case 9:
-            if (!flist.empty()) {
-                cout << "Enter flight number to manage queue: ";
-                cin >> temp;
-                cout << endl;
+        }
+        done++;
+    }
+    *reads = done;
+    *violations = bad;
+}
 
-                while (!checkNumber(temp)) {
-                    cout << "Flight number must be a number!\n";
-                    cin.clear();
-                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                    cin >> temp;
-                    cout << endl;
-                }
+// --stress-mvcc [--readers=4] [--writes=200000] [generator options]
+int stressMvccMain(int argc, char** argv) {
+    GeneratorConfig cfg = generatorConfigFromArgs(argc, argv);
+    int readers = static_cast<int>(optionInt(argc, argv, "readers", 4));
+    long long writes = optionInt(argc, argv, "writes", 200000);
+    if (readers < 1) readers = 1;
+    if (readers > Snapshots::MAX_READERS) readers = Snapshots::MAX_READERS;
+    if (dataDirectory.empty()) dataDirectory = "bench_data/";
+    makeDirectory(dataDirectory);
+
+    NullBuffer nullBuffer;
+    streambuf* console = cout.rdbuf(&nullBuffer);
+    generateDataset(cfg);
+    freeAllCustomers();
+    Flight::loadFromFile();
+    Customer::loadFromFile();
+    Queue::loadFromFile();
+    cout.rdbuf(console);
 
-                Customer customer;
-                customer.manageQueue(stoi(temp));
-            }
-            else {
-                cout << "There are no scheduled flights!\n";
+    MvccStressShared shared;
+    shared.flightCount = flist.getSize();
+    shared.customerCount = customerBST.size();
+    if (shared.flightCount == 0 || shared.customerCount == 0) {
+        cerr << "Error: the generated dataset is empty." << endl;
+        return 1;
+    }
+    shared.flights = new Flight*[shared.flightCount];
+    shared.flightSkew = new int[shared.flightCount];
+    shared.customers = new Customer*[shared.customerCount];
+    shared.spentSkew = new long long[shared.customerCount];
+    int i = 0;
+    for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next, i++) {
+        Flight& f = node->data;
+        shared.flights[i] = &f;
+        shared.flightSkew[i] = f.getBookedSeats() - f.getBookedBusinessSeats() - f.getBookedEconomySeats();
+    }
+    i = 0;
+    for (Customer* customer : customerBST) {
+        shared.customers[i] = customer;
+        shared.spentSkew[i++] = customer->getTotalSpent().getCents() - knownFareCents(customer->getBookings());
+    }
+
+    // The shared counters are not thread-safe
+    bool statsWereEnabled = Stats::enabled;
+    Stats::enabled = false;
+    Snapshots::enable();
+    shared.stop.store(false);
+
+    thread* threads = new thread[readers];
+    unsigned long long* reads = new unsigned long long[readers];
+    unsigned long long* violations = new unsigned long long[readers];
+    unsigned long long start = nowNanos();
+    for (int t = 0; t < readers; t++) {
+        threads[t] = thread(mvccReader, &shared, 300ULL + t, &reads[t], &violations[t]);
+    }
+
+    // Books a random seat, or cancels the customer's latest booking when it
+    // has a known fare (cancelBooking always takes the latest on a flight)
+    FastRng rng(11);
+    long long booked = 0, cancelled = 0;
+    for (long long w = 0; w < writes; w++) {
+        Customer* customer = shared.customers[rng.below(shared.customerCount)];
+        Flight* flight = shared.flights[rng.below(shared.flightCount)];
+        const SmallVector<Booking, INLINE_BOOKINGS>& bookings = customer->getBookings();
+        if (!bookings.empty() && rng.below(2) == 0) {
+            const Booking& last = bookings[bookings.getSize() - 1];
+            Money refund;
+            if (last.fare.getCents() >= 0 && !last.date
+                && Customer::cancelBooking(customer->getPassport(), last.flightNo, refund)) {
+                cancelled++;
+                continue;
             }
-            break;
-        case 10:
-            Menu::exit_prog();
-            break;
-        default:
-            cout << "Invalid selection \n";
+        }
+        bool business = rng.below(5) == 0;
+        if (flight->seatsLeft(business, false, 0) > 0) {
+            customer->confirmBooking(flight->getFlightNo(), business, customer->quote(flight, business));
+            booked++;
         }
     }
-    catch (const exception& e) {
-        cerr << "Error: " << e.what() << endl;
-        cin.clear();
-        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    double writeSeconds = (nowNanos() - start) / 1e9;
+    shared.stop.store(true);
+    for (int t = 0; t < readers; t++) threads[t].join();
+    double seconds = (nowNanos() - start) / 1e9;
+    Snapshots::reclaim();
+
+    unsigned long long totalReads = 0, totalViolations = 0;
+    for (int t = 0; t < readers; t++) {
+        totalReads += reads[t];
+        totalViolations += violations[t];
     }
+    Stats::enabled = statsWereEnabled;
+
+    cout << "{\"benchmark\":\"stress_mvcc\",\"readers\":" << readers << ",\"cpus\":" << thread::hardware_concurrency()
+        << ",\"flights\":" << shared.flightCount << ",\"customers\":" << shared.customerCount
+        << ",\"writes\":" << writes << ",\"booked\":" << booked << ",\"cancelled\":" << cancelled
+        << ",\"writes_per_s\":" << (writeSeconds > 0 ? writes / writeSeconds : 0.0)
+        << ",\"reads\":" << totalReads << ",\"reads_per_s\":" << (seconds > 0 ? totalReads / seconds : 0.0)
+        << ",\"violations\":" << totalViolations << ",\"retired\":" << Snapshots::retiredCount()
+        << ",\"reclaimed\":" << Snapshots::reclaimedCount() << ",\"pending\":" << Snapshots::pending() << "}" << endl;
+
+    delete[] threads;
+    delete[] reads;
+    delete[] violations;
+    delete[] shared.flights;
+    delete[] shared.flightSkew;
+    delete[] shared.customers;
+    delete[] shared.spentSkew;
+    return totalViolations ? 1 : 0;
 }
 
-void Menu::exit_prog() {
+// --memstats: loads the data files and prints the memory report.
+int memstatsMain(int, char**) {
+    Flight::loadFromFile();
+    Customer::loadFromFile();
+    Queue::loadFromFile();
+    writeMemoryReport(cout);
+    cout << endl;
+    return 0;
+}
+
+// --update-flights=FILE: one "<flight> field=value ..." line per flight,
+// applied together and saved once.
+int updateFlightsMain(int argc, char** argv) {
+    const char* path = findOption(argc, argv, "update-flights");
+    string contents;
+    if (!path || !*path) {
+        cerr << "Usage: --update-flights=FILE" << endl;
+        return 1;
+    }
+    if (!FileIO::readFile(path, contents)) {
+        cerr << "Error: cannot read " << path << "." << endl;
+        return 1;
+    }
+
+    // The flights file carries everything a status change touches
+    Flight::loadFromFile();
+
+    size_t lines = 0;
+    for (char c : contents) lines += c == '\n';
+    FlightChange* changes = new FlightChange[lines + 1];
+    int n = 0, lineNo = 0;
+    istringstream file(contents);
+    string line, error;
+    while (getline(file, line)) {
+        lineNo++;
+        if (line.empty() || line[0] == '#') continue;
+        if (!parseFlightChange(line, changes[n], error)) {
+            cerr << path << ":" << lineNo << ": " << error << endl;
+            delete[] changes;
+            return 1;
+        }
+        n++;
+    }
+
+    unsigned long long start = nowNanos();
+    int touched = Flight::applyChanges(changes, n, error);
+    delete[] changes;
+    if (touched < 0) {
+        cerr << "Error: " << error << "; no flights were changed." << endl;
+        return 1;
+    }
     Flight::saveToFile();
-    Customer::saveToFile();
-    Queue::saveToFile();
+    double seconds = (nowNanos() - start) / 1e9;
+
+    cout << "{\"update\":\"flights\",\"changes\":" << n << ",\"flights\":" << touched
+        << ",\"seconds\":" << seconds << "}" << endl;
+    return 0;
+}
 
-    DoublyLinkedList<Customer*> customers = customerBST.getAllCustomers();
-    for (ListNode<Customer*>* node = customers.begin(); node != customers.end(); node = node->next) {
-        delete node->data;
+// --departures=YYYY-MM-DD [--days=N]: every departure from that date on,
+// as date,flight,from,to,leave,arrive,business_free,economy_free.
+int departuresMain(int argc, char** argv) {
+    const char* from = findOption(argc, argv, "departures");
+    int first;
+    int days = static_cast<int>(optionInt(argc, argv, "days", 1));
+    if (!from || !parseDate(from, first) || days < 1) {
+        cerr << "Usage: --departures=YYYY-MM-DD [--days=1]" << endl;
+        return 1;
     }
 
-    cout << "Thank you for using our system! \n";
-    exit(0);
+    Flight::loadFromFile();
+    Customer::loadFromFile();
+    for (int date = first; date < first + days; date++) {
+        string day = formatDate(date);
+        for (ListNode<Flight>* node = flist.begin(); node != flist.end(); node = node->next) {
+            const Flight& flight = node->data;
+            if (!flight.operatesOn(date)) continue;
+            cout << day << "," << flight.getFlightNo() << "," << flight.getDeparture() << ","
+                << flight.getDestination() << "," << formatTime(flight.getLeavingTime()) << ","
+                << formatTime(flight.getArrivingTime()) << (flight.arrivesNextDay() ? "+1" : "") << ","
+                << flight.seatsLeft(true, false, date) << "," << flight.seatsLeft(false, false, date) << "\n";
+        }
+    }
+    return 0;
+}
+
+// --serve [--socket=PATH | --port=N] [--readers=N]
+int serveMain(int argc, char** argv) {
+    const char* socketArg = findOption(argc, argv, "socket");
+    int port = static_cast<int>(optionInt(argc, argv, "port", 0));
+    int readers = static_cast<int>(optionInt(argc, argv, "readers", 0));
+    if (readers < 0) readers = 0;
+    if (readers > ReservationServer::MAX_READERS) readers = ReservationServer::MAX_READERS;
+
+    Flight::loadFromFile();
+    Customer::loadFromFile();
+    Queue::loadFromFile();
+    return ReservationServer::run(socketArg ? socketArg : "frs.sock", port, readers);
 }
 
-int main() {
+int main(int argc, char** argv) {
+    const char* statsEnv = getenv("FRS_STATS");
+    if (statsEnv && statsEnv[0] == '0') {
+        Stats::enabled = false;
+    }
+
+    const char* dir = findOption(argc, argv, "data-dir");
+    if (dir && *dir) {
+        dataDirectory = dir;
+        if (dataDirectory.back() != '/' && dataDirectory.back() != '\\') dataDirectory += '/';
+    }
+
+    double holdTtl = optionDouble(argc, argv, "hold-ttl", -1);
+    const char* holdEnv = getenv("FRS_HOLD_TTL");
+    if (holdTtl < 0 && holdEnv) holdTtl = atof(holdEnv);
+    if (holdTtl >= 0) SeatHolds::setTtlMs(static_cast<unsigned>(holdTtl * 1000));
+
+    // Waitlist aging and expiry periods in hours; 0 turns one off
+    double waitlistAge = optionDouble(argc, argv, "waitlist-age", -1);
+    const char* ageEnv = getenv("FRS_WAITLIST_AGE");
+    if (waitlistAge < 0 && ageEnv) waitlistAge = atof(ageEnv);
+    if (waitlistAge >= 0) WaitlistAging::setAgeSeconds(static_cast<long long>(waitlistAge * 3600));
+    double waitlistExpire = optionDouble(argc, argv, "waitlist-expire", -1);
+    const char* expireEnv = getenv("FRS_WAITLIST_EXPIRE");
+    if (waitlistExpire < 0 && expireEnv) waitlistExpire = atof(expireEnv);
+    if (waitlistExpire >= 0) WaitlistAging::setExpireSeconds(static_cast<long long>(waitlistExpire * 3600));
+
+    const char* io = findOption(argc, argv, "io");
+    if (!io) io = getenv("FRS_IO");
+    if (io && strcmp(io, "posix") == 0) {
+        FileIO::select(IO_POSIX);
+    }
+    else if (io && strcmp(io, "uring") == 0 && !FileIO::select(IO_URING)) {
+        cerr << "io_uring is unavailable; using pread/pwrite." << endl;
+    }
+
     try {
+        if (hasFlag(argc, argv, "--generate")) return generateMain(argc, argv);
+        if (hasFlag(argc, argv, "--bench")) return benchMain(argc, argv);
+        if (hasFlag(argc, argv, "--microbench")) return microbenchMain(argc, argv);
+        if (hasFlag(argc, argv, "--serve")) return serveMain(argc, argv);
+        if (hasFlag(argc, argv, "--loadgen")) return loadgenMain(argc, argv);
+        if (hasFlag(argc, argv, "--bench-async")) return benchAsyncMain(argc, argv);
+        if (hasFlag(argc, argv, "--bench-io")) return benchIoMain(argc, argv);
+        if (hasFlag(argc, argv, "--schedule")) return scheduleMain(argc, argv);
+        if (hasFlag(argc, argv, "--bench-pricing")) return benchPricingMain(argc, argv);
+        if (hasFlag(argc, argv, "--overbook")) return overbookMain(argc, argv);
+        if (hasFlag(argc, argv, "--bench-search")) return benchSearchMain(argc, argv);
+        if (hasFlag(argc, argv, "--bench-import")) return benchImportMain(argc, argv);
+        if (hasFlag(argc, argv, "--bench-schema")) return benchSchemaMain(argc, argv);
+        if (hasFlag(argc, argv, "--stress-mvcc")) return stressMvccMain(argc, argv);
+        if (hasFlag(argc, argv, "--memstats")) return memstatsMain(argc, argv);
+        if (findOption(argc, argv, "update-flights")) return updateFlightsMain(argc, argv);
+        if (findOption(argc, argv, "import-flights") || findOption(argc, argv, "import-customers")) {
+            return importMain(argc, argv);
+        }
+        if (findOption(argc, argv, "search")) return searchMain(argc, argv);
+        if (findOption(argc, argv, "departures")) return departuresMain(argc, argv);
         Menu::displayMenu();
     }
     catch (const exception& e) {